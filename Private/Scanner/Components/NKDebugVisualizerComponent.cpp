@@ -0,0 +1,369 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/Components/NKDebugVisualizerComponent.h"
+#include "Scanner/Utilities/NKScannerStats.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/Engine.h"
+#include "Engine/GameViewportClient.h"
+#include "Kismet/GameplayStatics.h"
+
+UNKDebugVisualizerComponent::UNKDebugVisualizerComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;  // Only tick while points or lines are queued
+	
+	PointMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Engine/BasicShapes/Sphere.Sphere")));
+	PointMaterial = TSoftObjectPtr<UMaterialInterface>(FSoftObjectPath(TEXT("/Engine/BasicShapes/BasicShapeMaterial.BasicShapeMaterial")));
+}
+
+void UNKDebugVisualizerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Batches are separate components on the owner - take them down with the visualizer
+	for (FNKDebugPointBatch& Batch : PointBatches)
+	{
+		if (Batch.Mesh)
+		{
+			Batch.Mesh->DestroyComponent();
+		}
+	}
+	PointBatches.Reset();
+	VisiblePointCount = 0;
+	
+	if (LineBatch)
+	{
+		LineBatch->DestroyComponent();
+		LineBatch = nullptr;
+	}
+	PendingLines.Reset();
+	LineCount = 0;
+	
+	Super::EndPlay(EndPlayReason);
+}
+
+void UNKDebugVisualizerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	
+	FlushPending();
+	SetComponentTickEnabled(false);
+}
+
+// ===== INKDebugVisualizerInterface Implementation =====
+
+void UNKDebugVisualizerComponent::DrawOrbitPath(const FVector& Center, float Radius, float Height)
+{
+	if (!bShowOrbitPath)
+	{
+		return;
+	}
+	
+	const int32 Segments = 64;
+	FVector Previous(Center.X + Radius, Center.Y, Height);
+	for (int32 Segment = 1; Segment <= Segments; Segment++)
+	{
+		const float Angle = (2.0f * PI * Segment) / Segments;
+		const FVector Next(Center.X + (Radius * FMath::Cos(Angle)), Center.Y + (Radius * FMath::Sin(Angle)), Height);
+		AddLine(Previous, Next, OrbitPathColor, 2.0f);
+		Previous = Next;
+	}
+}
+
+void UNKDebugVisualizerComponent::DrawBoundingBox(const FBox& Bounds)
+{
+	if (!bShowBoundingBox || !Bounds.IsValid)
+	{
+		return;
+	}
+	
+	// Corner bits: 1 = max X, 2 = max Y, 4 = max Z
+	auto Corner = [&Bounds](int32 Bits)
+	{
+		return FVector(
+			(Bits & 1) ? Bounds.Max.X : Bounds.Min.X,
+			(Bits & 2) ? Bounds.Max.Y : Bounds.Min.Y,
+			(Bits & 4) ? Bounds.Max.Z : Bounds.Min.Z);
+	};
+	
+	// Every edge joins two corners that differ in exactly one bit
+	for (int32 Bits = 0; Bits < 8; Bits++)
+	{
+		for (int32 Axis = 1; Axis < 8; Axis <<= 1)
+		{
+			if (!(Bits & Axis))
+			{
+				AddLine(Corner(Bits), Corner(Bits | Axis), BoundingBoxColor, 2.0f);
+			}
+		}
+	}
+}
+
+void UNKDebugVisualizerComponent::DrawScanPoint(const FVector& Location, bool bHit)
+{
+	if (bShowScanPoints)
+	{
+		AddScanPoint(Location, bHit ? ScanPointColor : MissPointColor);
+	}
+}
+
+void UNKDebugVisualizerComponent::DrawScanLine(const FVector& Start, const FVector& End)
+{
+	if (bShowScanLines)
+	{
+		AddLine(Start, End, ScanLineColor, 1.0f);
+	}
+}
+
+void UNKDebugVisualizerComponent::ClearAllDebugVisuals()
+{
+	ClearScanPoints();
+	ClearLines();
+}
+
+void UNKDebugVisualizerComponent::ClearScanPoints()
+{
+	// Instance buffers are dropped as a whole - no per-point work, no persistent line flush
+	for (FNKDebugPointBatch& Batch : PointBatches)
+	{
+		if (Batch.Mesh)
+		{
+			Batch.Mesh->ClearInstances();
+		}
+		Batch.InstanceCells.Reset();
+		Batch.OccupiedCells.Reset();
+		Batch.PendingLocations.Reset();
+		Batch.PendingCells.Reset();
+		Batch.RecycleCursor = 0;
+	}
+	
+	VisiblePointCount = 0;
+	DecimatedPointCount = 0;
+}
+
+// ===== Batched Drawing =====
+
+bool UNKDebugVisualizerComponent::AddScanPoint(const FVector& Location, FColor Color, float Size)
+{
+	FNKDebugPointBatch* Batch = FindOrCreateBatch(Color, FMath::Max(Size, 0.0f));
+	if (!Batch)
+	{
+		return false;
+	}
+	
+	const FIntVector4 Cell = GetDecimationCell(Location);
+	bool bCellTaken = false;
+	Batch->OccupiedCells.Add(Cell, &bCellTaken);
+	if (bCellTaken)
+	{
+		DecimatedPointCount++;
+		return false;
+	}
+	
+	Batch->PendingLocations.Add(Location);
+	Batch->PendingCells.Add(Cell);
+	SetComponentTickEnabled(true);
+	return true;
+}
+
+void UNKDebugVisualizerComponent::AddLine(const FVector& Start, const FVector& End, FColor Color, float Thickness)
+{
+	PendingLines.Emplace(Start, End, FLinearColor(Color), VisualsLifetime, Thickness, SDPG_World);
+	SetComponentTickEnabled(true);
+}
+
+void UNKDebugVisualizerComponent::ClearLines()
+{
+	if (LineBatch)
+	{
+		LineBatch->Flush();
+	}
+	PendingLines.Reset();
+	LineCount = 0;
+}
+
+// ===== Internal Methods =====
+
+FNKDebugPointBatch* UNKDebugVisualizerComponent::FindOrCreateBatch(FColor Color, float Size)
+{
+	for (FNKDebugPointBatch& Batch : PointBatches)
+	{
+		if (Batch.Color == Color && Batch.Size == Size)
+		{
+			return &Batch;
+		}
+	}
+	
+	AActor* Owner = GetOwner();
+	UStaticMesh* Mesh = PointMesh.LoadSynchronous();
+	if (!Owner || !Mesh)
+	{
+		return nullptr;
+	}
+	
+	UInstancedStaticMeshComponent* Instances = NewObject<UInstancedStaticMeshComponent>(Owner,
+		MakeUniqueObjectName(Owner, UInstancedStaticMeshComponent::StaticClass(), TEXT("DebugPoints")));
+	Instances->SetStaticMesh(Mesh);
+	Instances->SetMobility(EComponentMobility::Movable);
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);  // Never in the way of the scanner's own traces
+	Instances->SetCastShadow(false);
+	Instances->SetCanEverAffectNavigation(false);
+	
+	if (UMaterialInterface* Material = PointMaterial.LoadSynchronous())
+	{
+		UMaterialInstanceDynamic* Tint = UMaterialInstanceDynamic::Create(Material, Instances);
+		Tint->SetVectorParameterValue(TEXT("Color"), FLinearColor(Color));
+		Instances->SetMaterial(0, Tint);
+	}
+	
+	// Left unattached - instances are placed in world space and stay put while the owner moves
+	Instances->RegisterComponent();
+	
+	FNKDebugPointBatch& Batch = PointBatches.AddDefaulted_GetRef();
+	Batch.Color = Color;
+	Batch.Size = Size;
+	Batch.Mesh = Instances;
+	return &Batch;
+}
+
+FIntVector4 UNKDebugVisualizerComponent::GetDecimationCell(const FVector& Location)
+{
+	UpdateView();
+	
+	// Cell spanning MinPixelSpacing at the point's distance, rounded up to a power-of-two multiple of MinWorldSpacing
+	const float BaseSpacing = FMath::Max(MinWorldSpacing, 0.01f);
+	int32 Level = 0;
+	if (bHasView && MinPixelSpacing > 0.0f)
+	{
+		const float ScreenSpacing = FVector::Dist(ViewLocation, Location) * PixelAngle * MinPixelSpacing;
+		const uint32 Multiple = (uint32)FMath::Clamp(FMath::CeilToInt(ScreenSpacing / BaseSpacing), 1, 1 << 20);
+		Level = FMath::CeilLogTwo(Multiple);
+	}
+	
+	const double CellSize = BaseSpacing * (double)(1 << Level);
+	return FIntVector4(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize),
+		Level);
+}
+
+void UNKDebugVisualizerComponent::UpdateView()
+{
+	if (ViewFrame == GFrameCounter)
+	{
+		return;
+	}
+	ViewFrame = GFrameCounter;
+	bHasView = false;
+	
+	APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+	if (!CameraManager)
+	{
+		return;  // Headless - world spacing only
+	}
+	
+	FVector2D ViewportSize(1920.0, 1080.0);
+	if (GEngine && GEngine->GameViewport)
+	{
+		GEngine->GameViewport->GetViewportSize(ViewportSize);
+	}
+	if (ViewportSize.X <= 0.0)
+	{
+		return;
+	}
+	
+	// World size of one pixel at unit distance
+	ViewLocation = CameraManager->GetCameraLocation();
+	PixelAngle = (2.0f * FMath::Tan(FMath::DegreesToRadians(CameraManager->GetFOVAngle() * 0.5f))) / ViewportSize.X;
+	bHasView = true;
+}
+
+void UNKDebugVisualizerComponent::FlushPending()
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_DebugDraw);
+	
+	for (FNKDebugPointBatch& Batch : PointBatches)
+	{
+		const int32 PendingCount = Batch.PendingLocations.Num();
+		if (PendingCount == 0 || !Batch.Mesh)
+		{
+			continue;
+		}
+		
+		const FVector Scale((Batch.Size > 0.0f ? Batch.Size : PointSize) / 100.0f);
+		
+		// 1. Grow the instance buffer up to the cap in one call
+		const int32 FitCount = FMath::Clamp(MaxVisiblePoints - VisiblePointCount, 0, PendingCount);
+		if (FitCount > 0)
+		{
+			TArray<FTransform> NewInstances;
+			NewInstances.Reserve(FitCount);
+			for (int32 PendingIndex = 0; PendingIndex < FitCount; PendingIndex++)
+			{
+				NewInstances.Emplace(FQuat::Identity, Batch.PendingLocations[PendingIndex], Scale);
+				Batch.InstanceCells.Add(Batch.PendingCells[PendingIndex]);
+			}
+			Batch.Mesh->AddInstances(NewInstances, false, true, false);
+			VisiblePointCount += FitCount;
+		}
+		
+		// 2. Past the cap, move this color's oldest points instead (or drop the point if it has none)
+		for (int32 PendingIndex = FitCount; PendingIndex < PendingCount; PendingIndex++)
+		{
+			if (Batch.InstanceCells.Num() == 0)
+			{
+				Batch.OccupiedCells.Remove(Batch.PendingCells[PendingIndex]);
+				continue;
+			}
+			
+			const int32 InstanceIndex = Batch.RecycleCursor;
+			Batch.OccupiedCells.Remove(Batch.InstanceCells[InstanceIndex]);
+			Batch.InstanceCells[InstanceIndex] = Batch.PendingCells[PendingIndex];
+			Batch.Mesh->UpdateInstanceTransform(InstanceIndex, FTransform(FQuat::Identity, Batch.PendingLocations[PendingIndex], Scale), true, false, true);
+			Batch.RecycleCursor = (InstanceIndex + 1) % Batch.InstanceCells.Num();
+		}
+		if (FitCount < PendingCount)
+		{
+			Batch.Mesh->MarkRenderStateDirty();
+		}
+		
+		Batch.PendingLocations.Reset();
+		Batch.PendingCells.Reset();
+	}
+	
+	if (PendingLines.Num() > 0)
+	{
+		if (ULineBatchComponent* Lines = GetLineBatch())
+		{
+			// Only the newest MaxVisibleLines of this frame can survive
+			if (PendingLines.Num() > MaxVisibleLines)
+			{
+				PendingLines.RemoveAt(0, PendingLines.Num() - MaxVisibleLines, EAllowShrinking::No);
+			}
+			
+			// Over the cap - start the batch over rather than growing it without bound
+			if (LineCount + PendingLines.Num() > MaxVisibleLines)
+			{
+				Lines->Flush();
+				LineCount = 0;
+			}
+			
+			Lines->DrawLines(PendingLines);
+			LineCount += PendingLines.Num();
+		}
+		PendingLines.Reset();
+	}
+}
+
+ULineBatchComponent* UNKDebugVisualizerComponent::GetLineBatch()
+{
+	AActor* Owner = GetOwner();
+	if (!LineBatch && Owner)
+	{
+		LineBatch = NewObject<ULineBatchComponent>(Owner,
+			MakeUniqueObjectName(Owner, ULineBatchComponent::StaticClass(), TEXT("DebugLines")));
+		LineBatch->RegisterComponent();
+	}
+	return LineBatch;
+}
@@ -1,10 +1,33 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Scanner/Components/NKLaserTracerComponent.h"
+#include "Scanner/Components/NKDebugVisualizerComponent.h"
 #include "Scanner/Utilities/NKScannerLogger.h"
+#include "Scanner/Utilities/NKScanSignature.h"
+#include "Scanner/Utilities/NKScannerStats.h"
+#include "Misc/ScopeRWLock.h"
+#include "LandscapeProxy.h"
+#include "Async/ParallelFor.h"
 #include "DrawDebugHelpers.h"
 #include "CineCameraComponent.h"
 
+namespace
+{
+	/** One scene query issued (cache hits and bounds rejections are not counted) */
+	FORCEINLINE void CountSceneTrace(bool bHeightGrid = false)
+	{
+		// Height grid rays never reach the physics scene
+		if (bHeightGrid)
+		{
+			INC_DWORD_STAT(STAT_NKScanner_HeightfieldRaysPerFrame);
+			return;
+		}
+		
+		INC_DWORD_STAT(STAT_NKScanner_TracesPerFrame);
+		INC_DWORD_STAT(STAT_NKScanner_TracesIssued);
+	}
+}
+
 UNKLaserTracerComponent::UNKLaserTracerComponent()
 	: bLastShotHit(false)
 	, LastHitActor(nullptr)
@@ -14,6 +37,14 @@ UNKLaserTracerComponent::UNKLaserTracerComponent()
 	PrimaryComponentTick.bCanEverTick = false;
 }
 
+void UNKLaserTracerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	LandscapeGrid.Reset();
+	NKSCANNER_UPDATE_MEMORY_STAT(STAT_NKScanner_HeightGridMemory, ReportedGridBytes, 0);
+	
+	Super::EndPlay(EndPlayReason);
+}
+
 bool UNKLaserTracerComponent::PerformTrace(FHitResult& OutHit)
 {
 	AActor* Owner = GetOwner();
@@ -31,81 +62,807 @@ bool UNKLaserTracerComponent::PerformTrace(FHitResult& OutHit)
 	}
 	
 	// Trace from camera forward
-	FVector Start = CineCamera->GetComponentLocation();
-	FVector End = Start + (CineCamera->GetForwardVector() * MaxRange);
+	return PerformTraceFromPose(CineCamera->GetComponentLocation(), CineCamera->GetForwardVector(), OutHit);
+}
+
+bool UNKLaserTracerComponent::PerformTraceFromPose(const FVector& Start, const FVector& Direction, FHitResult& OutHit)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_Trace);
 	
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(Owner);
-	QueryParams.bTraceComplex = bUseComplexCollision;
-	QueryParams.bReturnPhysicalMaterial = true;
+	if (!GetWorld())
+	{
+		return false;
+	}
+	
+	FVector End = Start + (Direction * MaxRange);
+	
+	// Repeat rays against unchanged geometry are answered without touching the scene
+	if (TraceCacheValidatedFrame != GFrameCounter)
+	{
+		ValidateTraceCache();
+	}
+	
+	const FNKTraceCacheKey CacheKey = bUseTraceCache ? MakeTraceCacheKey(Start, Direction, false, nullptr) : FNKTraceCacheKey();
+	TArray<FHitResult> CachedHits;
+	bool bHit;
+	
+	if (bUseTraceCache && FindCachedTrace(CacheKey, CachedHits))
+	{
+		bHit = CachedHits.Num() > 0;
+		if (bHit)
+		{
+			OutHit = CachedHits[0];
+		}
+	}
+	else
+	{
+		FCollisionQueryParams QueryParams = BuildQueryParams();
+		
+		// Primary trace
+		CountSceneTrace(IsTracingHeightGrid());
+		bHit = (TraceScope != ETraceScope::World) ?
+			TraceTargetComponents(Start, End, QueryParams, OutHit) :
+			GetWorld()->LineTraceSingleByChannel(
+				OutHit,
+				Start,
+				End,
+				TraceChannel,
+				QueryParams
+			);
+		
+		// Log trace attempt
+		if (UNKScannerLogger* Logger = UNKScannerLogger::Get(this))
+		{
+			Logger->Log(
+				FString::Printf(
+					TEXT("Laser trace - Channel: %s, Complex: %s, Hit: %s, Distance: %.2fm"),
+					TraceScope == ETraceScope::TargetOnly ? TEXT("TargetOnly") :
+					TraceScope == ETraceScope::LandscapeHeightfield ? TEXT("LandscapeHeightfield") :
+						*UEnum::GetValueAsString(TEXT("Engine.ECollisionChannel"), TraceChannel),
+					bUseComplexCollision ? TEXT("YES") : TEXT("NO"),
+					bHit ? TEXT("YES") : TEXT("NO"),
+					bHit ? OutHit.Distance/100.0f : 0.0f
+				),
+				TEXT("LaserTracer")
+			);
+			
+			if (bHit)
+			{
+				Logger->Log(
+					FString::Printf(TEXT("  Hit Actor: %s"), 
+						OutHit.GetActor() ? *OutHit.GetActor()->GetName() : TEXT("NULL")),
+					TEXT("LaserTracer")
+				);
+			}
+		}
+		
+		// Fallback trace if enabled and primary missed (target-only traces ignore channels)
+		if (!bHit && bUseFallbackChannel && TraceScope == ETraceScope::World)
+		{
+			CountSceneTrace();
+			bHit = GetWorld()->LineTraceSingleByChannel(
+				OutHit,
+				Start,
+				End,
+				FallbackTraceChannel,
+				QueryParams
+			);
+			
+			if (bHit)
+			{
+				if (UNKScannerLogger* Logger = UNKScannerLogger::Get(this))
+				{
+					Logger->LogWarning(
+						FString::Printf(
+							TEXT("Fallback channel %s succeeded! Distance: %.2fm"),
+							*UEnum::GetValueAsString(TEXT("Engine.ECollisionChannel"), FallbackTraceChannel),
+							OutHit.Distance/100.0f
+						),
+						TEXT("LaserTracer")
+					);
+				}
+			}
+		}
+		
+		if (bUseTraceCache)
+		{
+			AddCachedTrace(CacheKey, bHit ? TConstArrayView<FHitResult>(&OutHit, 1) : TConstArrayView<FHitResult>());
+		}
+	}
 	
-	// Primary trace
-	bool bHit = GetWorld()->LineTraceSingleByChannel(
-		OutHit,
+	// Update last shot state
+	UpdateLastShotState(bHit, OutHit);
+	
+	// Draw visualization
+	if (bShowLaser)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_NKScanner_DebugDraw);
+		DrawDiscoveryShot(Start, bHit ? OutHit.Location : End, bHit);
+	}
+	
+	return bHit;
+}
+
+FTraceHandle UNKLaserTracerComponent::SubmitAsyncTrace(const FVector& Start, const FVector& Direction)
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return FTraceHandle();
+	}
+	
+	const FVector End = Start + (Direction * MaxRange);
+	
+	CountSceneTrace();
+	return World->AsyncLineTraceByChannel(
+		EAsyncTraceType::Single,
 		Start,
 		End,
 		TraceChannel,
-		QueryParams
+		BuildQueryParams()
 	);
+}
+
+bool UNKLaserTracerComponent::QueryAsyncTrace(const FTraceHandle& Handle, bool& bOutHit, FHitResult& OutHit)
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return false;
+	}
+	
+	FTraceDatum TraceDatum;
+	if (!World->QueryTraceData(Handle, TraceDatum))
+	{
+		return false;  // Not processed yet
+	}
+	
+	bOutHit = TraceDatum.OutHits.Num() > 0 && TraceDatum.OutHits[0].bBlockingHit;
+	if (bOutHit)
+	{
+		OutHit = TraceDatum.OutHits[0];
+	}
+	
+	// Fallback retry runs synchronously, but only for the (rare) misses
+	if (!bOutHit && bUseFallbackChannel)
+	{
+		CountSceneTrace();
+		bOutHit = World->LineTraceSingleByChannel(
+			OutHit,
+			TraceDatum.Start,
+			TraceDatum.End,
+			FallbackTraceChannel,
+			BuildQueryParams()
+		);
+	}
+	
+	UpdateLastShotState(bOutHit, OutHit);
+	
+	if (bShowLaser)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_NKScanner_DebugDraw);
+		DrawDiscoveryShot(TraceDatum.Start, bOutHit ? OutHit.Location : TraceDatum.End, bOutHit);
+	}
+	
+	return true;
+}
+
+bool UNKLaserTracerComponent::IsAsyncTraceExpired(const FTraceHandle& Handle) const
+{
+	UWorld* World = GetWorld();
+	return !World || !World->IsTraceHandleValid(Handle, false);
+}
+
+bool UNKLaserTracerComponent::TraceRayConcurrent(const FVector& Start, const FVector& Direction, const FCollisionQueryParams& QueryParams, FHitResult& OutHit) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_ConcurrentTrace);
+	
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return false;
+	}
+	
+	const FVector End = Start + (Direction * MaxRange);
+	
+	// Cache was validated on the game thread before the workers started
+	const FNKTraceCacheKey CacheKey = bUseTraceCache ? MakeTraceCacheKey(Start, Direction, false, nullptr) : FNKTraceCacheKey();
+	if (bUseTraceCache)
+	{
+		TArray<FHitResult> CachedHits;
+		if (FindCachedTrace(CacheKey, CachedHits))
+		{
+			if (CachedHits.Num() > 0)
+			{
+				OutHit = CachedHits[0];
+			}
+			return CachedHits.Num() > 0;
+		}
+	}
+	
+	bool bHit;
+	CountSceneTrace(IsTracingHeightGrid());
+	if (TraceScope != ETraceScope::World)
+	{
+		bHit = TraceTargetComponents(Start, End, QueryParams, OutHit);
+	}
+	else
+	{
+		bHit = World->LineTraceSingleByChannel(OutHit, Start, End, TraceChannel, QueryParams);
+		
+		if (!bHit && bUseFallbackChannel)
+		{
+			CountSceneTrace();
+			bHit = World->LineTraceSingleByChannel(OutHit, Start, End, FallbackTraceChannel, QueryParams);
+		}
+	}
+	
+	if (bUseTraceCache)
+	{
+		AddCachedTrace(CacheKey, bHit ? TConstArrayView<FHitResult>(&OutHit, 1) : TConstArrayView<FHitResult>());
+	}
+	
+	return bHit;
+}
+
+int32 UNKLaserTracerComponent::PerformTraces(TConstArrayView<FVector> Origins, TConstArrayView<FVector> Directions, FNKTraceBatchResults& OutResults, bool bConcurrent)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_Trace);
+	
+	const int32 RayCount = Directions.Num();
+	OutResults.Reset(RayCount);
+	
+	UWorld* World = GetWorld();
+	if (!World || RayCount == 0)
+	{
+		return 0;
+	}
+	
+	if (Origins.Num() != RayCount && Origins.Num() != 1)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UNKLaserTracerComponent::PerformTraces - %d origins for %d rays"), Origins.Num(), RayCount);
+		return 0;
+	}
+	
+	if (TraceCacheValidatedFrame != GFrameCounter)
+	{
+		ValidateTraceCache();
+	}
+	
+	// Shared by every ray (and read-only inside the workers)
+	const FCollisionQueryParams QueryParams = BuildQueryParams();
+	const bool bRetryOnFallback = bUseFallbackChannel && TraceScope == ETraceScope::World;
+	const EParallelForFlags ForFlags = bConcurrent ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	const bool bSharedOrigin = Origins.Num() == 1;
+	
+	// Hit actor per ray - interned into OutResults.Actors on the game thread afterwards
+	TArray<AActor*> RayActors;
+	RayActors.SetNumZeroed(RayCount);
+	TArray<bool> NeedsFallback;
+	NeedsFallback.SetNumZeroed(RayCount);
+	
+	auto WriteHit = [&OutResults, &RayActors](int32 RayIndex, const FHitResult& Hit)
+	{
+		OutResults.HitFlags[RayIndex] = true;
+		OutResults.Locations[RayIndex] = Hit.Location;
+		OutResults.Normals[RayIndex] = Hit.ImpactNormal;
+		OutResults.Distances[RayIndex] = Hit.Distance;
+		OutResults.Components[RayIndex] = Hit.GetComponent();
+		RayActors[RayIndex] = Hit.GetActor();
+	};
+	
+	// 1. Primary channel (or the target's components) for every ray
+	ParallelFor(RayCount, [&](int32 RayIndex)
+	{
+		const FVector& Start = Origins[bSharedOrigin ? 0 : RayIndex];
+		const FVector& Direction = Directions[RayIndex];
+		
+		const FNKTraceCacheKey CacheKey = bUseTraceCache ? MakeTraceCacheKey(Start, Direction, false, nullptr) : FNKTraceCacheKey();
+		if (bUseTraceCache)
+		{
+			TArray<FHitResult> CachedHits;
+			if (FindCachedTrace(CacheKey, CachedHits))
+			{
+				if (CachedHits.Num() > 0)
+				{
+					WriteHit(RayIndex, CachedHits[0]);
+				}
+				return;
+			}
+		}
+		
+		const FVector End = Start + (Direction * MaxRange);
+		FHitResult Hit;
+		CountSceneTrace(IsTracingHeightGrid());
+		const bool bHit = (TraceScope != ETraceScope::World) ?
+			TraceTargetComponents(Start, End, QueryParams, Hit) :
+			World->LineTraceSingleByChannel(Hit, Start, End, TraceChannel, QueryParams);
+		
+		if (bHit)
+		{
+			WriteHit(RayIndex, Hit);
+		}
+		else if (bRetryOnFallback)
+		{
+			NeedsFallback[RayIndex] = true;
+			return;  // Cached once the fallback has answered too
+		}
+		
+		if (bUseTraceCache)
+		{
+			AddCachedTrace(CacheKey, bHit ? TConstArrayView<FHitResult>(&Hit, 1) : TConstArrayView<FHitResult>());
+		}
+	}, ForFlags);
+	
+	// 2. Fallback channel for the misses only
+	int32 FallbackCount = 0;
+	if (bRetryOnFallback)
+	{
+		TArray<int32> MissIndices;
+		for (int32 RayIndex = 0; RayIndex < RayCount; RayIndex++)
+		{
+			if (NeedsFallback[RayIndex])
+			{
+				MissIndices.Add(RayIndex);
+			}
+		}
+		FallbackCount = MissIndices.Num();
+		
+		ParallelFor(MissIndices.Num(), [&](int32 MissIndex)
+		{
+			const int32 RayIndex = MissIndices[MissIndex];
+			const FVector& Start = Origins[bSharedOrigin ? 0 : RayIndex];
+			const FVector& Direction = Directions[RayIndex];
+			const FVector End = Start + (Direction * MaxRange);
+			
+			FHitResult Hit;
+			CountSceneTrace();
+			const bool bHit = World->LineTraceSingleByChannel(Hit, Start, End, FallbackTraceChannel, QueryParams);
+			if (bHit)
+			{
+				WriteHit(RayIndex, Hit);
+			}
+			
+			if (bUseTraceCache)
+			{
+				AddCachedTrace(MakeTraceCacheKey(Start, Direction, false, nullptr),
+					bHit ? TConstArrayView<FHitResult>(&Hit, 1) : TConstArrayView<FHitResult>());
+			}
+		}, ForFlags);
+	}
+	
+	// 3. Intern the hit actors (few distinct actors per batch)
+	for (int32 RayIndex = 0; RayIndex < RayCount; RayIndex++)
+	{
+		if (OutResults.HitFlags[RayIndex])
+		{
+			OutResults.ActorIndices[RayIndex] = OutResults.Actors.AddUnique(RayActors[RayIndex]);
+			OutResults.HitCount++;
+		}
+	}
+	
+	if (UNKScannerLogger* Logger = UNKScannerLogger::Get(this))
+	{
+		Logger->Log(
+			FString::Printf(TEXT("Batched laser trace - Rays: %d, Hits: %d, Fallback retries: %d"),
+				RayCount, OutResults.HitCount, FallbackCount),
+			TEXT("LaserTracer")
+		);
+	}
+	
+	// Last-shot state follows the final ray of the batch
+	const int32 LastRay = RayCount - 1;
+	bLastShotHit = OutResults.HitFlags[LastRay];
+	LastHitActor = OutResults.GetActor(LastRay);
+	LastHitLocation = OutResults.Locations[LastRay];
+	LastHitDistance = OutResults.Distances[LastRay];
+	
+	if (bShowLaser)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_NKScanner_DebugDraw);
+		for (int32 RayIndex = 0; RayIndex < RayCount; RayIndex++)
+		{
+			const FVector& Start = Origins[bSharedOrigin ? 0 : RayIndex];
+			const bool bHit = OutResults.HitFlags[RayIndex];
+			DrawDiscoveryShot(Start, bHit ? OutResults.Locations[RayIndex] : Start + (Directions[RayIndex] * MaxRange), bHit);
+		}
+	}
+	
+	return OutResults.HitCount;
+}
+
+bool UNKLaserTracerComponent::PerformLayeredTraceFromPose(const FVector& Start, const FVector& Direction, const AActor* FilterActor, TArray<FHitResult>& OutHits)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_LayeredTrace);
+	
+	if (!GetWorld())
+	{
+		OutHits.Reset();
+		return false;
+	}
+	
+	if (TraceCacheValidatedFrame != GFrameCounter)
+	{
+		ValidateTraceCache();
+	}
+	
+	const int32 LayerCount = TraceRayLayersConcurrent(Start, Direction, BuildQueryParams(), FilterActor, OutHits);
+	const bool bHit = LayerCount > 0;
 	
-	// Log trace attempt
 	if (UNKScannerLogger* Logger = UNKScannerLogger::Get(this))
 	{
 		Logger->Log(
 			FString::Printf(
-				TEXT("Laser trace - Channel: %s, Complex: %s, Hit: %s, Distance: %.2fm"),
-				*UEnum::GetValueAsString(TEXT("Engine.ECollisionChannel"), TraceChannel),
-				bUseComplexCollision ? TEXT("YES") : TEXT("NO"),
-				bHit ? TEXT("YES") : TEXT("NO"),
-				bHit ? OutHit.Distance/100.0f : 0.0f
+				TEXT("Layered trace - Layers: %d, First Distance: %.2fm, Last Distance: %.2fm"),
+				LayerCount,
+				bHit ? OutHits[0].Distance/100.0f : 0.0f,
+				bHit ? OutHits.Last().Distance/100.0f : 0.0f
 			),
 			TEXT("LaserTracer")
 		);
+	}
+	
+	// Last shot state describes the first surface, like a single trace
+	UpdateLastShotState(bHit, bHit ? OutHits[0] : FHitResult());
+	
+	if (bShowLaser)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_NKScanner_DebugDraw);
+		DrawDiscoveryShot(Start, bHit ? OutHits[0].Location : Start + (Direction * MaxRange), bHit);
 		
-		if (bHit)
+		// Inner layers
+		for (int32 LayerIndex = 1; LayerIndex < LayerCount; LayerIndex++)
 		{
-			Logger->Log(
-				FString::Printf(TEXT("  Hit Actor: %s"), 
-					OutHit.GetActor() ? *OutHit.GetActor()->GetName() : TEXT("NULL")),
-				TEXT("LaserTracer")
-			);
+			if (DebugVisualizer)
+			{
+				DebugVisualizer->AddScanPoint(OutHits[LayerIndex].Location, FColor::Orange, 20.0f);
+			}
+			else
+			{
+				DrawDebugSphere(GetWorld(), OutHits[LayerIndex].Location, 10.0f, 8, FColor::Orange, true, VisualsLifetime);
+			}
 		}
 	}
 	
-	// Fallback trace if enabled and primary missed
-	if (!bHit && bUseFallbackChannel)
+	return bHit;
+}
+
+int32 UNKLaserTracerComponent::TraceRayLayersConcurrent(const FVector& Start, const FVector& Direction, const FCollisionQueryParams& QueryParams, const AActor* FilterActor, TArray<FHitResult>& OutHits) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_ConcurrentTrace);
+	
+	const FNKTraceCacheKey CacheKey = bUseTraceCache ? MakeTraceCacheKey(Start, Direction, true, FilterActor) : FNKTraceCacheKey();
+	if (bUseTraceCache && FindCachedTrace(CacheKey, OutHits))
+	{
+		return OutHits.Num();
+	}
+	
+	int32 LayerCount = TraceLayersOnChannel(Start, Direction, TraceChannel, QueryParams, FilterActor, OutHits);
+	
+	// Fallback channel only when nothing was recorded (target-only traces ignore channels)
+	if (LayerCount == 0 && bUseFallbackChannel && TraceScope == ETraceScope::World)
 	{
-		bHit = GetWorld()->LineTraceSingleByChannel(
-			OutHit,
-			Start,
-			End,
-			FallbackTraceChannel,
-			QueryParams
-		);
+		LayerCount = TraceLayersOnChannel(Start, Direction, FallbackTraceChannel, QueryParams, FilterActor, OutHits);
+	}
+	
+	if (bUseTraceCache)
+	{
+		AddCachedTrace(CacheKey, OutHits);
+	}
+	
+	return LayerCount;
+}
+
+int32 UNKLaserTracerComponent::TraceLayersOnChannel(const FVector& Start, const FVector& Direction, ECollisionChannel Channel, const FCollisionQueryParams& QueryParams, const AActor* FilterActor, TArray<FHitResult>& OutHits) const
+{
+	OutHits.Reset();
+	
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return 0;
+	}
+	
+	const FVector End = Start + (Direction * MaxRange);
+	const int32 MaxLayers = FMath::Max(MaxHitLayers, 1);
+	
+	// Segments restart just past a surface - never report the one being left
+	FCollisionQueryParams SegmentParams = QueryParams;
+	SegmentParams.bFindInitialOverlaps = false;
+	
+	// Filtered-out occluders also cost a segment, so allow some headroom before giving up
+	const int32 MaxSegments = MaxLayers * 4;
+	
+	FVector SegmentStart = Start;
+	TArray<FHitResult> SegmentHits;
+	
+	for (int32 Segment = 0; Segment < MaxSegments && OutHits.Num() < MaxLayers; Segment++)
+	{
+		SegmentHits.Reset();
+		CountSceneTrace(IsTracingHeightGrid());
 		
-		if (bHit)
+		bool bBlocked;
+		if (TraceScope != ETraceScope::World)
 		{
-			if (UNKScannerLogger* Logger = UNKScannerLogger::Get(this))
+			FHitResult BlockingHit;
+			bBlocked = TraceTargetComponents(SegmentStart, End, SegmentParams, BlockingHit);
+			if (bBlocked)
 			{
-				Logger->LogWarning(
-					FString::Printf(
-						TEXT("Fallback channel %s succeeded! Distance: %.2fm"),
-						*UEnum::GetValueAsString(TEXT("Engine.ECollisionChannel"), FallbackTraceChannel),
-						OutHit.Distance/100.0f
-					),
-					TEXT("LaserTracer")
-				);
+				SegmentHits.Add(BlockingHit);
+			}
+		}
+		else
+		{
+			// Overlaps come first in distance order, the blocking hit (if any) is last
+			bBlocked = World->LineTraceMultiByChannel(SegmentHits, SegmentStart, End, Channel, SegmentParams);
+		}
+		
+		for (const FHitResult& SegmentHit : SegmentHits)
+		{
+			if (SegmentHit.bStartPenetrating || (FilterActor && SegmentHit.GetActor() != FilterActor))
+			{
+				continue;
+			}
+			
+			// Report relative to the full ray, not the segment
+			FHitResult& LayerHit = OutHits.Add_GetRef(SegmentHit);
+			LayerHit.TraceStart = Start;
+			LayerHit.TraceEnd = End;
+			LayerHit.Distance = FVector::Dist(Start, LayerHit.Location);
+			LayerHit.Time = LayerHit.Distance / MaxRange;
+			
+			if (OutHits.Num() >= MaxLayers)
+			{
+				break;
 			}
 		}
+		
+		if (!bBlocked || SegmentHits.Num() == 0)
+		{
+			break;
+		}
+		
+		// Restart just past the blocking surface
+		SegmentStart = SegmentHits.Last().Location + (Direction * LayerRestartOffset);
+		if (FVector::DotProduct(End - SegmentStart, Direction) <= 0.0f)
+		{
+			break;
+		}
 	}
 	
-	// Update last shot state
+	return OutHits.Num();
+}
+
+void UNKLaserTracerComponent::SetTraceTarget(AActor* Target)
+{
+	if (TraceTarget.Get() != Target)
+	{
+		ClearTraceCache();  // Cached results belong to the previous target
+	}
+	
+	TraceTarget = Target;
+	TargetPrimitives.Reset();
+	
+	if (Target)
+	{
+		TArray<UPrimitiveComponent*> Primitives;
+		Target->GetComponents<UPrimitiveComponent>(Primitives);
+		
+		for (UPrimitiveComponent* Primitive : Primitives)
+		{
+			if (Primitive && Primitive->IsQueryCollisionEnabled())
+			{
+				TargetPrimitives.Add(Primitive);
+			}
+		}
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("UNKLaserTracerComponent: Trace target set to '%s' (%d queryable components)"),
+		Target ? *Target->GetName() : TEXT("NULL"), TargetPrimitives.Num());
+	
+	// Sampled here rather than on the first trace so the build stays out of the per-frame trace path
+	UpdateLandscapeGrid(true);
+	
+	// Re-setting the same target keeps the cache (repeat runs) - the next trace re-checks its signature
+	TraceCacheValidatedFrame = MAX_uint64;
+}
+
+bool UNKLaserTracerComponent::TraceTargetComponents(const FVector& Start, const FVector& End, const FCollisionQueryParams& QueryParams, FHitResult& OutHit) const
+{
+	// Landscape targets skip the collision geometry entirely
+	if (IsTracingHeightGrid())
+	{
+		return LandscapeGrid.TraceRay(Start, End, OutHit);
+	}
+	
+	const FVector StartToEnd = End - Start;
+	bool bHit = false;
+	
+	for (const TWeakObjectPtr<UPrimitiveComponent>& PrimitivePtr : TargetPrimitives)
+	{
+		const UPrimitiveComponent* Primitive = PrimitivePtr.Get();
+		if (!Primitive)
+		{
+			continue;
+		}
+		
+		// Cheap bounds rejection before touching the collision geometry
+		if (!FMath::LineBoxIntersection(Primitive->Bounds.GetBox(), Start, End, StartToEnd))
+		{
+			continue;
+		}
+		
+		// LineTraceComponent is non-const in the engine API but only reads the body
+		FHitResult ComponentHit;
+		if (const_cast<UPrimitiveComponent*>(Primitive)->LineTraceComponent(ComponentHit, Start, End, QueryParams))
+		{
+			if (!bHit || ComponentHit.Time < OutHit.Time)
+			{
+				OutHit = ComponentHit;
+				bHit = true;
+			}
+		}
+	}
+	
+	return bHit;
+}
+
+FCollisionQueryParams UNKLaserTracerComponent::BuildQueryParams() const
+{
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(GetOwner());
+	QueryParams.bTraceComplex = bUseComplexCollision;
+	QueryParams.bReturnPhysicalMaterial = true;
+	return QueryParams;
+}
+
+void UNKLaserTracerComponent::ValidateTraceCache()
+{
+	TraceCacheValidatedFrame = GFrameCounter;
+	UpdateLandscapeGrid(false);
+	
+	if (!bUseTraceCache)
+	{
+		return;
+	}
+	
+	// Settings are part of every key, so only the target's geometry can invalidate entries
+	const uint32 TargetSignature = NKScanSignature::HashActor(TraceTarget.Get());
+	if (TargetSignature == TraceCacheTargetSignature)
+	{
+		return;
+	}
+	
+	if (GetTraceCacheSize() > 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("UNKLaserTracerComponent: Trace target changed - %d cached traces dropped"), GetTraceCacheSize());
+	}
+	
+	ClearTraceCache();
+	TraceCacheTargetSignature = TargetSignature;
+}
+
+void UNKLaserTracerComponent::UpdateLandscapeGrid(bool bAllowBuild)
+{
+	ALandscapeProxy* Landscape = TraceScope == ETraceScope::LandscapeHeightfield ? Cast<ALandscapeProxy>(TraceTarget.Get()) : nullptr;
+	if (!Landscape)
+	{
+		if (LandscapeGrid.IsValid())
+		{
+			LandscapeGrid.Reset();
+			NKSCANNER_UPDATE_MEMORY_STAT(STAT_NKScanner_HeightGridMemory, ReportedGridBytes, 0);
+		}
+		LandscapeGridSignature = 0;
+		return;
+	}
+	
+	// Resampled only when the landscape is swapped, moved or edited, or the budget changes (failed builds are not retried)
+	uint32 Signature = HashCombineFast(GetTypeHash(Landscape), NKScanSignature::HashActor(Landscape));
+	Signature = HashCombineFast(Signature, GetTypeHash(MaxLandscapeGridSamples));
+	if (Signature == LandscapeGridSignature)
+	{
+		return;
+	}
+	
+	// Traces only drop a stale grid (its rays fall back to the components) - SetTraceTarget resamples it
+	if (!bAllowBuild)
+	{
+		if (LandscapeGrid.IsValid())
+		{
+			UE_LOG(LogTemp, Log, TEXT("UNKLaserTracerComponent: '%s' changed - height grid dropped until SetTraceTarget resamples it"), *Landscape->GetName());
+			LandscapeGrid.Reset();
+			NKSCANNER_UPDATE_MEMORY_STAT(STAT_NKScanner_HeightGridMemory, ReportedGridBytes, 0);
+		}
+		return;
+	}
+	LandscapeGridSignature = Signature;
+	
+	if (!LandscapeGrid.Build(Landscape, MaxLandscapeGridSamples))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UNKLaserTracerComponent: No height grid for '%s' - tracing its components instead"), *Landscape->GetName());
+	}
+	NKSCANNER_UPDATE_MEMORY_STAT(STAT_NKScanner_HeightGridMemory, ReportedGridBytes, LandscapeGrid.GetAllocatedSize());
+}
+
+void UNKLaserTracerComponent::ClearTraceCache()
+{
+	FRWScopeLock Lock(TraceCacheLock, SLT_Write);
+	TraceCache.Reset();
+}
+
+int32 UNKLaserTracerComponent::GetTraceCacheSize() const
+{
+	FRWScopeLock Lock(TraceCacheLock, SLT_ReadOnly);
+	return TraceCache.Num();
+}
+
+FNKTraceCacheKey UNKLaserTracerComponent::MakeTraceCacheKey(const FVector& Start, const FVector& Direction, bool bLayered, const AActor* FilterActor) const
+{
+	// Rays are computed analytically, so repeat scans reproduce them up to float noise
+	constexpr double DirectionScale = 1.0e6;
+	const double OriginScale = 1.0 / FMath::Max(TraceCacheOriginTolerance, 0.001f);
+	
+	FNKTraceCacheKey Key;
+	Key.OriginX = FMath::RoundToInt64(Start.X * OriginScale);
+	Key.OriginY = FMath::RoundToInt64(Start.Y * OriginScale);
+	Key.OriginZ = FMath::RoundToInt64(Start.Z * OriginScale);
+	Key.DirectionX = FMath::RoundToInt32(Direction.X * DirectionScale);
+	Key.DirectionY = FMath::RoundToInt32(Direction.Y * DirectionScale);
+	Key.DirectionZ = FMath::RoundToInt32(Direction.Z * DirectionScale);
+	Key.Variant = HashCombineFast(HashTraceSettings(), ((FilterActor ? FilterActor->GetUniqueID() : 0u) << 1) | (bLayered ? 1u : 0u));
+	return Key;
+}
+
+bool UNKLaserTracerComponent::FindCachedTrace(const FNKTraceCacheKey& Key, TArray<FHitResult>& OutHits) const
+{
+	{
+		FRWScopeLock Lock(TraceCacheLock, SLT_ReadOnly);
+		if (const TArray<FHitResult, TInlineAllocator<1>>* CachedHits = TraceCache.Find(Key))
+		{
+			OutHits.Reset();
+			OutHits.Append(*CachedHits);
+			TraceCacheHits.fetch_add(1, std::memory_order_relaxed);
+			INC_DWORD_STAT(STAT_NKScanner_TraceCacheHitsPerFrame);
+			return true;
+		}
+	}
+	
+	TraceCacheMisses.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+void UNKLaserTracerComponent::AddCachedTrace(const FNKTraceCacheKey& Key, TConstArrayView<FHitResult> Hits) const
+{
+	FRWScopeLock Lock(TraceCacheLock, SLT_Write);
+	
+	// Simple bound - a full flush is cheaper than tracking recency per ray
+	if (TraceCache.Num() >= MaxTraceCacheEntries)
+	{
+		TraceCache.Reset();
+	}
+	TraceCache.Add(Key, TArray<FHitResult, TInlineAllocator<1>>(Hits.GetData(), Hits.Num()));
+}
+
+uint32 UNKLaserTracerComponent::HashTraceSettings() const
+{
+	uint32 Hash = HashCombineFast(GetTypeHash(static_cast<uint8>(TraceChannel)), GetTypeHash(static_cast<uint8>(bUseComplexCollision)));
+	Hash = HashCombineFast(Hash, GetTypeHash(static_cast<uint8>(TraceScope)));
+	Hash = HashCombineFast(Hash, GetTypeHash(MaxRange));
+	Hash = HashCombineFast(Hash, GetTypeHash(static_cast<uint8>(bUseFallbackChannel)));
+	Hash = HashCombineFast(Hash, GetTypeHash(static_cast<uint8>(FallbackTraceChannel)));
+	Hash = HashCombineFast(Hash, GetTypeHash(MaxHitLayers));
+	Hash = HashCombineFast(Hash, GetTypeHash(LayerRestartOffset));
+	return HashCombineFast(Hash, GetTypeHash(GetOwner()));  // Owner is ignored by every query
+}
+
+void UNKLaserTracerComponent::UpdateLastShotState(bool bHit, const FHitResult& Hit)
+{
 	bLastShotHit = bHit;
 	if (bHit)
 	{
-		LastHitActor = OutHit.GetActor();
-		LastHitLocation = OutHit.Location;
-		LastHitDistance = OutHit.Distance;
+		LastHitActor = Hit.GetActor();
+		LastHitLocation = Hit.Location;
+		LastHitDistance = Hit.Distance;
 	}
 	else
 	{
@@ -113,14 +870,6 @@ bool UNKLaserTracerComponent::PerformTrace(FHitResult& OutHit)
 		LastHitLocation = FVector::ZeroVector;
 		LastHitDistance = 0.0f;
 	}
-	
-	// Draw visualization
-	if (bShowLaser)
-	{
-		DrawDiscoveryShot(Start, bHit ? OutHit.Location : End, bHit);
-	}
-	
-	return bHit;
 }
 
 bool UNKLaserTracerComponent::PerformTraceAtAngle(float Angle, FHitResult& OutHit)
@@ -156,6 +905,16 @@ void UNKLaserTracerComponent::DrawDiscoveryShot(const FVector& Start, const FVec
 	FColor Color = bHit ? FColor::Green : FColor::Red;
 	float Thickness = bHit ? 3.0f : 1.0f;
 	
+	if (DebugVisualizer)
+	{
+		DebugVisualizer->AddLine(Start, End, Color, Thickness);
+		if (bHit)
+		{
+			DebugVisualizer->AddScanPoint(End, FColor::Yellow, 30.0f);
+		}
+		return;
+	}
+	
 	// Draw persistent line
 	DrawDebugLine(GetWorld(), Start, End, Color, true, VisualsLifetime, 0, Thickness);
 	
@@ -168,6 +927,13 @@ void UNKLaserTracerComponent::DrawDiscoveryShot(const FVector& Start, const FVec
 
 void UNKLaserTracerComponent::ClearLaserVisuals()
 {
+	if (DebugVisualizer)
+	{
+		// Batched visuals clear without touching other persistent debug lines in the world
+		DebugVisualizer->ClearAllDebugVisuals();
+		return;
+	}
+	
 	if (GetWorld())
 	{
 		FlushPersistentDebugLines(GetWorld());
@@ -2,8 +2,17 @@
 
 #include "Scanner/Components/NKOrbitMapperComponent.h"
 #include "Scanner/Components/NKLaserTracerComponent.h"
+#include "Scanner/Components/NKScanStoreComponent.h"
+#include "Scanner/Components/NKDebugVisualizerComponent.h"
+#include "Scanner/Utilities/NKScanSignature.h"
+#include "Scanner/Utilities/NKScanVoxelGrid.h"
+#include "Scanner/Utilities/NKScanNormals.h"
+#include "Scanner/Utilities/NKScannerStats.h"
 #include "DrawDebugHelpers.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
+#include "Algo/Sort.h"
 
 UNKOrbitMapperComponent::UNKOrbitMapperComponent()
 {
@@ -16,6 +25,13 @@ void UNKOrbitMapperComponent::BeginPlay()
 	Super::BeginPlay();
 }
 
+void UNKOrbitMapperComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	NKSCANNER_UPDATE_MEMORY_STAT(STAT_NKScanner_MapperMemory, ReportedStatBytes, 0);
+	
+	Super::EndPlay(EndPlayReason);
+}
+
 void UNKOrbitMapperComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
@@ -55,12 +71,71 @@ void UNKOrbitMapperComponent::StartMapping(
 	// Reset counters
 	ShotCount = 0;
 	HitCount = 0;
+	TotalShots = FMath::CeilToInt(360.0f / FMath::Max(AngularStepDegrees, KINDA_SMALL_NUMBER));
+	NextShotIndex = 0;
+	PendingShots.Reset();
+	bHasPendingVisualFeedback = false;
+	TimeSinceVisualFeedback = 0.0f;
 	TimeSinceLastShot = 0.0f;
-	MappingHitPoints.Empty();  // Clear previous hit points
+	SpatialIndex.Reset(SpatialIndexCellSize);
+	bSpatialIndexStale = true;
+	DownsampledPoints.Empty();
+	DownsampledCounts.Empty();
+	DownsampledRingIndices.Empty();
+	DownsampleGeneration++;  // Drop any downsample still running for the previous scan
+	bDownsampling = false;
+	NormalGeneration++;
+	bEstimatingNormals = false;
+	RingCount = 1;
+	ScanRingHeights = { ScanHeight };
+	SectorSignatures.Reset();
+	
+	// Spiral mode climbs through the target bounds, revolution centers inset like stacked rings
+	bAdaptiveScan = MappingMode == EMappingMode::Adaptive;
+	bSpiralScan = MappingMode == EMappingMode::Spiral;
+	ShotsPerRevolution = TotalShots;
+	if (bSpiralScan)
+	{
+		const FBox TargetBounds = TargetActor->GetComponentsBoundingBox(true);
+		const float Pitch = FMath::Max(SpiralPitch, 1.0f);
+		SpiralBottomZ = FMath::Min(TargetBounds.Min.Z + (Pitch * 0.5f), TargetBounds.GetCenter().Z);
+		SpiralTopZ = FMath::Max(TargetBounds.Max.Z - (Pitch * 0.5f), SpiralBottomZ);
+		
+		// At least one full revolution, then climb until the top is reached
+		const float Revolutions = (SpiralTopZ - SpiralBottomZ) / Pitch;
+		TotalShots = FMath::Max(FMath::CeilToInt(Revolutions * ShotsPerRevolution) + 1, ShotsPerRevolution);
+		RingCount = FMath::DivideAndRoundUp(TotalShots, ShotsPerRevolution);
+		
+		ScanRingHeights.Reset(RingCount);
+		for (int32 Revolution = 0; Revolution < RingCount; Revolution++)
+		{
+			ScanRingHeights.Add(GetShotHeight(Revolution * ShotsPerRevolution));
+		}
+	}
+	
+	// Adaptive mode starts coarse and subdivides where the surface changes
+	AdaptiveSamples.Reset();
+	AdaptiveStack.Reset();
+	AdaptiveCoarseCount = FMath::Max(FMath::CeilToInt(360.0f / FMath::Max(AdaptiveCoarseStepDegrees, AngularStepDegrees)), 3);
+	AdaptiveCoarseIndex = 0;
+	AdaptivePreviousCoarseSample = INDEX_NONE;
+	
+	// Reserve for one hit per shot up front (layered rays may still grow it)
+	EnsureScanStore();
+	ScanStore->BeginScan(TotalShots);
+	
+	// The target may have changed earlier this frame - don't wait for the per-frame check
+	LaserTracer->ValidateTraceCache();
+	
+	if (MappingMode == EMappingMode::Adaptive && bUseAsyncTraces)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("OrbitMapper: Adaptive mode needs each result before choosing the next ray - using sync traces"));
+	}
 	
-	// Enable ticking
+	// Enable ticking (external schedulers drive FireShots instead)
 	bIsMapping = true;
-	SetComponentTickEnabled(true);
+	bIsPaused = false;
+	SetComponentTickEnabled(!bExternalScheduling);
 	
 	UE_LOG(LogTemp, Warning, TEXT("?????????????????????????????????????????????????????????"));
 	UE_LOG(LogTemp, Warning, TEXT("? ORBIT MAPPER - START MAPPING                          ?"));
@@ -72,173 +147,1429 @@ void UNKOrbitMapperComponent::StartMapping(
 	UE_LOG(LogTemp, Warning, TEXT("? Scan Height: %.2f m"), ScanHeight/100.0f);
 	UE_LOG(LogTemp, Warning, TEXT("? Start Angle: %.1f°"), StartAngle);
 	UE_LOG(LogTemp, Warning, TEXT("? Angular Step: %.1f°"), AngularStepDegrees);
-	UE_LOG(LogTemp, Warning, TEXT("? Expected Shots: ~%d"), FMath::CeilToInt(360.0f / AngularStepDegrees));
+	if (MappingMode == EMappingMode::Adaptive)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("? Mode: Adaptive (%d coarse shots, refined down to %.2f°)"),
+			AdaptiveCoarseCount, AngularStepDegrees);
+	}
+	else if (bSpiralScan)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("? Mode: Spiral (%.2f m - %.2f m, %.2f m/rev, %d revolutions, %d shots)"),
+			SpiralBottomZ/100.0f, SpiralTopZ/100.0f, SpiralPitch/100.0f, RingCount, TotalShots);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("? Expected Shots: %d"), TotalShots);
+	}
+	UE_LOG(LogTemp, Warning, TEXT("? Scheduling: %s"), bExternalScheduling ? TEXT("External (FireShots)") : bUseAsyncTraces ?
+		*FString::Printf(TEXT("Async (%d rays/batch)"), AsyncBatchSize) : bBurstMode ?
+		*FString::Printf(TEXT("Burst (%.1f ms/tick)"), BurstBudgetMs) :
+		*FString::Printf(TEXT("Fixed timestep (%.3f s/shot)"), ShotDelay));
+	UE_LOG(LogTemp, Warning, TEXT("? Virtual Pose: %s"), bVirtualPoseScanning ? TEXT("YES") : TEXT("NO"));
+	UE_LOG(LogTemp, Warning, TEXT("? Hit Layers: %s"), LaserTracer->bCaptureHitLayers ?
+		*FString::Printf(TEXT("Up to %d per ray"), LaserTracer->MaxHitLayers) : TEXT("First surface only"));
 	UE_LOG(LogTemp, Warning, TEXT("?????????????????????????????????????????????????????????"));
 }
 
-void UNKOrbitMapperComponent::StopMapping()
+void UNKOrbitMapperComponent::StartRingScan(
+	AActor* InTargetActor,
+	FVector InOrbitCenter,
+	float InOrbitRadius,
+	const TArray<float>& InRingHeights,
+	float InStartAngle,
+	UNKLaserTracerComponent* InLaserTracer)
 {
-	if (!bIsMapping)
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_RingScan);
+	
+	if (!InTargetActor || !InLaserTracer || InRingHeights.Num() == 0)
 	{
+		UE_LOG(LogTemp, Error, TEXT("OrbitMapper: Cannot start ring scan - invalid target, laser tracer or ring heights"));
+		OnMappingFailed.Broadcast();
 		return;
 	}
 	
-	bIsMapping = false;
-	SetComponentTickEnabled(false);
+	// Store configuration
+	TargetActor = InTargetActor;
+	LaserTracer = InLaserTracer;
+	OrbitCenter = InOrbitCenter;
+	OrbitRadius = InOrbitRadius;
+	ScanHeight = InRingHeights[0];
+	StartAngle = InStartAngle;
+	CurrentAngle = InStartAngle;
+	RingCount = InRingHeights.Num();
 	
-	UE_LOG(LogTemp, Warning, TEXT("OrbitMapper: Mapping stopped - %d shots taken, %d hits"), 
-		ShotCount, HitCount);
-}
-
-float UNKOrbitMapperComponent::GetProgressPercent() const
-{
-	if (!bIsMapping)
+	// Reset counters
+	const int32 ShotsPerRing = FMath::CeilToInt(360.0f / FMath::Max(AngularStepDegrees, KINDA_SMALL_NUMBER));
+	ShotCount = 0;
+	HitCount = 0;
+	TotalShots = ShotsPerRing * RingCount;
+	bAdaptiveScan = MappingMode == EMappingMode::Adaptive;
+	bSpiralScan = false;
+	ShotsPerRevolution = ShotsPerRing;
+	NextShotIndex = 0;
+	PendingShots.Reset();
+	SpatialIndex.Reset(SpatialIndexCellSize);
+	bSpatialIndexStale = true;
+	DownsampledPoints.Empty();
+	DownsampledCounts.Empty();
+	DownsampledRingIndices.Empty();
+	DownsampleGeneration++;  // Drop any downsample still running for the previous scan
+	bDownsampling = false;
+	NormalGeneration++;
+	bEstimatingNormals = false;
+	ScanRingHeights = InRingHeights;
+	SectorSignatures.Reset();
+	
+	// Adaptive rings start from the same coarse samples as an adaptive orbit (TotalShots is then an upper bound)
+	AdaptiveCoarseCount = FMath::Max(FMath::CeilToInt(360.0f / FMath::Max(AdaptiveCoarseStepDegrees, AngularStepDegrees)), 3);
+	
+	EnsureScanStore();
+	ScanStore->BeginScan(TotalShots);
+	
+	bIsMapping = true;
+	bIsPaused = false;
+	
+	UE_LOG(LogTemp, Warning, TEXT("?????????????????????????????????????????????????????????"));
+	UE_LOG(LogTemp, Warning, TEXT("? ORBIT MAPPER - START RING SCAN                        ?"));
+	UE_LOG(LogTemp, Warning, TEXT("?????????????????????????????????????????????????????????"));
+	UE_LOG(LogTemp, Warning, TEXT("? Target: %s"), *TargetActor->GetName());
+	UE_LOG(LogTemp, Warning, TEXT("? Rings: %d (%.2f m - %.2f m)"), RingCount,
+		InRingHeights[0]/100.0f, InRingHeights.Last()/100.0f);
+	UE_LOG(LogTemp, Warning, TEXT("? Orbit Radius: %.2f m"), OrbitRadius/100.0f);
+	if (bAdaptiveScan)
 	{
-		return 0.0f;
+		UE_LOG(LogTemp, Warning, TEXT("? Mode: Adaptive (%d coarse shots per ring, refined down to %.2f°)"),
+			AdaptiveCoarseCount, AngularStepDegrees);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("? Angular Step: %.1f°"), AngularStepDegrees);
 	}
+	UE_LOG(LogTemp, Warning, TEXT("? Expected Shots: %d%s"), TotalShots, bAdaptiveScan ? TEXT(" (at most)") : TEXT(""));
+	UE_LOG(LogTemp, Warning, TEXT("?????????????????????????????????????????????????????????"));
 	
-	// Calculate how far we've rotated from start
-	float AnglesTraveled = CurrentAngle - StartAngle;
+	TArray<FNKScanHit> BatchHits;
+	if (bAdaptiveScan)
+	{
+		// Every ring refined as one whole-orbit sector, all rings batched per subdivision level
+		const TArray<bool> WholeOrbit = { true };
+		ShotCount = TraceAdaptiveSectors(WholeOrbit, BatchHits);
+	}
+	else
+	{
+		// Every ring in one batch, ring-major - hits come back in ring order so the result is deterministic
+		FNKOrbitRayBatch Rays;
+		Rays.Reserve(TotalShots);
+		for (int32 RingIndex = 0; RingIndex < RingCount; RingIndex++)
+		{
+			const float RingHeight = InRingHeights[RingIndex];
+			const FVector RingCenter(OrbitCenter.X, OrbitCenter.Y, RingHeight);
+			
+			for (int32 ShotIndex = 0; ShotIndex < ShotsPerRing; ShotIndex++)
+			{
+				const float ShotAngle = StartAngle + (ShotIndex * AngularStepDegrees);
+				FVector Origin = CalculateOrbitPosition(ShotAngle);
+				Origin.Z = RingHeight;
+				
+				Rays.Add(Origin, CalculateLookAtRotation(Origin, RingCenter).Vector(), ShotAngle, RingIndex);
+			}
+		}
+		
+		TraceRayBatch(Rays, BatchHits);
+		ShotCount = TotalShots;
+	}
 	
-	// Normalize to 0-360 range
-	while (AnglesTraveled < 0.0f)
+	// Merge into one point cloud tagged by ring index
+	TArray<int32> RingHitCounts;
+	RingHitCounts.SetNumZeroed(RingCount);
+	for (const FNKScanHit& Hit : BatchHits)
 	{
-		AnglesTraveled += 360.0f;
+		AddMappingPoint(Hit);
+		RingHitCounts[Hit.RingIndex]++;
+		
+		if (bDrawDebugVisuals)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_NKScanner_DebugDraw);
+			DrawPersistentPoint(Hit.Location, 15.0f, FColor::Yellow);
+		}
 	}
-	while (AnglesTraveled >= 360.0f)
+	
+	for (int32 RingIndex = 0; RingIndex < RingCount; RingIndex++)
 	{
-		AnglesTraveled -= 360.0f;
+		UE_LOG(LogTemp, Log, TEXT("OrbitMapper: Ring %d at %.2f m - %d hits"),
+			RingIndex, InRingHeights[RingIndex]/100.0f, RingHitCounts[RingIndex]);
 	}
 	
-	return (AnglesTraveled / 360.0f) * 100.0f;
+	HitCount = ScanStore->GetPointCount();
+	CurrentAngle = StartAngle + (ShotsPerRing * AngularStepDegrees);
+	
+	CompletMapping();
 }
 
-FVector UNKOrbitMapperComponent::CalculateOrbitPosition(float Angle) const
+int32 UNKOrbitMapperComponent::RescanChangedSectors()
 {
-	// Convert angle to radians
-	float AngleRad = FMath::DegreesToRadians(Angle);
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_RingScan);
 	
-	// Calculate position on circle
-	float X = OrbitCenter.X + (OrbitRadius * FMath::Cos(AngleRad));
-	float Y = OrbitCenter.Y + (OrbitRadius * FMath::Sin(AngleRad));
-	float Z = ScanHeight;
+	if (bIsMapping)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("OrbitMapper: Cannot rescan while mapping"));
+		return 0;
+	}
 	
-	return FVector(X, Y, Z);
-}
-
-FRotator UNKOrbitMapperComponent::CalculateLookAtRotation(const FVector& FromPosition, const FVector& ToPosition) const
-{
-	return UKismetMathLibrary::FindLookAtRotation(FromPosition, ToPosition);
-}
-
-void UNKOrbitMapperComponent::PerformMappingStep(float DeltaTime)
-{
-	// Update shot delay timer
-	TimeSinceLastShot += DeltaTime;
+	if (!TargetActor || !LaserTracer || !ScanStore || SectorSignatures.Num() == 0 || ScanRingHeights.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("OrbitMapper: Cannot rescan - no completed scan to compare against"));
+		return 0;
+	}
 	
-	if (TimeSinceLastShot < ShotDelay)
+	// 1. Find the sectors whose target geometry changed
+	const int32 SectorCount = SectorSignatures.Num();
+	TArray<uint32> CurrentSignatures;
+	NKScanSignature::ComputeSectorSignatures(TargetActor, OrbitCenter, StartAngle, SectorCount, CurrentSignatures);
+	
+	TArray<bool> SectorChanged;
+	SectorChanged.Init(false, SectorCount);
+	int32 ChangedCount = 0;
+	for (int32 Sector = 0; Sector < SectorCount; Sector++)
 	{
-		return;  // Not time to shoot yet
+		if (CurrentSignatures[Sector] != SectorSignatures[Sector])
+		{
+			SectorChanged[Sector] = true;
+			ChangedCount++;
+		}
 	}
 	
-	// Reset timer
-	TimeSinceLastShot = 0.0f;
+	if (ChangedCount == 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("OrbitMapper: Rescan - no sector changed, %d points kept"), ScanStore->GetPointCount());
+		return 0;
+	}
 	
-	// Calculate current position on orbit
-	FVector OrbitPosition = CalculateOrbitPosition(CurrentAngle);
+	// 2. Drop the stale points of changed sectors (compacted in place, order kept)
+	const int32 PreviousPointCount = ScanStore->GetPointCount();
+	
+	// Angles fetched per call - compaction may first copy a mapped scan into the store's arrays
+	ScanStore->CompactPoints([&](int32 PointIndex)
+	{
+		return !SectorChanged[NKScanSignature::GetSectorIndex(ScanStore->GetAngles()[PointIndex], StartAngle, SectorCount)];
+	});
+	const int32 KeptCount = ScanStore->GetPointCount();
+	
+	// 3. Re-shoot the changed sectors on every ring (one batch, like ring scans) - adaptive scans refine them again
+	const int32 RescanRingCount = ScanRingHeights.Num();
 	
-	// Move camera to orbit position
-	AActor* Owner = GetOwner();
-	if (Owner)
+	// Changed target geometry flushes the tracer's cache here, before any worker reads it
+	LaserTracer->ValidateTraceCache();
+	
+	TArray<FNKScanHit> FreshHits;
+	int32 RescanShots;
+	if (bAdaptiveScan)
+	{
+		RescanShots = TraceAdaptiveSectors(SectorChanged, FreshHits);
+	}
+	else
 	{
-		Owner->SetActorLocation(OrbitPosition);
+		const int32 ShotsPerRing = FMath::CeilToInt(360.0f / FMath::Max(AngularStepDegrees, KINDA_SMALL_NUMBER));
 		
-		// Look at target center
-		FRotator LookAtRotation = CalculateLookAtRotation(OrbitPosition, OrbitCenter);
-		Owner->SetActorRotation(LookAtRotation);
+		FNKOrbitRayBatch Rays;
+		for (int32 RingIndex = 0; RingIndex < RescanRingCount; RingIndex++)
+		{
+			// Spiral revolutions are consecutive shot ranges climbing in Z, rings repeat the same shots at fixed heights
+			const int32 FirstShot = bSpiralScan ? RingIndex * ShotsPerRevolution : 0;
+			const int32 EndShot = bSpiralScan ? FMath::Min(FirstShot + ShotsPerRevolution, TotalShots) : ShotsPerRing;
+			
+			for (int32 ShotIndex = FirstShot; ShotIndex < EndShot; ShotIndex++)
+			{
+				const float ShotAngle = StartAngle + (ShotIndex * AngularStepDegrees);
+				if (!SectorChanged[NKScanSignature::GetSectorIndex(ShotAngle, StartAngle, SectorCount)])
+				{
+					continue;
+				}
+				
+				FVector Origin = CalculateOrbitPosition(ShotAngle);
+				Origin.Z = bSpiralScan ? GetShotHeight(ShotIndex) : ScanRingHeights[RingIndex];
+				const FVector RingCenter(OrbitCenter.X, OrbitCenter.Y,
+					bSpiralScan ? OrbitCenter.Z + (Origin.Z - ScanHeight) : Origin.Z);
+				
+				Rays.Add(Origin, CalculateLookAtRotation(Origin, RingCenter).Vector(), ShotAngle, RingIndex);
+			}
+		}
+		
+		RescanShots = Rays.Num();
+		TraceRayBatch(Rays, FreshHits);
 	}
+	const int32 FreshCount = FreshHits.Num();
 	
-	// Shoot laser - camera is already positioned and oriented correctly
-	FHitResult HitResult;
-	bool bHit = LaserTracer->PerformTrace(HitResult);
+	// 4. Splice the fresh points in and restore orbit order
+	for (const FNKScanHit& Hit : FreshHits)
+	{
+		AddMappingPoint(Hit);
+		
+		if (bDrawDebugVisuals)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_NKScanner_DebugDraw);
+			DrawPersistentPoint(Hit.Location, 15.0f, FColor::Magenta);
+		}
+	}
+	ScanStore->SortPoints();
 	
-	ShotCount++;
+	SectorSignatures = MoveTemp(CurrentSignatures);
+	ShotCount += RescanShots;
+	HitCount = ScanStore->GetPointCount();
 	
-	if (bHit)
+	// A running estimate no longer lines up with the spliced points
+	NormalGeneration++;
+	bEstimatingNormals = false;
+	if (bEstimateNormalsOnComplete)
+	{
+		StartNormalEstimation();
+	}
+	
+	UpdateScanStats();
+	
+	UE_LOG(LogTemp, Warning, TEXT("?????????????????????????????????????????????????????????"));
+	UE_LOG(LogTemp, Warning, TEXT("? ORBIT MAPPER - INCREMENTAL RESCAN                     ?"));
+	UE_LOG(LogTemp, Warning, TEXT("?????????????????????????????????????????????????????????"));
+	UE_LOG(LogTemp, Warning, TEXT("? Sectors Rescanned: %d / %d"), ChangedCount, SectorCount);
+	UE_LOG(LogTemp, Warning, TEXT("? Rings: %d"), RescanRingCount);
+	UE_LOG(LogTemp, Warning, TEXT("? Shots Fired: %d%s"), RescanShots, bAdaptiveScan ? TEXT(" (adaptive)") : TEXT(""));
+	UE_LOG(LogTemp, Warning, TEXT("? Points Dropped: %d"), PreviousPointCount - KeptCount);
+	UE_LOG(LogTemp, Warning, TEXT("? Points Added: %d"), FreshCount);
+	UE_LOG(LogTemp, Warning, TEXT("? Total Points: %d"), HitCount);
+	UE_LOG(LogTemp, Warning, TEXT("?????????????????????????????????????????????????????????"));
+	
+	return ChangedCount;
+}
+
+int32 UNKOrbitMapperComponent::TraceRayBatch(const FNKOrbitRayBatch& Rays, TArray<FNKScanHit>& OutHits, TArray<int32>* OutRayHitCounts)
+{
+	const int32 RayCount = Rays.Num();
+	const int32 PreviousHitCount = OutHits.Num();
+	if (OutRayHitCounts)
+	{
+		OutRayHitCounts->Init(0, RayCount);
+	}
+	
+	if (LaserTracer->bCaptureHitLayers)
+	{
+		// Layered traces stay per ray - already filtered to the target, in ray order
+		TArray<TArray<FHitResult>> RayLayers;
+		RayLayers.SetNum(RayCount);
+		
+		// Built once on the game thread, read-only inside the workers (trace cache checked up front too)
+		const FCollisionQueryParams QueryParams = LaserTracer->BuildQueryParams();
+		LaserTracer->ValidateTraceCache();
+		
+		ParallelFor(RayCount, [&](int32 RayIndex)
+		{
+			LaserTracer->TraceRayLayersConcurrent(Rays.Origins[RayIndex], Rays.Directions[RayIndex], QueryParams, TargetActor, RayLayers[RayIndex]);
+		});
+		
+		for (int32 RayIndex = 0; RayIndex < RayCount; RayIndex++)
+		{
+			const TArray<FHitResult>& LayerHits = RayLayers[RayIndex];
+			for (int32 LayerIndex = 0; LayerIndex < LayerHits.Num(); LayerIndex++)
+			{
+				OutHits.Add(FNKScanHit::FromHitResult(LayerHits[LayerIndex], Rays.Angles[RayIndex], Rays.Origins[RayIndex].Z, Rays.RingIndices[RayIndex], LayerIndex));
+			}
+			if (OutRayHitCounts)
+			{
+				(*OutRayHitCounts)[RayIndex] = LayerHits.Num();
+			}
+		}
+		return OutHits.Num() - PreviousHitCount;
+	}
+	
+	FNKTraceBatchResults Results;
+	LaserTracer->PerformTraces(Rays.Origins, Rays.Directions, Results);
+	
+	// Only hits on the target are kept
+	const int32 TargetIndex = Results.Actors.Find(TargetActor);
+	if (TargetIndex == INDEX_NONE)
+	{
+		return 0;
+	}
+	
+	for (int32 RayIndex = 0; RayIndex < RayCount; RayIndex++)
+	{
+		if (Results.ActorIndices[RayIndex] == TargetIndex)
+		{
+			OutHits.Add(Results.ToScanHit(RayIndex, Rays.Angles[RayIndex], Rays.Origins[RayIndex].Z, Rays.RingIndices[RayIndex], 0));
+			if (OutRayHitCounts)
+			{
+				(*OutRayHitCounts)[RayIndex] = 1;
+			}
+		}
+	}
+	return OutHits.Num() - PreviousHitCount;
+}
+
+void UNKOrbitMapperComponent::CollectTargetHits(const TArray<FHitResult>& Hits, float Angle, float ShotHeight, int32 RingIndex, TArray<FNKScanHit>& OutTargetHits) const
+{
+	const int32 FirstLayer = OutTargetHits.Num();
+	for (const FHitResult& HitResult : Hits)
 	{
 		// ✅ CRITICAL FIX: Only store hits that match the target actor!
 		AActor* HitActor = HitResult.GetActor();
 		if (HitActor == TargetActor)
 		{
-		HitCount++;
-			// **CRITICAL FIX: Store hit point for recording playback!**
-			MappingHitPoints.Add(HitResult.Location);
-			
-			if (bDrawDebugVisuals)
-			{
-				// Draw hit point
-				DrawDebugSphere(GetWorld(), HitResult.Location, 15.0f, 8, FColor::Yellow, true, -1.0f);
-				
-				// Draw camera position
-				DrawDebugSphere(GetWorld(), OrbitPosition, 30.0f, 8, FColor::Cyan, true, -1.0f);
+			OutTargetHits.Add(FNKScanHit::FromHitResult(HitResult, Angle, ShotHeight, RingIndex, OutTargetHits.Num() - FirstLayer));
 		}
 		else
 		{
 			// Hit something else - log for debugging
-			UE_LOG(LogTemp, Verbose, TEXT("OrbitMapper: Shot #%d hit '%s' (not target), ignoring"),
-				ShotCount, HitActor ? *HitActor->GetName() : TEXT("NULL"));
-		}
+			UE_LOG(LogTemp, Verbose, TEXT("OrbitMapper: Shot at angle %.1f° hit '%s' (not target), ignoring"),
+				Angle, HitActor ? *HitActor->GetName() : TEXT("NULL"));
 		}
 	}
-	
-	// Log every 10 shots
-	if (ShotCount % 10 == 0)
+}
+
+void UNKOrbitMapperComponent::SetScanStore(UNKScanStoreComponent* InScanStore)
+{
+	ScanStore = InScanStore;
+	bSpatialIndexStale = true;
+}
+
+void UNKOrbitMapperComponent::EnsureScanStore()
+{
+	if (ScanStore || !GetOwner())
 	{
-		UE_LOG(LogTemp, Log, TEXT("OrbitMapper: Shot #%d at angle %.1f° - Progress: %.1f%% - Hits: %d"),
-			ShotCount, CurrentAngle, GetProgressPercent(), HitCount);
+		return;
 	}
 	
-	// Draw debug orbit position
-	if (bDrawDebugVisuals)
+	ScanStore = NewObject<UNKScanStoreComponent>(GetOwner(), MakeUniqueObjectName(GetOwner(), UNKScanStoreComponent::StaticClass(), TEXT("MapperScanStore")));
+	ScanStore->SetMapper(this);
+	ScanStore->RegisterComponent();
+	bSpatialIndexStale = true;
+}
+
+void UNKOrbitMapperComponent::SyncSpatialIndex() const
+{
+	if (!ScanStore)
 	{
-		DrawDebugSphere(
-			GetWorld(),
-			OrbitPosition,
-			30.0f,  // 30cm radius
-			8,
-			FColor::Cyan,
-			false,
-			0.2f,  // Brief lifetime
-			0,
-			2.0f
-		);
+		if (SpatialIndex.Num() > 0)
+		{
+			SpatialIndex.Reset(SpatialIndexCellSize);
+		}
+		return;
 	}
 	
-	// Advance angle
-	CurrentAngle += AngularStepDegrees;
+	const TConstArrayView<FVector3f> Positions = ScanStore->GetPositions();
+	if (bSpatialIndexStale || IndexedPointRevision != ScanStore->GetPointRevision() || SpatialIndex.Num() > Positions.Num())
+	{
+		// Point indices moved - the index is keyed by them
+		SpatialIndex.Reset(SpatialIndexCellSize);
+		SpatialIndex.Build(Positions);
+		IndexedPointRevision = ScanStore->GetPointRevision();
+		bSpatialIndexStale = false;
+		return;
+	}
 	
-	// Check if we've completed a full orbit
-	if (CurrentAngle >= StartAngle + 360.0f)
+	// Only appended since the last sync
+	for (int32 PointIndex = SpatialIndex.Num(); PointIndex < Positions.Num(); PointIndex++)
 	{
-		CompletMapping();
+		SpatialIndex.Insert(FVector(Positions[PointIndex]));
 	}
 }
 
-void UNKOrbitMapperComponent::CompletMapping()
+const FNKScanSpatialIndex& UNKOrbitMapperComponent::GetSpatialIndex() const
 {
-	UE_LOG(LogTemp, Warning, TEXT("???????????????????????????????????????????????????????"));
-	UE_LOG(LogTemp, Warning, TEXT("?? ORBIT MAPPER - MAPPING COMPLETE"));
-	UE_LOG(LogTemp, Warning, TEXT("???????????????????????????????????????????????????????"));
-	UE_LOG(LogTemp, Warning, TEXT("  Total Shots: %d"), ShotCount);
-	UE_LOG(LogTemp, Warning, TEXT("  Total Hits: %d"), HitCount);
-	UE_LOG(LogTemp, Warning, TEXT("  Hit Rate: %.1f%%"), 
-		ShotCount > 0 ? (HitCount / (float)ShotCount * 100.0f) : 0.0f);
-	UE_LOG(LogTemp, Warning, TEXT("  Final Angle: %.1f°"), CurrentAngle);
-	UE_LOG(LogTemp, Warning, TEXT("  ? Hit Points Stored: %d"), MappingHitPoints.Num());
-	UE_LOG(LogTemp, Warning, TEXT("???????????????????????????????????????????????????????"));
-	
-	bIsMapping = false;
-	SetComponentTickEnabled(false);
-	
-	OnMappingComplete.Broadcast();
+	SyncSpatialIndex();
+	return SpatialIndex;
+}
+
+TArray<FVector> UNKOrbitMapperComponent::GetMappingHitPoints() const
+{
+	TArray<FVector> Points;
+	if (ScanStore)
+	{
+		Points.Reserve(ScanStore->GetPointCount());
+		for (const FVector3f& Position : ScanStore->GetPositions())
+		{
+			Points.Add(FVector(Position));
+		}
+	}
+	return Points;
+}
+
+TArray<int32> UNKOrbitMapperComponent::GetMappingHitRingIndices() const
+{
+	return ScanStore ? TArray<int32>(ScanStore->GetRingIndices()) : TArray<int32>();
+}
+
+TArray<int32> UNKOrbitMapperComponent::GetMappingHitLayerIndices() const
+{
+	TArray<int32> LayerIndices;
+	if (ScanStore)
+	{
+		LayerIndices.Reserve(ScanStore->GetPointCount());
+		for (const uint8 LayerIndex : ScanStore->GetLayerIndices())
+		{
+			LayerIndices.Add(LayerIndex);
+		}
+	}
+	return LayerIndices;
+}
+
+TArray<float> UNKOrbitMapperComponent::GetMappingHitAngles() const
+{
+	return ScanStore ? TArray<float>(ScanStore->GetAngles()) : TArray<float>();
+}
+
+TArray<FVector> UNKOrbitMapperComponent::GetMappingHitNormals() const
+{
+	TArray<FVector> Normals;
+	if (ScanStore)
+	{
+		Normals.Reserve(ScanStore->GetPointCount());
+		for (const FVector3f& Normal : ScanStore->GetNormals())
+		{
+			Normals.Add(FVector(Normal));
+		}
+	}
+	return Normals;
+}
+
+TArray<int32> UNKOrbitMapperComponent::FindHitPointsInRadius(const FVector& Center, float Radius) const
+{
+	TArray<int32> PointIndices;
+	GetSpatialIndex().QueryRadius(Center, Radius, PointIndices);
+	return PointIndices;
+}
+
+TArray<int32> UNKOrbitMapperComponent::FindNearestHitPoints(const FVector& Location, int32 Count, float MaxDistance) const
+{
+	TArray<int32> PointIndices;
+	GetSpatialIndex().QueryNearest(Location, Count, PointIndices, MaxDistance > 0.0f ? MaxDistance : UE_MAX_FLT);
+	return PointIndices;
+}
+
+bool UNKOrbitMapperComponent::RaycastHitPoints(const FVector& Origin, const FVector& Direction, float MaxDistance, float HitRadius, int32& OutPointIndex, float& OutDistance) const
+{
+	OutPointIndex = GetSpatialIndex().QueryRay(Origin, Direction, MaxDistance, HitRadius, OutDistance);
+	return OutPointIndex != INDEX_NONE;
+}
+
+TArray<FVector> UNKOrbitMapperComponent::GetRingPathPoints(int32 RingIndex) const
+{
+	TArray<FVector> RingPoints;
+	if (!ScanStore)
+	{
+		return RingPoints;
+	}
+	
+	const TConstArrayView<FVector3f> Positions = ScanStore->GetPositions();
+	const TConstArrayView<int32> RingIndices = ScanStore->GetRingIndices();
+	const TConstArrayView<uint8> LayerIndices = ScanStore->GetLayerIndices();
+	for (int32 i = 0; i < Positions.Num(); i++)
+	{
+		if (LayerIndices[i] == 0 && RingIndices[i] == RingIndex)
+		{
+			RingPoints.Add(FVector(Positions[i]));
+		}
+	}
+	return RingPoints;
+}
+
+void UNKOrbitMapperComponent::StopMapping()
+{
+	if (!bIsMapping)
+	{
+		return;
+	}
+	
+	bIsMapping = false;
+	bIsPaused = false;
+	SetComponentTickEnabled(false);
+	PendingShots.Reset();  // In-flight async results are simply never collected
+	
+	UE_LOG(LogTemp, Warning, TEXT("OrbitMapper: Mapping stopped - %d shots taken, %d hits"), 
+		ShotCount, HitCount);
+}
+
+void UNKOrbitMapperComponent::PauseMapping()
+{
+	if (!bIsMapping || bIsPaused)
+	{
+		return;
+	}
+	
+	bIsPaused = true;
+	SetComponentTickEnabled(false);
+	
+	UE_LOG(LogTemp, Log, TEXT("OrbitMapper: Mapping paused at shot %d"), ShotCount);
+}
+
+void UNKOrbitMapperComponent::ResumeMapping()
+{
+	if (!bIsMapping || !bIsPaused)
+	{
+		return;
+	}
+	
+	// Paused time is not owed any shots; expired async handles are resubmitted on the next step
+	bIsPaused = false;
+	TimeSinceLastShot = 0.0f;
+	SetComponentTickEnabled(!bExternalScheduling);
+	
+	UE_LOG(LogTemp, Log, TEXT("OrbitMapper: Mapping resumed at shot %d"), ShotCount);
+}
+
+int32 UNKOrbitMapperComponent::FireShots(int32 MaxShots)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_MappingStep);
+	
+	int32 ShotsFired = 0;
+	while (bIsMapping && !bIsPaused && ShotsFired < MaxShots)
+	{
+		if (CanBatchShots())
+		{
+			const int32 BatchShots = FireOrbitShotBatch(MaxShots - ShotsFired);
+			if (BatchShots == 0)
+			{
+				break;
+			}
+			ShotsFired += BatchShots;
+		}
+		else
+		{
+			FireNextShot();
+			ShotsFired++;
+		}
+	}
+	return ShotsFired;
+}
+
+float UNKOrbitMapperComponent::GetProgressPercent() const
+{
+	if (!bIsMapping)
+	{
+		return 0.0f;
+	}
+	
+	// Spirals wrap around many times - progress is by shot count
+	if (bSpiralScan)
+	{
+		return TotalShots > 0 ? (ShotCount / (float)TotalShots) * 100.0f : 0.0f;
+	}
+	
+	// Calculate how far we've rotated from start
+	float AnglesTraveled = CurrentAngle - StartAngle;
+	
+	// Normalize to 0-360 range
+	while (AnglesTraveled < 0.0f)
+	{
+		AnglesTraveled += 360.0f;
+	}
+	while (AnglesTraveled >= 360.0f)
+	{
+		AnglesTraveled -= 360.0f;
+	}
+	
+	return (AnglesTraveled / 360.0f) * 100.0f;
+}
+
+int64 UNKOrbitMapperComponent::GetAllocatedBytes() const
+{
+	return SpatialIndex.GetAllocatedSize()
+		+ DownsampledPoints.GetAllocatedSize() + DownsampledCounts.GetAllocatedSize()
+		+ DownsampledRingIndices.GetAllocatedSize();
+}
+
+void UNKOrbitMapperComponent::UpdateScanStats()
+{
+	SET_FLOAT_STAT(STAT_NKScanner_HitRate, ShotCount > 0 ? (HitCount / (float)ShotCount * 100.0f) : 0.0f);
+	NKSCANNER_UPDATE_MEMORY_STAT(STAT_NKScanner_MapperMemory, ReportedStatBytes, GetAllocatedBytes());
+}
+
+FVector UNKOrbitMapperComponent::CalculateOrbitPosition(float Angle) const
+{
+	// Convert angle to radians
+	float AngleRad = FMath::DegreesToRadians(Angle);
+	
+	// Calculate position on circle
+	float X = OrbitCenter.X + (OrbitRadius * FMath::Cos(AngleRad));
+	float Y = OrbitCenter.Y + (OrbitRadius * FMath::Sin(AngleRad));
+	float Z = ScanHeight;
+	
+	return FVector(X, Y, Z);
+}
+
+float UNKOrbitMapperComponent::GetShotHeight(int32 ShotIndex) const
+{
+	if (!bSpiralScan)
+	{
+		return ScanHeight;
+	}
+	
+	const float Revolutions = (ShotIndex * AngularStepDegrees) / 360.0f;
+	return FMath::Min(SpiralBottomZ + (Revolutions * FMath::Max(SpiralPitch, 1.0f)), SpiralTopZ);
+}
+
+int32 UNKOrbitMapperComponent::GetShotRingIndex(int32 ShotIndex) const
+{
+	return (bSpiralScan && ShotsPerRevolution > 0) ? ShotIndex / ShotsPerRevolution : 0;
+}
+
+FRotator UNKOrbitMapperComponent::CalculateLookAtRotation(const FVector& FromPosition, const FVector& ToPosition) const
+{
+	return UKismetMathLibrary::FindLookAtRotation(FromPosition, ToPosition);
+}
+
+void UNKOrbitMapperComponent::PerformMappingStep(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_MappingStep);
+	
+	if (bUseAsyncTraces && MappingMode != EMappingMode::Adaptive && LaserTracer->SupportsAsyncTraces())
+	{
+		PerformAsyncMappingStep();
+	}
+	else if (bBurstMode)
+	{
+		// Fire shots until the per-tick budget is spent (always at least one)
+		const double BudgetSeconds = BurstBudgetMs / 1000.0;
+		const double BurstStart = FPlatformTime::Seconds();
+		
+		do
+		{
+			if (CanBatchShots())
+			{
+				FireOrbitShotBatch(FMath::Max(BurstBatchSize, 1));
+			}
+			else
+			{
+				FireNextShot();
+			}
+		}
+		while (bIsMapping && (FPlatformTime::Seconds() - BurstStart) < BudgetSeconds);
+	}
+	else if (ShotDelay <= 0.0f)
+	{
+		// 0 = one shot every tick
+		FireNextShot();
+	}
+	else
+	{
+		// Fixed timestep - fire every shot that is due, carry the remainder over
+		TimeSinceLastShot += DeltaTime;
+		
+		while (bIsMapping && TimeSinceLastShot >= ShotDelay)
+		{
+			TimeSinceLastShot -= ShotDelay;
+			FireNextShot();
+		}
+	}
+	
+	UpdateVisualFeedback(DeltaTime);
+}
+
+void UNKOrbitMapperComponent::UpdateVisualFeedback(float DeltaTime)
+{
+	TimeSinceVisualFeedback += DeltaTime;
+	
+	if (!bHasPendingVisualFeedback || VisualFeedbackInterval <= 0.0f || TimeSinceVisualFeedback < VisualFeedbackInterval)
+	{
+		return;
+	}
+	
+	// Camera only follows the scan here - rays never depend on its transform
+	if (AActor* Owner = GetOwner())
+	{
+		// Orbit center follows the shot height (spiral climb)
+		const FVector LookAtCenter(OrbitCenter.X, OrbitCenter.Y, OrbitCenter.Z + (LastShotOrigin.Z - ScanHeight));
+		Owner->SetActorLocationAndRotation(LastShotOrigin, CalculateLookAtRotation(LastShotOrigin, LookAtCenter));
+	}
+	
+	TimeSinceVisualFeedback = 0.0f;
+	bHasPendingVisualFeedback = false;
+}
+
+void UNKOrbitMapperComponent::FireNextShot()
+{
+	if (MappingMode == EMappingMode::Adaptive)
+	{
+		// Emitting finished intervals costs no trace - keep going until one shot is fired
+		while (bIsMapping && !PerformAdaptiveStep())
+		{
+		}
+		return;
+	}
+	
+	FireOrbitShot(ShotCount);
+}
+
+void UNKOrbitMapperComponent::FireOrbitShot(int32 ShotIndex)
+{
+	// Angle is derived from the shot index (not accumulated) so every schedule produces the same rays
+	CurrentAngle = StartAngle + (ShotIndex * AngularStepDegrees);
+	
+	FVector OrbitPosition;
+	TArray<FHitResult> Hits;
+	TraceOrbitAngle(CurrentAngle, GetShotHeight(ShotIndex), OrbitPosition, Hits);
+	
+	TArray<FNKScanHit> TargetHits;
+	CollectTargetHits(Hits, CurrentAngle, OrbitPosition.Z, GetShotRingIndex(ShotIndex), TargetHits);
+	RecordShotResult(ShotIndex, OrbitPosition, TargetHits);
+}
+
+int32 UNKOrbitMapperComponent::FireOrbitShotBatch(int32 MaxShots)
+{
+	const int32 FirstShot = ShotCount;
+	const int32 BatchCount = FMath::Min(MaxShots, TotalShots - FirstShot);
+	if (BatchCount <= 0)
+	{
+		return 0;
+	}
+	
+	// Same rays TraceOrbitAngle computes for the virtual pose, one per shot index
+	FNKOrbitRayBatch Rays;
+	Rays.Reserve(BatchCount);
+	for (int32 ShotIndex = FirstShot; ShotIndex < FirstShot + BatchCount; ShotIndex++)
+	{
+		const float ShotAngle = StartAngle + (ShotIndex * AngularStepDegrees);
+		FVector Origin = CalculateOrbitPosition(ShotAngle);
+		Origin.Z = GetShotHeight(ShotIndex);
+		const FVector LookAtCenter(OrbitCenter.X, OrbitCenter.Y, OrbitCenter.Z + (Origin.Z - ScanHeight));
+		
+		Rays.Add(Origin, CalculateLookAtRotation(Origin, LookAtCenter).Vector(), ShotAngle, GetShotRingIndex(ShotIndex));
+	}
+	
+	TArray<FNKScanHit> BatchHits;
+	TArray<int32> RayHitCounts;
+	TraceRayBatch(Rays, BatchHits, &RayHitCounts);
+	
+	// Record in shot order - an event handler may stop mapping mid-batch
+	int32 HitCursor = 0;
+	int32 ShotsRecorded = 0;
+	for (; ShotsRecorded < BatchCount && bIsMapping; ShotsRecorded++)
+	{
+		const TConstArrayView<FNKScanHit> ShotHits(BatchHits.GetData() + HitCursor, RayHitCounts[ShotsRecorded]);
+		HitCursor += RayHitCounts[ShotsRecorded];
+		
+		// Camera follows the latest recorded ray via UpdateVisualFeedback
+		LastShotOrigin = Rays.Origins[ShotsRecorded];
+		bHasPendingVisualFeedback = true;
+		
+		RecordShotResult(FirstShot + ShotsRecorded, Rays.Origins[ShotsRecorded], ShotHits);
+	}
+	return ShotsRecorded;
+}
+
+bool UNKOrbitMapperComponent::TraceOrbitAngle(float Angle, float Height, FVector& OutOrbitPosition, TArray<FHitResult>& OutHits)
+{
+	OutHits.Reset();
+	
+	// Calculate current position on orbit
+	OutOrbitPosition = CalculateOrbitPosition(Angle);
+	OutOrbitPosition.Z = Height;
+	
+	// Look at target center (raised with the shot for spirals, OrbitCenter itself otherwise)
+	const FVector LookAtCenter(OrbitCenter.X, OrbitCenter.Y, OrbitCenter.Z + (Height - ScanHeight));
+	FRotator LookAtRotation = CalculateLookAtRotation(OutOrbitPosition, LookAtCenter);
+	
+	if (bVirtualPoseScanning)
+	{
+		// Shoot from the computed pose - camera only follows via UpdateVisualFeedback
+		LastShotOrigin = OutOrbitPosition;
+		bHasPendingVisualFeedback = true;
+	}
+	else if (AActor* Owner = GetOwner())
+	{
+		// Move camera to orbit position
+		Owner->SetActorLocation(OutOrbitPosition);
+		Owner->SetActorRotation(LookAtRotation);
+	}
+	
+	// Layered traces record every target surface along the ray (pose == camera pose when it was moved)
+	if (LaserTracer->bCaptureHitLayers)
+	{
+		return LaserTracer->PerformLayeredTraceFromPose(OutOrbitPosition, LookAtRotation.Vector(), TargetActor, OutHits);
+	}
+	
+	FHitResult HitResult;
+	const bool bHit = bVirtualPoseScanning ?
+		LaserTracer->PerformTraceFromPose(OutOrbitPosition, LookAtRotation.Vector(), HitResult) :
+		LaserTracer->PerformTrace(HitResult);  // Camera is already positioned and oriented correctly
+	
+	if (bHit)
+	{
+		OutHits.Add(HitResult);
+	}
+	return bHit;
+}
+
+bool UNKOrbitMapperComponent::PerformAdaptiveStep()
+{
+	// 1. Refine or emit the leftmost open interval (depth-first keeps output in angle order)
+	if (AdaptiveStack.Num() > 0)
+	{
+		const TPair<int32, int32> Interval = AdaptiveStack.Pop(EAllowShrinking::No);
+		const FNKAdaptiveSample Left = AdaptiveSamples[Interval.Key];
+		const FNKAdaptiveSample Right = AdaptiveSamples[Interval.Value];
+		
+		const float HalfSpan = (Right.Angle - Left.Angle) * 0.5f;
+		if (HalfSpan >= AngularStepDegrees - KINDA_SMALL_NUMBER && NeedsAdaptiveRefinement(Left, Right))
+		{
+			const int32 MidIndex = FireAdaptiveSample(Left.Angle + HalfSpan);
+			
+			// Right half pushed first so the left half is processed next
+			AdaptiveStack.Emplace(MidIndex, Interval.Value);
+			AdaptiveStack.Emplace(Interval.Key, MidIndex);
+			return true;
+		}
+		
+		// Interval is final - its left sample goes to the output
+		CurrentAngle = Left.Angle;
+		for (const FNKScanHit& TargetHit : Left.TargetHits)
+		{
+			StoreTargetHit(TargetHit, Left.OrbitPosition);
+		}
+		return false;
+	}
+	
+	// 2. Next coarse sample, opening the interval to the previous one
+	if (AdaptiveCoarseIndex <= AdaptiveCoarseCount)
+	{
+		const float CoarseStep = 360.0f / AdaptiveCoarseCount;
+		bool bFired = false;
+		int32 SampleIndex;
+		
+		if (AdaptiveCoarseIndex == AdaptiveCoarseCount)
+		{
+			// Closing the ring: reuse the first sample one revolution later instead of re-shooting it
+			FNKAdaptiveSample WrapSample = AdaptiveSamples[0];
+			WrapSample.Angle += 360.0f;
+			SampleIndex = AdaptiveSamples.Add(WrapSample);
+		}
+		else
+		{
+			SampleIndex = FireAdaptiveSample(StartAngle + (AdaptiveCoarseIndex * CoarseStep));
+			bFired = true;
+		}
+		
+		if (AdaptiveCoarseIndex > 0)
+		{
+			AdaptiveStack.Emplace(AdaptivePreviousCoarseSample, SampleIndex);
+		}
+		
+		AdaptivePreviousCoarseSample = SampleIndex;
+		AdaptiveCoarseIndex++;
+		return bFired;
+	}
+	
+	// 3. Every interval emitted - orbit complete
+	CurrentAngle = StartAngle + 360.0f;
+	CompletMapping();
+	return false;
+}
+
+int32 UNKOrbitMapperComponent::FireAdaptiveSample(float Angle)
+{
+	CurrentAngle = Angle;
+	
+	FNKAdaptiveSample Sample;
+	Sample.Angle = Angle;
+	
+	TArray<FHitResult> Hits;
+	TraceOrbitAngle(Angle, ScanHeight, Sample.OrbitPosition, Hits);
+	
+	ShotCount++;
+	
+	// Refinement only looks at the outer surface, deeper layers ride along
+	CollectTargetHits(Hits, Angle, ScanHeight, 0, Sample.TargetHits);
+	Sample.bHitTarget = Sample.TargetHits.Num() > 0;
+	
+	if (bDrawDebugVisuals)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_NKScanner_DebugDraw);
+		DrawDebugSphere(GetWorld(), Sample.OrbitPosition, 30.0f, 8, FColor::Cyan, false, 0.2f, 0, 2.0f);
+	}
+	
+	return AdaptiveSamples.Add(Sample);
+}
+
+bool UNKOrbitMapperComponent::NeedsAdaptiveRefinement(const FNKAdaptiveSample& Left, const FNKAdaptiveSample& Right) const
+{
+	// Silhouette edge - one side hits, the other misses
+	if (Left.bHitTarget != Right.bHitTarget)
+	{
+		return true;
+	}
+	
+	// Both missed - nothing to resolve
+	if (!Left.bHitTarget)
+	{
+		return false;
+	}
+	
+	// Depth discontinuity or surface turning
+	const FNKScanHit& LeftHit = Left.TargetHits[0];
+	const FNKScanHit& RightHit = Right.TargetHits[0];
+	if (FMath::Abs(LeftHit.Distance - RightHit.Distance) > AdaptiveDistanceThreshold)
+	{
+		return true;
+	}
+	
+	const float NormalCos = FVector::DotProduct(LeftHit.Normal, RightHit.Normal);
+	return NormalCos < FMath::Cos(FMath::DegreesToRadians(AdaptiveNormalThresholdDegrees));
+}
+
+int32 UNKOrbitMapperComponent::TraceAdaptiveSectors(const TArray<bool>& SectorChanged, TArray<FNKScanHit>& OutHits)
+{
+	const int32 SectorCount = SectorChanged.Num();
+	const float SectorSpan = 360.0f / SectorCount;
+	const float CoarseStep = 360.0f / FMath::Max(AdaptiveCoarseCount, 1);
+	
+	// 1. Each changed sector of every ring opens at its edge, takes the scan's coarse angles inside it and closes at the next edge
+	TArray<FNKAdaptiveSample> Samples;
+	TArray<float> Angles;
+	TArray<int32> Rings;
+	TBitArray<> ClosingSamples;
+	TArray<TPair<int32, int32>> OpenIntervals;
+	for (int32 RingIndex = 0; RingIndex < ScanRingHeights.Num(); RingIndex++)
+	{
+		for (int32 Sector = 0; Sector < SectorCount; Sector++)
+		{
+			if (!SectorChanged[Sector])
+			{
+				continue;
+			}
+			
+			const float SectorStart = Sector * SectorSpan;
+			const float SectorEnd = SectorStart + SectorSpan;
+			const int32 FirstSample = Angles.Num();
+			
+			Angles.Add(StartAngle + SectorStart);
+			for (int32 CoarseIndex = FMath::CeilToInt((SectorStart / CoarseStep) + KINDA_SMALL_NUMBER); CoarseIndex * CoarseStep < SectorEnd - KINDA_SMALL_NUMBER; CoarseIndex++)
+			{
+				Angles.Add(StartAngle + (CoarseIndex * CoarseStep));
+			}
+			Angles.Add(StartAngle + SectorEnd);
+			while (Rings.Num() < Angles.Num())
+			{
+				Rings.Add(RingIndex);
+			}
+			
+			// The closing edge belongs to the next sector - it only bounds the last interval
+			ClosingSamples.Add(false, Angles.Num() - FirstSample - 1);
+			ClosingSamples.Add(true);
+			for (int32 SampleIndex = FirstSample; SampleIndex < Angles.Num() - 1; SampleIndex++)
+			{
+				OpenIntervals.Emplace(SampleIndex, SampleIndex + 1);
+			}
+		}
+	}
+	
+	int32 RayCount = Angles.Num();
+	TraceAdaptiveBatch(Angles, Rings, Samples);
+	
+	// 2. Bisect every interval that still needs it, one batch per subdivision level (all rings together)
+	TArray<TPair<int32, int32>> SplitIntervals;
+	while (OpenIntervals.Num() > 0)
+	{
+		SplitIntervals.Reset();
+		Angles.Reset();
+		Rings.Reset();
+		for (const TPair<int32, int32>& Interval : OpenIntervals)
+		{
+			const FNKAdaptiveSample& Left = Samples[Interval.Key];
+			const FNKAdaptiveSample& Right = Samples[Interval.Value];
+			
+			const float HalfSpan = (Right.Angle - Left.Angle) * 0.5f;
+			if (HalfSpan >= AngularStepDegrees - KINDA_SMALL_NUMBER && NeedsAdaptiveRefinement(Left, Right))
+			{
+				SplitIntervals.Add(Interval);
+				Angles.Add(Left.Angle + HalfSpan);
+				Rings.Add(Left.RingIndex);
+			}
+		}
+		
+		if (Angles.Num() == 0)
+		{
+			break;
+		}
+		
+		const int32 FirstMidSample = Samples.Num();
+		RayCount += Angles.Num();
+		TraceAdaptiveBatch(Angles, Rings, Samples);
+		ClosingSamples.Add(false, Angles.Num());
+		
+		OpenIntervals.Reset();
+		for (int32 SplitIndex = 0; SplitIndex < SplitIntervals.Num(); SplitIndex++)
+		{
+			OpenIntervals.Emplace(SplitIntervals[SplitIndex].Key, FirstMidSample + SplitIndex);
+			OpenIntervals.Emplace(FirstMidSample + SplitIndex, SplitIntervals[SplitIndex].Value);
+		}
+	}
+	
+	// 3. Every sample inside the sectors goes to the output, ring by ring in orbit order
+	TArray<int32> OutputOrder;
+	OutputOrder.Reserve(Samples.Num());
+	for (int32 SampleIndex = 0; SampleIndex < Samples.Num(); SampleIndex++)
+	{
+		if (!ClosingSamples[SampleIndex])
+		{
+			OutputOrder.Add(SampleIndex);
+		}
+	}
+	Algo::Sort(OutputOrder, [&Samples](int32 A, int32 B)
+	{
+		if (Samples[A].RingIndex != Samples[B].RingIndex)
+		{
+			return Samples[A].RingIndex < Samples[B].RingIndex;
+		}
+		return Samples[A].Angle < Samples[B].Angle;
+	});
+	
+	for (const int32 SampleIndex : OutputOrder)
+	{
+		OutHits.Append(Samples[SampleIndex].TargetHits);
+	}
+	return RayCount;
+}
+
+void UNKOrbitMapperComponent::TraceAdaptiveBatch(const TArray<float>& Angles, const TArray<int32>& Rings, TArray<FNKAdaptiveSample>& InOutSamples)
+{
+	FNKOrbitRayBatch Rays;
+	Rays.Reserve(Angles.Num());
+	for (int32 RayIndex = 0; RayIndex < Angles.Num(); RayIndex++)
+	{
+		// Rings look at the orbit center raised to their own height, like uniform ring scans
+		const float RingHeight = ScanRingHeights[Rings[RayIndex]];
+		FVector Origin = CalculateOrbitPosition(Angles[RayIndex]);
+		Origin.Z = RingHeight;
+		const FVector RingCenter(OrbitCenter.X, OrbitCenter.Y, RingHeight);
+		
+		Rays.Add(Origin, CalculateLookAtRotation(Origin, RingCenter).Vector(), Angles[RayIndex], Rings[RayIndex]);
+	}
+	
+	TArray<FNKScanHit> BatchHits;
+	TArray<int32> RayHitCounts;
+	TraceRayBatch(Rays, BatchHits, &RayHitCounts);
+	
+	// Hits come back in ray order, RayHitCounts[i] of them per ray
+	int32 HitIndex = 0;
+	for (int32 RayIndex = 0; RayIndex < Rays.Num(); RayIndex++)
+	{
+		FNKAdaptiveSample& Sample = InOutSamples.AddDefaulted_GetRef();
+		Sample.Angle = Angles[RayIndex];
+		Sample.RingIndex = Rings[RayIndex];
+		Sample.OrbitPosition = Rays.Origins[RayIndex];
+		Sample.TargetHits.Append(BatchHits.GetData() + HitIndex, RayHitCounts[RayIndex]);
+		Sample.bHitTarget = RayHitCounts[RayIndex] > 0;
+		HitIndex += RayHitCounts[RayIndex];
+	}
+}
+
+void UNKOrbitMapperComponent::PerformAsyncMappingStep()
+{
+	// 1. Collect last frame's batch, strictly in submission order
+	int32 CollectedCount = 0;
+	while (CollectedCount < PendingShots.Num())
+	{
+		const FNKPendingOrbitShot PendingShot = PendingShots[CollectedCount];
+		
+		bool bHit = false;
+		TArray<FHitResult> Hits;
+		FHitResult& HitResult = Hits.AddDefaulted_GetRef();
+		if (!LaserTracer->QueryAsyncTrace(PendingShot.Handle, bHit, HitResult))
+		{
+			// Results are dropped together (e.g. a frame was skipped) - resubmit every expired ray in one pass
+			for (int32 PendingIndex = CollectedCount; PendingIndex < PendingShots.Num(); PendingIndex++)
+			{
+				FNKPendingOrbitShot& ExpiredShot = PendingShots[PendingIndex];
+				if (LaserTracer->IsAsyncTraceExpired(ExpiredShot.Handle))
+				{
+					ExpiredShot.Handle = LaserTracer->SubmitAsyncTrace(ExpiredShot.Origin, ExpiredShot.Direction);
+					ExpiredShot.bResubmitted = true;
+				}
+			}
+			break;  // Keep order - wait for next frame
+		}
+		
+		CollectedCount++;
+		if (!bHit)
+		{
+			Hits.Reset();
+		}
+		
+		TArray<FNKScanHit> TargetHits;
+		CollectTargetHits(Hits, StartAngle + (PendingShot.ShotIndex * AngularStepDegrees), PendingShot.Origin.Z,
+			GetShotRingIndex(PendingShot.ShotIndex), TargetHits);
+		RecordShotResult(PendingShot.ShotIndex, PendingShot.Origin, TargetHits);
+		
+		if (!bIsMapping)
+		{
+			return;  // Orbit completed (or stopped from an event handler)
+		}
+	}
+	PendingShots.RemoveAt(0, CollectedCount, EAllowShrinking::No);
+	
+	// Let resubmitted rays drain first - adding a batch on top would only grow the backlog
+	if (PendingShots.ContainsByPredicate([](const FNKPendingOrbitShot& Shot) { return Shot.bResubmitted; }))
+	{
+		return;
+	}
+	
+	// 2. Submit the next batch of orbit rays
+	const int32 BatchEnd = FMath::Min(NextShotIndex + FMath::Max(AsyncBatchSize, 1), TotalShots);
+	
+	for (; NextShotIndex < BatchEnd; NextShotIndex++)
+	{
+		const float ShotAngle = StartAngle + (NextShotIndex * AngularStepDegrees);
+		
+		FNKPendingOrbitShot& PendingShot = PendingShots.AddDefaulted_GetRef();
+		PendingShot.ShotIndex = NextShotIndex;
+		PendingShot.Origin = CalculateOrbitPosition(ShotAngle);
+		PendingShot.Origin.Z = GetShotHeight(NextShotIndex);
+		const FVector LookAtCenter(OrbitCenter.X, OrbitCenter.Y, OrbitCenter.Z + (PendingShot.Origin.Z - ScanHeight));
+		PendingShot.Direction = (LookAtCenter - PendingShot.Origin).GetSafeNormal();
+		PendingShot.Handle = LaserTracer->SubmitAsyncTrace(PendingShot.Origin, PendingShot.Direction);
+		
+		// Camera follows the latest submitted ray via UpdateVisualFeedback
+		LastShotOrigin = PendingShot.Origin;
+		bHasPendingVisualFeedback = true;
+	}
+}
+
+void UNKOrbitMapperComponent::RecordShotResult(int32 ShotIndex, const FVector& OrbitPosition, TConstArrayView<FNKScanHit> TargetHits)
+{
+	CurrentAngle = StartAngle + (ShotIndex * AngularStepDegrees);
+	
+	ShotCount++;
+	
+	for (const FNKScanHit& TargetHit : TargetHits)
+	{
+		StoreTargetHit(TargetHit, OrbitPosition);
+	}
+	
+	// Log every 10 shots
+	if (ShotCount % 10 == 0)
+	{
+		if (ScanStore)
+		{
+			ScanStore->NotifyProgress(GetProgressPercent());
+		}
+		
+		UpdateScanStats();
+		
+		UE_LOG(LogTemp, Log, TEXT("OrbitMapper: Shot #%d at angle %.1f° - Progress: %.1f%% - Hits: %d"),
+			ShotCount, CurrentAngle, GetProgressPercent(), HitCount);
+	}
+	
+	// Draw debug orbit position
+	if (bDrawDebugVisuals)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_NKScanner_DebugDraw);
+		DrawDebugSphere(
+			GetWorld(),
+			OrbitPosition,
+			30.0f,  // 30cm radius
+			8,
+			FColor::Cyan,
+			false,
+			0.2f,  // Brief lifetime
+			0,
+			2.0f
+		);
+	}
+	
+	// Check if we've completed a full orbit
+	if (ShotCount >= TotalShots)
+	{
+		CurrentAngle = StartAngle + (ShotCount * AngularStepDegrees);
+		CompletMapping();
+	}
+}
+
+void UNKOrbitMapperComponent::StoreTargetHit(const FNKScanHit& Hit, const FVector& OrbitPosition)
+{
+	HitCount++;
+	// **CRITICAL FIX: Store hit point for recording playback!**
+	AddMappingPoint(Hit);
+	
+	if (bDrawDebugVisuals)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_NKScanner_DebugDraw);
+		
+		// Draw hit point (inner layers in orange)
+		DrawPersistentPoint(Hit.Location, 15.0f, Hit.LayerIndex == 0 ? FColor::Yellow : FColor::Orange);
+		
+		// Draw camera position
+		DrawPersistentPoint(OrbitPosition, 30.0f, FColor::Cyan);
+	}
+}
+
+void UNKOrbitMapperComponent::DrawPersistentPoint(const FVector& Location, float Radius, FColor Color)
+{
+	if (DebugVisualizer)
+	{
+		// Sized like the sphere it replaces (Radius is half the rendered diameter)
+		DebugVisualizer->AddScanPoint(Location, Color, Radius * 2.0f);
+	}
+	else
+	{
+		DrawDebugSphere(GetWorld(), Location, Radius, 8, Color, true, -1.0f);
+	}
+}
+
+void UNKOrbitMapperComponent::AddMappingPoint(const FNKScanHit& Hit)
+{
+	INC_DWORD_STAT(STAT_NKScanner_HitsPerFrame);
+	
+	// The spatial index picks the point up on its next sync
+	if (ScanStore)
+	{
+		ScanStore->AddPoint(Hit);
+	}
+}
+
+void UNKOrbitMapperComponent::CompletMapping()
+{
+	UE_LOG(LogTemp, Warning, TEXT("???????????????????????????????????????????????????????"));
+	UE_LOG(LogTemp, Warning, TEXT("?? ORBIT MAPPER - MAPPING COMPLETE"));
+	UE_LOG(LogTemp, Warning, TEXT("???????????????????????????????????????????????????????"));
+	UE_LOG(LogTemp, Warning, TEXT("  Total Shots: %d"), ShotCount);
+	UE_LOG(LogTemp, Warning, TEXT("  Total Hits: %d"), HitCount);
+	UE_LOG(LogTemp, Warning, TEXT("  Hit Rate: %.1f%%"), 
+		ShotCount > 0 ? (HitCount / (float)ShotCount * 100.0f) : 0.0f);
+	UE_LOG(LogTemp, Warning, TEXT("  Final Angle: %.1f°"), CurrentAngle);
+	UE_LOG(LogTemp, Warning, TEXT("  ? Hit Points Stored: %d"), ScanStore ? ScanStore->GetPointCount() : 0);
+	UE_LOG(LogTemp, Warning, TEXT("???????????????????????????????????????????????????????"));
+	
+	bIsMapping = false;
+	SetComponentTickEnabled(false);
+	UpdateScanStats();
+	
+	// Baseline for incremental rescans
+	if (TargetActor)
+	{
+		NKScanSignature::ComputeSectorSignatures(TargetActor, OrbitCenter, StartAngle, FMath::Max(RescanSectorCount, 1), SectorSignatures);
+	}
+	
+	if (ScanStore)
+	{
+		ScanStore->NotifyScanComplete();
+	}
+	
+	// Keep spatial queries cheap for listeners of the completion event
+	SyncSpatialIndex();
+	
+	OnMappingComplete.Broadcast();
+	
+	if (bDownsampleOnComplete)
+	{
+		StartDownsample();
+	}
+	
+	if (bEstimateNormalsOnComplete)
+	{
+		StartNormalEstimation();
+	}
+}
+
+void UNKOrbitMapperComponent::StartNormalEstimation()
+{
+	if (!ScanStore)
+	{
+		return;
+	}
+	
+	const int32 Generation = ++NormalGeneration;
+	bEstimatingNormals = true;
+	
+	// Normals face the orbit position each point was shot from (at the point's own height)
+	const TConstArrayView<FVector3f> Positions = ScanStore->GetPositions();
+	const TConstArrayView<float> Angles = ScanStore->GetAngles();
+	const uint32 PointRevision = ScanStore->GetPointRevision();
+	TArray<FVector> PointSnapshot;
+	TArray<FVector> Viewpoints;
+	PointSnapshot.SetNumUninitialized(Positions.Num());
+	Viewpoints.SetNumUninitialized(Positions.Num());
+	for (int32 PointIndex = 0; PointIndex < Positions.Num(); PointIndex++)
+	{
+		PointSnapshot[PointIndex] = FVector(Positions[PointIndex]);
+		Viewpoints[PointIndex] = CalculateOrbitPosition(Angles[PointIndex]);
+		Viewpoints[PointIndex].Z = PointSnapshot[PointIndex].Z;
+	}
+	
+	const int32 NeighbourCount = NormalEstimationNeighbours;
+	const float NeighbourRadius = NormalEstimationRadius;
+	const float CellSize = SpatialIndexCellSize;
+	TWeakObjectPtr<UNKOrbitMapperComponent> WeakThis(this);
+	
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Generation, PointRevision, NeighbourCount, NeighbourRadius, CellSize, PointSnapshot = MoveTemp(PointSnapshot), Viewpoints = MoveTemp(Viewpoints)]()
+	{
+		// Own index over the snapshot - the live one keeps changing on the game thread
+		FNKScanSpatialIndex SnapshotIndex(CellSize);
+		SnapshotIndex.Build(PointSnapshot);
+		
+		TSharedRef<TArray<FVector>> Normals = MakeShared<TArray<FVector>>();
+		NKScanNormals::EstimateNormals(PointSnapshot, SnapshotIndex, Viewpoints, NeighbourCount, NeighbourRadius, *Normals);
+		
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Generation, PointRevision, Normals]()
+		{
+			UNKOrbitMapperComponent* Mapper = WeakThis.Get();
+			if (!Mapper || Mapper->NormalGeneration != Generation)
+			{
+				return;  // Component gone or superseded by a newer request
+			}
+			
+			Mapper->bEstimatingNormals = false;
+			UNKScanStoreComponent* Store = Mapper->ScanStore;
+			if (!Store || Store->GetPointRevision() != PointRevision || Store->GetPointCount() != Normals->Num())
+			{
+				return;  // Points changed underneath
+			}
+			
+			Store->SetNormals(*Normals);
+			
+			UE_LOG(LogTemp, Log, TEXT("OrbitMapper: Estimated %d normals"), Normals->Num());
+			
+			Mapper->OnNormalsEstimated.Broadcast(Normals->Num());
+		});
+	});
+}
+
+void UNKOrbitMapperComponent::StartDownsample()
+{
+	const int32 Generation = ++DownsampleGeneration;
+	bDownsampling = true;
+	
+	// Workers only ever see this snapshot, never the live store (copied straight from its attribute views)
+	TArray<FVector3f> PointSnapshot;
+	TArray<int32> RingSnapshot;
+	if (ScanStore)
+	{
+		PointSnapshot = ScanStore->GetPositions();
+		RingSnapshot = ScanStore->GetRingIndices();
+	}
+	const float VoxelSize = DownsampleVoxelSize;
+	TWeakObjectPtr<UNKOrbitMapperComponent> WeakThis(this);
+	
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Generation, VoxelSize, PointSnapshot = MoveTemp(PointSnapshot), RingSnapshot = MoveTemp(RingSnapshot)]()
+	{
+		TSharedRef<FNKVoxelDownsampleResult> Result = MakeShared<FNKVoxelDownsampleResult>();
+		NKScanVoxelGrid::Downsample(PointSnapshot, RingSnapshot, VoxelSize, *Result);
+		
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Generation, Result, InputCount = PointSnapshot.Num()]()
+		{
+			UNKOrbitMapperComponent* Mapper = WeakThis.Get();
+			if (!Mapper || Mapper->DownsampleGeneration != Generation)
+			{
+				return;  // Component gone or superseded
+			}
+			
+			Mapper->DownsampledPoints = MoveTemp(Result->Points);
+			Mapper->DownsampledCounts = MoveTemp(Result->Counts);
+			Mapper->DownsampledRingIndices = MoveTemp(Result->RingIndices);
+			Mapper->bDownsampling = false;
+			Mapper->UpdateScanStats();
+			
+			UE_LOG(LogTemp, Log, TEXT("OrbitMapper: Downsampled %d hits to %d voxels (%.1f cm)"),
+				InputCount, Mapper->DownsampledPoints.Num(), Result->VoxelSize);
+			
+			Mapper->OnDownsampleComplete.Broadcast(Mapper->DownsampledPoints.Num());
+		});
+	});
 }
\ No newline at end of file
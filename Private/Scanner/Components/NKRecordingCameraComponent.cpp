@@ -145,12 +145,21 @@ void UNKRecordingCameraComponent::StartPlayback(const TArray<FVector>& InMapping
 		return;
 	}
 	
-	// Store hit points
+	// Store hit points - the center is averaged over the full set, before simplification thins flat faces
 	MappingHitPoints = InMappingHitPoints;
+	OrbitCenter = CalculateOrbitCenter();
+	
+	if (bSimplifyPlaybackPath)
+	{
+		TArray<FVector> SimplifiedPoints = SimplifyClosedPath(InMappingHitPoints, PlaybackPathToleranceCm);
+		if (SimplifiedPoints.Num() >= 2)  // Otherwise degenerate (all within tolerance) - play the original
+		{
+			MappingHitPoints = MoveTemp(SimplifiedPoints);
+		}
+	}
 	
 	// Calculate path metrics
 	TotalPathLength = CalculateTotalPathLength();
-	OrbitCenter = CalculateOrbitCenter();
 	
 	// Reset state
 	CurrentDistance = 0.0f;
@@ -185,7 +194,7 @@ void UNKRecordingCameraComponent::StartPlayback(const TArray<FVector>& InMapping
 	UE_LOG(LogTemp, Warning, TEXT("???????????????????????????????????????????????????????"));
 	UE_LOG(LogTemp, Warning, TEXT("?? RECORDING CAMERA PLAYBACK STARTED"));
 	UE_LOG(LogTemp, Warning, TEXT("???????????????????????????????????????????????????????"));
-	UE_LOG(LogTemp, Warning, TEXT("  Hit Points: %d"), MappingHitPoints.Num());
+	UE_LOG(LogTemp, Warning, TEXT("  Hit Points: %d (path vertices: %d)"), InMappingHitPoints.Num(), MappingHitPoints.Num());
 	UE_LOG(LogTemp, Warning, TEXT("  Path Length: %.2f meters"), TotalPathLength / 100.0f);
 	UE_LOG(LogTemp, Warning, TEXT("  Orbit Center: (%.2f, %.2f, %.2f) m"), 
 		OrbitCenter.X/100.0f, OrbitCenter.Y/100.0f, OrbitCenter.Z/100.0f);
@@ -229,6 +238,74 @@ float UNKRecordingCameraComponent::GetProgress() const
 	return FMath::Clamp(CurrentDistance / TotalPathLength, 0.0f, 1.0f);
 }
 
+TArray<FVector> UNKRecordingCameraComponent::SimplifyClosedPath(const TArray<FVector>& Points, float Tolerance)
+{
+	const int32 PointCount = Points.Num();
+	if (PointCount < 4)
+	{
+		return Points;
+	}
+	
+	// A closed ring has no endpoints - split it at point 0 and the point farthest from it
+	int32 FarIndex = 1;
+	float FarDistanceSquared = 0.0f;
+	for (int32 i = 1; i < PointCount; i++)
+	{
+		const float DistanceSquared = FVector::DistSquared(Points[0], Points[i]);
+		if (DistanceSquared > FarDistanceSquared)
+		{
+			FarDistanceSquared = DistanceSquared;
+			FarIndex = i;
+		}
+	}
+	
+	TArray<bool> Keep;
+	Keep.SetNumZeroed(PointCount);
+	Keep[0] = true;
+	Keep[FarIndex] = true;
+	
+	// Spans are [First, Last] in unwrapped indices - Last == PointCount closes the ring back to point 0
+	TArray<TPair<int32, int32>, TInlineAllocator<64>> Spans;
+	Spans.Add(TPair<int32, int32>(0, FarIndex));
+	Spans.Add(TPair<int32, int32>(FarIndex, PointCount));
+	
+	while (Spans.Num() > 0)
+	{
+		const TPair<int32, int32> Span = Spans.Pop(EAllowShrinking::No);
+		const FVector& Start = Points[Span.Key];
+		const FVector& End = Points[Span.Value % PointCount];
+		
+		int32 WorstIndex = INDEX_NONE;
+		float WorstDistance = Tolerance;
+		for (int32 i = Span.Key + 1; i < Span.Value; i++)
+		{
+			const float Distance = FMath::PointDistToSegment(Points[i], Start, End);
+			if (Distance > WorstDistance)
+			{
+				WorstDistance = Distance;
+				WorstIndex = i;
+			}
+		}
+		
+		if (WorstIndex != INDEX_NONE)
+		{
+			Keep[WorstIndex] = true;
+			Spans.Add(TPair<int32, int32>(Span.Key, WorstIndex));
+			Spans.Add(TPair<int32, int32>(WorstIndex, Span.Value));
+		}
+	}
+	
+	TArray<FVector> Simplified;
+	for (int32 i = 0; i < PointCount; i++)
+	{
+		if (Keep[i])
+		{
+			Simplified.Add(Points[i]);
+		}
+	}
+	return Simplified;
+}
+
 float UNKRecordingCameraComponent::CalculateTotalPathLength() const
 {
 	if (MappingHitPoints.Num() < 2)
@@ -0,0 +1,431 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/Components/NKScanJobQueueComponent.h"
+#include "Scanner/Components/NKOrbitMapperComponent.h"
+#include "Scanner/Components/NKLaserTracerComponent.h"
+#include "Scanner/Components/NKScanStoreComponent.h"
+#include "Scanner/Utilities/NKScannerStats.h"
+#include "LandscapeProxy.h"
+#include "Algo/Count.h"
+
+UNKScanJobQueueComponent::UNKScanJobQueueComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;  // Only tick while jobs are queued or running
+}
+
+void UNKScanJobQueueComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_JobQueueTick);
+	
+	StartQueuedJobs();
+	
+	TArray<int32> ActiveJobIndices;
+	for (int32 JobIndex = 0; JobIndex < Jobs.Num(); JobIndex++)
+	{
+		if (IsJobActive(Jobs[JobIndex]))
+		{
+			ActiveJobIndices.Add(JobIndex);
+		}
+	}
+	
+	LastFrameTraceCount = 0;
+	if (ActiveJobIndices.Num() > 0)
+	{
+		// Equal shares per pass - budget left over by jobs that finish (or stall) goes round again
+		int32 RemainingTraces = TracesPerFrame;
+		bool bAnyProgress = true;
+		while (RemainingTraces > 0 && bAnyProgress)
+		{
+			bAnyProgress = false;
+			const int32 Share = FMath::Max(RemainingTraces / ActiveJobIndices.Num(), 1);
+			
+			for (int32 Offset = 0; Offset < ActiveJobIndices.Num() && RemainingTraces > 0; Offset++)
+			{
+				FNKScanJob& Job = Jobs[ActiveJobIndices[(ScheduleCursor + Offset) % ActiveJobIndices.Num()]];
+				if (!IsJobActive(Job))
+				{
+					continue;
+				}
+				
+				const int32 TracesUsed = StepJob(Job, FMath::Min(Share, RemainingTraces));
+				RemainingTraces -= TracesUsed;
+				bAnyProgress |= TracesUsed > 0;
+			}
+		}
+		
+		ScheduleCursor = (ScheduleCursor + 1) % ActiveJobIndices.Num();
+		LastFrameTraceCount = TracesPerFrame - RemainingTraces;
+	}
+	
+	BroadcastFinishedJobs();
+}
+
+// ===== Public API =====
+
+int32 UNKScanJobQueueComponent::EnqueueScanJob(AActor* Target, FNKScanJobFinishedDelegate OnFinished)
+{
+	if (!Target)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ScanJobQueue: Cannot enqueue a job without a target"));
+		return INDEX_NONE;
+	}
+	
+	FNKScanJob& Job = Jobs.AddDefaulted_GetRef();
+	Job.JobId = NextJobId++;
+	Job.Target = Target;
+	Job.OnFinished = OnFinished;
+	
+	SetComponentTickEnabled(true);
+	
+	UE_LOG(LogTemp, Log, TEXT("ScanJobQueue: Job %d queued for '%s'"), Job.JobId, *Target->GetName());
+	return Job.JobId;
+}
+
+TArray<int32> UNKScanJobQueueComponent::EnqueueScanJobs(const TArray<AActor*>& Targets)
+{
+	TArray<int32> JobIds;
+	JobIds.Reserve(Targets.Num());
+	for (AActor* Target : Targets)
+	{
+		JobIds.Add(EnqueueScanJob(Target, FNKScanJobFinishedDelegate()));
+	}
+	return JobIds;
+}
+
+bool UNKScanJobQueueComponent::CancelJob(int32 JobId)
+{
+	FNKScanJob* Job = FindJob(JobId);
+	if (!Job || (Job->State != EScanJobState::Queued && !IsJobActive(*Job)))
+	{
+		return false;
+	}
+	
+	FinishJob(*Job, EScanJobState::Cancelled);
+	BroadcastFinishedJobs();
+	return true;
+}
+
+void UNKScanJobQueueComponent::CancelAllJobs()
+{
+	for (FNKScanJob& Job : Jobs)
+	{
+		if (Job.State == EScanJobState::Queued || IsJobActive(Job))
+		{
+			FinishJob(Job, EScanJobState::Cancelled);
+		}
+	}
+	BroadcastFinishedJobs();
+}
+
+bool UNKScanJobQueueComponent::ReleaseJob(int32 JobId)
+{
+	const int32 JobIndex = Jobs.IndexOfByPredicate([JobId](const FNKScanJob& Job) { return Job.JobId == JobId; });
+	if (JobIndex == INDEX_NONE || Jobs[JobIndex].State == EScanJobState::Queued || IsJobActive(Jobs[JobIndex]))
+	{
+		return false;
+	}
+	
+	const FNKScanJob& Job = Jobs[JobIndex];
+	if (Job.Mapper)
+	{
+		Job.Mapper->DestroyComponent();
+	}
+	if (Job.Tracer)
+	{
+		Job.Tracer->DestroyComponent();
+	}
+	if (Job.ScanStore)
+	{
+		Job.ScanStore->DestroyComponent();
+	}
+	
+	Jobs.RemoveAt(JobIndex);
+	return true;
+}
+
+// ===== Job Queries =====
+
+EScanJobState UNKScanJobQueueComponent::GetJobState(int32 JobId) const
+{
+	const FNKScanJob* Job = FindJob(JobId);
+	return Job ? Job->State : EScanJobState::Failed;
+}
+
+UNKScanStoreComponent* UNKScanJobQueueComponent::GetJobScanStore(int32 JobId) const
+{
+	const FNKScanJob* Job = FindJob(JobId);
+	return Job ? Job->ScanStore : nullptr;
+}
+
+UNKOrbitMapperComponent* UNKScanJobQueueComponent::GetJobMapper(int32 JobId) const
+{
+	const FNKScanJob* Job = FindJob(JobId);
+	return Job ? Job->Mapper : nullptr;
+}
+
+float UNKScanJobQueueComponent::GetJobProgress(int32 JobId) const
+{
+	const FNKScanJob* Job = FindJob(JobId);
+	if (!Job)
+	{
+		return 0.0f;
+	}
+	
+	if (Job->State == EScanJobState::Complete)
+	{
+		return 100.0f;
+	}
+	return (Job->State == EScanJobState::Mapping && Job->Mapper) ? Job->Mapper->GetProgressPercent() : 0.0f;
+}
+
+int32 UNKScanJobQueueComponent::GetJobTraceCount(int32 JobId) const
+{
+	const FNKScanJob* Job = FindJob(JobId);
+	return Job ? Job->TracesUsed : 0;
+}
+
+int32 UNKScanJobQueueComponent::GetQueuedJobCount() const
+{
+	return Algo::CountIf(Jobs, [](const FNKScanJob& Job) { return Job.State == EScanJobState::Queued; });
+}
+
+int32 UNKScanJobQueueComponent::GetActiveJobCount() const
+{
+	return Algo::CountIf(Jobs, [](const FNKScanJob& Job) { return IsJobActive(Job); });
+}
+
+// ===== Internal Methods =====
+
+FNKScanJob* UNKScanJobQueueComponent::FindJob(int32 JobId)
+{
+	return Jobs.FindByPredicate([JobId](const FNKScanJob& Job) { return Job.JobId == JobId; });
+}
+
+const FNKScanJob* UNKScanJobQueueComponent::FindJob(int32 JobId) const
+{
+	return Jobs.FindByPredicate([JobId](const FNKScanJob& Job) { return Job.JobId == JobId; });
+}
+
+void UNKScanJobQueueComponent::StartQueuedJobs()
+{
+	int32 ActiveCount = GetActiveJobCount();
+	for (FNKScanJob& Job : Jobs)
+	{
+		if (ActiveCount >= MaxConcurrentJobs)
+		{
+			break;
+		}
+		
+		if (Job.State != EScanJobState::Queued)
+		{
+			continue;
+		}
+		
+		if (StartJob(Job))
+		{
+			ActiveCount++;
+		}
+		else
+		{
+			FinishJob(Job, EScanJobState::Failed);
+		}
+	}
+}
+
+bool UNKScanJobQueueComponent::StartJob(FNKScanJob& Job)
+{
+	AActor* Target = Job.Target.Get();
+	AActor* Owner = GetOwner();
+	if (!Target || !Owner)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ScanJobQueue: Job %d - target no longer exists"), Job.JobId);
+		return false;
+	}
+	
+	const FBox TargetBounds = Target->GetComponentsBoundingBox(true);
+	if (!TargetBounds.IsValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ScanJobQueue: Job %d - '%s' has no collision bounds"), Job.JobId, *Target->GetName());
+		return false;
+	}
+	
+	// Same orbit the camera uses in Relative mode: bounding sphere + clearance, height as a percentage of the bounds
+	const FVector TargetCenter = TargetBounds.GetCenter();
+	Job.OrbitRadius = TargetBounds.GetExtent().Size() + OrbitClearance;
+	Job.ScanHeight = FMath::Lerp(TargetBounds.Min.Z, TargetBounds.Max.Z, HeightPercent / 100.0f);
+	Job.OrbitCenter = FVector(TargetCenter.X, TargetCenter.Y, Job.ScanHeight);
+	
+	// Start the discovery sweep on the side facing the scanner
+	const FVector ToOwner = Owner->GetActorLocation() - TargetCenter;
+	Job.DiscoveryStartAngle = ToOwner.SizeSquared2D() > 1.0f ? FMath::RadiansToDegrees(FMath::Atan2(ToOwner.Y, ToOwner.X)) : 0.0f;
+	Job.DiscoveryShots = 0;
+	
+	const FString ComponentPrefix = FString::Printf(TEXT("ScanJob%d_"), Job.JobId);
+	
+	Job.Tracer = NewObject<UNKLaserTracerComponent>(Owner, *(ComponentPrefix + TEXT("LaserTracer")));
+	Job.Tracer->TraceChannel = ECC_WorldStatic;
+	Job.Tracer->bUseComplexCollision = true;
+	Job.Tracer->MaxRange = Job.OrbitRadius * 2.0f;  // Orbit to the far side of the bounding sphere
+	if (bLandscapeHeightfieldTraces && Target->IsA<ALandscapeProxy>())
+	{
+		Job.Tracer->TraceScope = ETraceScope::LandscapeHeightfield;
+	}
+	else
+	{
+		Job.Tracer->TraceScope = bTraceTargetOnly ? ETraceScope::TargetOnly : ETraceScope::World;
+	}
+	Job.Tracer->bCaptureHitLayers = bCaptureHitLayers;
+	Job.Tracer->MaxHitLayers = MaxHitLayers;
+	Job.Tracer->bShowLaser = bDrawDebugVisuals;
+	Job.Tracer->RegisterComponent();
+	Job.Tracer->SetTraceTarget(Target);
+	
+	Job.ScanStore = NewObject<UNKScanStoreComponent>(Owner, *(ComponentPrefix + TEXT("ScanStore")));
+	Job.ScanStore->TargetActor = Target;
+	Job.ScanStore->RegisterComponent();
+	
+	// Virtual pose + external scheduling: the mapper never moves the owner and only fires when stepped
+	Job.Mapper = NewObject<UNKOrbitMapperComponent>(Owner, *(ComponentPrefix + TEXT("OrbitMapper")));
+	Job.Mapper->MappingMode = MappingMode;
+	Job.Mapper->AngularStepDegrees = AngularStepDegrees;
+	Job.Mapper->SpiralPitch = SpiralPitch;
+	Job.Mapper->bExternalScheduling = true;
+	Job.Mapper->bVirtualPoseScanning = true;
+	Job.Mapper->bUseAsyncTraces = false;
+	Job.Mapper->bBurstMode = false;
+	Job.Mapper->VisualFeedbackInterval = 0.0f;
+	Job.Mapper->bEstimateNormalsOnComplete = bEstimateNormals;
+	Job.Mapper->bDrawDebugVisuals = bDrawDebugVisuals;
+	Job.Mapper->RegisterComponent();
+	Job.Mapper->SetScanStore(Job.ScanStore);
+	Job.ScanStore->SetMapper(Job.Mapper);
+	
+	Job.State = EScanJobState::Discovering;
+	
+	UE_LOG(LogTemp, Log, TEXT("ScanJobQueue: Job %d started for '%s' (orbit %.2f m at %.2f m)"),
+		Job.JobId, *Target->GetName(), Job.OrbitRadius / 100.0f, Job.ScanHeight / 100.0f);
+	return true;
+}
+
+int32 UNKScanJobQueueComponent::StepJob(FNKScanJob& Job, int32 MaxTraces)
+{
+	if (!Job.Target.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ScanJobQueue: Job %d - target destroyed while scanning"), Job.JobId);
+		FinishJob(Job, EScanJobState::Failed);
+		return 0;
+	}
+	
+	int32 TracesUsed = 0;
+	if (Job.State == EScanJobState::Discovering)
+	{
+		TracesUsed += StepDiscovery(Job, MaxTraces);
+	}
+	
+	// Discovery may hand over to mapping mid-step - the rest of the share goes to mapping shots
+	if (Job.State == EScanJobState::Mapping && TracesUsed < MaxTraces)
+	{
+		TracesUsed += Job.Mapper->FireShots(MaxTraces - TracesUsed);
+		
+		if (!Job.Mapper->IsMapping())
+		{
+			FinishJob(Job, EScanJobState::Complete);
+		}
+	}
+	
+	Job.TracesUsed += TracesUsed;
+	return TracesUsed;
+}
+
+int32 UNKScanJobQueueComponent::StepDiscovery(FNKScanJob& Job, int32 MaxTraces)
+{
+	AActor* Target = Job.Target.Get();
+	const float StepDegrees = FMath::Max(DiscoveryStepDegrees, 0.1f);
+	
+	int32 TracesUsed = 0;
+	while (TracesUsed < MaxTraces && Job.State == EScanJobState::Discovering)
+	{
+		// Shoot from the orbit at the orbit center, exactly like the mapper's first shot
+		const float Angle = Job.DiscoveryStartAngle + (Job.DiscoveryShots * StepDegrees);
+		const float AngleRad = FMath::DegreesToRadians(Angle);
+		const FVector Origin = Job.OrbitCenter + FVector(FMath::Cos(AngleRad), FMath::Sin(AngleRad), 0.0f) * Job.OrbitRadius;
+		
+		FHitResult HitResult;
+		const bool bHit = Job.Tracer->PerformTraceFromPose(Origin, (Job.OrbitCenter - Origin).GetSafeNormal(), HitResult);
+		Job.DiscoveryShots++;
+		TracesUsed++;
+		
+		if (bHit && HitResult.GetActor() == Target)
+		{
+			// Mapping starts at the first hit, as after a camera discovery
+			Job.State = EScanJobState::Mapping;
+			Job.Mapper->StartMapping(Target, Job.OrbitCenter, Job.OrbitRadius, Job.ScanHeight, Angle, Job.Tracer);
+			
+			if (!Job.Mapper->IsMapping())
+			{
+				FinishJob(Job, EScanJobState::Failed);
+			}
+		}
+		else if (Job.DiscoveryShots * StepDegrees >= 360.0f)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ScanJobQueue: Job %d - '%s' not hit in %d discovery shots"),
+				Job.JobId, *Target->GetName(), Job.DiscoveryShots);
+			FinishJob(Job, EScanJobState::Failed);
+		}
+	}
+	return TracesUsed;
+}
+
+void UNKScanJobQueueComponent::FinishJob(FNKScanJob& Job, EScanJobState FinalState)
+{
+	if (Job.Mapper && Job.Mapper->IsMapping())
+	{
+		Job.Mapper->StopMapping();
+	}
+	
+	Job.State = FinalState;
+	FinishedJobIds.Add(Job.JobId);
+	
+	UE_LOG(LogTemp, Log, TEXT("ScanJobQueue: Job %d %s - %d traces, %d points"),
+		Job.JobId, *UEnum::GetValueAsString(FinalState), Job.TracesUsed,
+		Job.ScanStore ? Job.ScanStore->GetPointCount() : 0);
+}
+
+void UNKScanJobQueueComponent::BroadcastFinishedJobs()
+{
+	// Handlers may enqueue, cancel or release jobs - work on copies, look every job up again
+	const TArray<int32> FinishedIds = MoveTemp(FinishedJobIds);
+	FinishedJobIds.Reset();
+	
+	for (int32 JobId : FinishedIds)
+	{
+		const FNKScanJob* Job = FindJob(JobId);
+		if (!Job)
+		{
+			continue;
+		}
+		
+		const EScanJobState FinalState = Job->State;
+		UNKScanStoreComponent* JobStore = Job->ScanStore;
+		const FNKScanJobFinishedDelegate OnFinished = Job->OnFinished;
+		
+		if (FinalState == EScanJobState::Complete)
+		{
+			OnJobComplete.Broadcast(JobId, JobStore);
+		}
+		else
+		{
+			OnJobFailed.Broadcast(JobId, FinalState);
+		}
+		OnFinished.ExecuteIfBound(JobId, FinalState);
+	}
+	
+	if (IsComponentTickEnabled() && GetQueuedJobCount() == 0 && GetActiveJobCount() == 0)
+	{
+		SetComponentTickEnabled(false);
+		OnAllJobsFinished.Broadcast();
+	}
+}
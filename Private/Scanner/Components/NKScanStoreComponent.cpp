@@ -0,0 +1,722 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/Components/NKScanStoreComponent.h"
+#include "Scanner/Components/NKOrbitMapperComponent.h"
+#include "Scanner/Components/NKLaserTracerComponent.h"
+#include "Scanner/Utilities/NKScannerStats.h"
+#include "Components/PrimitiveComponent.h"
+#include "Algo/StableSort.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonReader.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+
+namespace
+{
+	// JSON layout: { "format", "version", "pointCount", "scanDuration", "sources": [{actor, component}],
+	//                "points": [[px, py, pz, nx, ny, nz, angle, height, distance, time, ring, layer, source], ...] }
+	// Points are rows of plain numbers so neither side ever needs an object per point.
+	const TCHAR* const JsonFormatName = TEXT("nkscan");
+	constexpr int32 JsonFormatVersion = 1;
+	constexpr int32 JsonPointFieldCount = 13;
+	
+	typedef TJsonWriter<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>> FScanJsonWriter;
+	typedef TJsonReader<UTF8CHAR> FScanJsonReader;
+}
+
+UNKScanStoreComponent::UNKScanStoreComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UNKScanStoreComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	NKSCANNER_UPDATE_MEMORY_STAT(STAT_NKScanner_StoreMemory, ReportedStatBytes, 0);
+	
+	Super::EndPlay(EndPlayReason);
+}
+
+// ===== Mapping Control =====
+
+void UNKScanStoreComponent::StartMapping(float StartAngle, float OrbitRadius, float ScanHeight)
+{
+	UNKOrbitMapperComponent* Mapper = GetMapper();
+	UNKLaserTracerComponent* Tracer = GetOwner() ? GetOwner()->FindComponentByClass<UNKLaserTracerComponent>() : nullptr;
+	
+	if (!Mapper || !Tracer || !TargetActor)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ScanStore: Cannot start mapping - needs a target and sibling OrbitMapper/LaserTracer components"));
+		return;
+	}
+	
+	FVector OrbitCenter = TargetActor->GetComponentsBoundingBox(true).GetCenter();
+	OrbitCenter.Z = ScanHeight;
+	
+	Tracer->SetTraceTarget(TargetActor);
+	Mapper->SetScanStore(this);
+	Mapper->StartMapping(TargetActor, OrbitCenter, OrbitRadius, ScanHeight, StartAngle, Tracer);
+}
+
+void UNKScanStoreComponent::StopMapping()
+{
+	if (UNKOrbitMapperComponent* Mapper = GetMapper())
+	{
+		Mapper->StopMapping();
+	}
+}
+
+void UNKScanStoreComponent::PauseMapping()
+{
+	if (UNKOrbitMapperComponent* Mapper = GetMapper())
+	{
+		Mapper->PauseMapping();
+	}
+}
+
+void UNKScanStoreComponent::ResumeMapping()
+{
+	if (UNKOrbitMapperComponent* Mapper = GetMapper())
+	{
+		Mapper->ResumeMapping();
+	}
+}
+
+bool UNKScanStoreComponent::IsMapping() const
+{
+	const UNKOrbitMapperComponent* Mapper = GetMapper();
+	return Mapper && Mapper->IsMapping();
+}
+
+bool UNKScanStoreComponent::IsPaused() const
+{
+	const UNKOrbitMapperComponent* Mapper = GetMapper();
+	return Mapper && Mapper->IsPaused();
+}
+
+float UNKScanStoreComponent::GetCurrentOrbitAngle() const
+{
+	const UNKOrbitMapperComponent* Mapper = GetMapper();
+	return Mapper ? Mapper->GetCurrentAngle() : 0.0f;
+}
+
+float UNKScanStoreComponent::GetMappingProgress() const
+{
+	const UNKOrbitMapperComponent* Mapper = GetMapper();
+	return Mapper ? Mapper->GetProgressPercent() : 0.0f;
+}
+
+float UNKScanStoreComponent::GetElapsedTime() const
+{
+	if (ScanStartTime < 0.0 || !GetWorld())
+	{
+		return 0.0f;
+	}
+	
+	const double EndTime = ScanEndTime >= 0.0 ? ScanEndTime : GetWorld()->GetTimeSeconds();
+	return static_cast<float>(EndTime - ScanStartTime);
+}
+
+// ===== Data Access =====
+
+const TArray<FScanDataPoint>& UNKScanStoreComponent::GetScanData() const
+{
+	if (!bScanDataCacheValid)
+	{
+		const int32 PointCount = GetPointCount();
+		ScanDataCache.Reset(PointCount);
+		for (int32 PointIndex = 0; PointIndex < PointCount; PointIndex++)
+		{
+			ScanDataCache.Add(GetPoint(PointIndex));
+		}
+		bScanDataCacheValid = true;
+	}
+	return ScanDataCache;
+}
+
+FScanDataPoint UNKScanStoreComponent::GetPoint(int32 PointIndex) const
+{
+	FScanDataPoint Point;
+	if (PointIndex < 0 || PointIndex >= GetPointCount())
+	{
+		return Point;
+	}
+	
+	Point.WorldPosition = FVector(GetPositions()[PointIndex]);
+	Point.Normal = FVector(GetNormals()[PointIndex]);
+	Point.OrbitAngle = GetAngles()[PointIndex];
+	Point.ScanHeight = GetScanHeights()[PointIndex];
+	Point.DistanceFromCamera = GetDistances()[PointIndex];
+	Point.TimeStamp = GetTimestamps()[PointIndex];
+	
+	const int32 SourceIndex = GetSourceIndices()[PointIndex];
+	if (Sources.IsValidIndex(SourceIndex))
+	{
+		const FNKScanSource& Source = Sources[SourceIndex];
+		Point.HitActor = Source.Actor.Get();
+		Point.ComponentName = Source.ComponentName;
+	}
+	return Point;
+}
+
+void UNKScanStoreComponent::ClearScanData()
+{
+	MappedFile.Reset();
+	Positions.Empty();
+	Normals.Empty();
+	Angles.Empty();
+	ScanHeights.Empty();
+	Distances.Empty();
+	Timestamps.Empty();
+	RingIndices.Empty();
+	LayerIndices.Empty();
+	SourceIndices.Empty();
+	Sources.Empty();
+	SourceLookup.Empty();
+	ScanDataCache.Empty();
+	bScanDataCacheValid = false;
+	PointRevision++;
+	ScanStartTime = -1.0;
+	ScanEndTime = -1.0;
+	UpdateMemoryStat();
+}
+
+int64 UNKScanStoreComponent::GetAllocatedBytes() const
+{
+	return Positions.GetAllocatedSize() + Normals.GetAllocatedSize()
+		+ Angles.GetAllocatedSize() + ScanHeights.GetAllocatedSize()
+		+ Distances.GetAllocatedSize() + Timestamps.GetAllocatedSize()
+		+ RingIndices.GetAllocatedSize() + LayerIndices.GetAllocatedSize()
+		+ SourceIndices.GetAllocatedSize() + Sources.GetAllocatedSize()
+		+ SourceLookup.GetAllocatedSize();
+}
+
+// ===== Data Persistence =====
+
+bool UNKScanStoreComponent::SaveToJSON(const FString& FilePath)
+{
+	TUniquePtr<FArchive> FileWriter(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!FileWriter)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ScanStore: Cannot open %s for writing"), *FilePath);
+		return false;
+	}
+	
+	// Written token by token straight into the file archive - only its write buffer is held in memory
+	TSharedRef<FScanJsonWriter> Writer = TJsonWriterFactory<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>::Create(FileWriter.Get());
+	const int32 PointCount = GetPointCount();
+	
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("format"), JsonFormatName);
+	Writer->WriteValue(TEXT("version"), JsonFormatVersion);
+	Writer->WriteValue(TEXT("pointCount"), PointCount);
+	Writer->WriteValue(TEXT("scanDuration"), static_cast<double>(GetElapsedTime()));
+	
+	Writer->WriteArrayStart(TEXT("sources"));
+	for (const FNKScanSource& Source : Sources)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("actor"), Source.ActorName.ToString());
+		Writer->WriteValue(TEXT("component"), Source.ComponentName.ToString());
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	
+	const TConstArrayView<FVector3f> PointPositions = GetPositions();
+	const TConstArrayView<FVector3f> PointNormals = GetNormals();
+	const TConstArrayView<float> PointAngles = GetAngles();
+	const TConstArrayView<float> PointScanHeights = GetScanHeights();
+	const TConstArrayView<float> PointDistances = GetDistances();
+	const TConstArrayView<float> PointTimestamps = GetTimestamps();
+	const TConstArrayView<int32> PointRingIndices = GetRingIndices();
+	const TConstArrayView<uint8> PointLayerIndices = GetLayerIndices();
+	const TConstArrayView<int32> PointSourceIndices = GetSourceIndices();
+	
+	// Floats go out as doubles - the float overload prints 6 significant digits and would not round-trip
+	Writer->WriteArrayStart(TEXT("points"));
+	for (int32 PointIndex = 0; PointIndex < PointCount; PointIndex++)
+	{
+		Writer->WriteArrayStart();
+		Writer->WriteValue(static_cast<double>(PointPositions[PointIndex].X));
+		Writer->WriteValue(static_cast<double>(PointPositions[PointIndex].Y));
+		Writer->WriteValue(static_cast<double>(PointPositions[PointIndex].Z));
+		Writer->WriteValue(static_cast<double>(PointNormals[PointIndex].X));
+		Writer->WriteValue(static_cast<double>(PointNormals[PointIndex].Y));
+		Writer->WriteValue(static_cast<double>(PointNormals[PointIndex].Z));
+		Writer->WriteValue(static_cast<double>(PointAngles[PointIndex]));
+		Writer->WriteValue(static_cast<double>(PointScanHeights[PointIndex]));
+		Writer->WriteValue(static_cast<double>(PointDistances[PointIndex]));
+		Writer->WriteValue(static_cast<double>(PointTimestamps[PointIndex]));
+		Writer->WriteValue(PointRingIndices[PointIndex]);
+		Writer->WriteValue(static_cast<int32>(PointLayerIndices[PointIndex]));
+		Writer->WriteValue(PointSourceIndices[PointIndex]);
+		Writer->WriteArrayEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	
+	const bool bClosed = Writer->Close();
+	const bool bSuccess = bClosed && FileWriter->Close() && !FileWriter->IsError();
+	if (!bSuccess)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ScanStore: JSON write failed for %s"), *FilePath);
+		return false;
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("ScanStore: Saved %d points to %s"), PointCount, *FilePath);
+	return true;
+}
+
+bool UNKScanStoreComponent::LoadFromJSON(const FString& FilePath)
+{
+	TUniquePtr<FArchive> FileReader(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!FileReader)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ScanStore: Cannot open %s"), *FilePath);
+		return false;
+	}
+	
+	ClearScanData();
+	ScanStartTime = 0.0;
+	ScanEndTime = 0.0;
+	
+	// Pull parser - one token at a time, points go straight into the arrays
+	TSharedRef<FScanJsonReader> Reader = TJsonReaderFactory<UTF8CHAR>::Create(FileReader.Get());
+	
+	enum class ESection : uint8 { Root, Sources, Source, Points, Point };
+	ESection Section = ESection::Root;
+	int32 SkipDepth = 0;  // Nesting depth inside a value we do not know
+	int32 FormatVersion = 0;
+	double PointFields[JsonPointFieldCount];
+	int32 FieldCount = 0;
+	FString ErrorMessage;
+	
+	EJsonNotation Notation = EJsonNotation::Null;
+	while (ErrorMessage.IsEmpty() && Reader->ReadNext(Notation))
+	{
+		if (SkipDepth > 0)
+		{
+			SkipDepth += (Notation == EJsonNotation::ObjectStart || Notation == EJsonNotation::ArrayStart) ? 1
+				: (Notation == EJsonNotation::ObjectEnd || Notation == EJsonNotation::ArrayEnd) ? -1 : 0;
+			continue;
+		}
+		
+		const FString& Identifier = Reader->GetIdentifier();
+		switch (Section)
+		{
+		case ESection::Root:
+			if (Notation == EJsonNotation::Number && Identifier == TEXT("version"))
+			{
+				FormatVersion = static_cast<int32>(Reader->GetValueAsNumber());
+			}
+			else if (Notation == EJsonNotation::Number && Identifier == TEXT("pointCount"))
+			{
+				// Reservation only - the rows themselves decide the count
+				const int32 ExpectedPoints = FMath::Clamp(static_cast<int32>(Reader->GetValueAsNumber()), 0, MAX_int32 / 2);
+				Positions.Reserve(ExpectedPoints);
+				Normals.Reserve(ExpectedPoints);
+				Angles.Reserve(ExpectedPoints);
+				ScanHeights.Reserve(ExpectedPoints);
+				Distances.Reserve(ExpectedPoints);
+				Timestamps.Reserve(ExpectedPoints);
+				RingIndices.Reserve(ExpectedPoints);
+				LayerIndices.Reserve(ExpectedPoints);
+				SourceIndices.Reserve(ExpectedPoints);
+			}
+			else if (Notation == EJsonNotation::Number && Identifier == TEXT("scanDuration"))
+			{
+				ScanEndTime = Reader->GetValueAsNumber();
+			}
+			else if (Notation == EJsonNotation::ArrayStart && Identifier == TEXT("sources"))
+			{
+				Section = ESection::Sources;
+			}
+			else if (Notation == EJsonNotation::ArrayStart && Identifier == TEXT("points"))
+			{
+				if (FormatVersion != JsonFormatVersion)
+				{
+					ErrorMessage = FString::Printf(TEXT("unsupported version %d"), FormatVersion);
+				}
+				Section = ESection::Points;
+			}
+			else if (Notation == EJsonNotation::ObjectStart || Notation == EJsonNotation::ArrayStart)
+			{
+				// Root object itself, or an unknown nested value
+				SkipDepth = Identifier.IsEmpty() ? 0 : 1;
+			}
+			break;
+			
+		case ESection::Sources:
+			if (Notation == EJsonNotation::ObjectStart)
+			{
+				Sources.AddDefaulted();
+				Section = ESection::Source;
+			}
+			else if (Notation == EJsonNotation::ArrayEnd)
+			{
+				Section = ESection::Root;
+			}
+			break;
+			
+		case ESection::Source:
+			if (Notation == EJsonNotation::String && Identifier == TEXT("actor"))
+			{
+				Sources.Last().ActorName = FName(*Reader->GetValueAsString());
+			}
+			else if (Notation == EJsonNotation::String && Identifier == TEXT("component"))
+			{
+				Sources.Last().ComponentName = FName(*Reader->GetValueAsString());
+			}
+			else if (Notation == EJsonNotation::ObjectEnd)
+			{
+				Section = ESection::Sources;
+			}
+			else if (Notation == EJsonNotation::ObjectStart || Notation == EJsonNotation::ArrayStart)
+			{
+				SkipDepth = 1;
+			}
+			break;
+			
+		case ESection::Points:
+			if (Notation == EJsonNotation::ArrayStart)
+			{
+				FieldCount = 0;
+				Section = ESection::Point;
+			}
+			else if (Notation == EJsonNotation::ArrayEnd)
+			{
+				Section = ESection::Root;
+			}
+			else
+			{
+				ErrorMessage = TEXT("point is not an array");
+			}
+			break;
+			
+		case ESection::Point:
+			if (Notation == EJsonNotation::Number && FieldCount < JsonPointFieldCount)
+			{
+				PointFields[FieldCount++] = Reader->GetValueAsNumber();
+			}
+			else if (Notation == EJsonNotation::ArrayEnd && FieldCount == JsonPointFieldCount)
+			{
+				Positions.Add(FVector3f(PointFields[0], PointFields[1], PointFields[2]));
+				Normals.Add(FVector3f(PointFields[3], PointFields[4], PointFields[5]));
+				Angles.Add(PointFields[6]);
+				ScanHeights.Add(PointFields[7]);
+				Distances.Add(PointFields[8]);
+				Timestamps.Add(PointFields[9]);
+				RingIndices.Add(static_cast<int32>(PointFields[10]));
+				LayerIndices.Add(static_cast<uint8>(FMath::Clamp(static_cast<int32>(PointFields[11]), 0, 255)));
+				SourceIndices.Add(static_cast<int32>(PointFields[12]));
+				Section = ESection::Points;
+			}
+			else
+			{
+				ErrorMessage = FString::Printf(TEXT("point %d is malformed"), Positions.Num());
+			}
+			break;
+		}
+	}
+	
+	if (ErrorMessage.IsEmpty() && Notation == EJsonNotation::Error)
+	{
+		ErrorMessage = Reader->GetErrorMessage();
+	}
+	if (ErrorMessage.IsEmpty() && FormatVersion != JsonFormatVersion)
+	{
+		ErrorMessage = FString::Printf(TEXT("unsupported version %d"), FormatVersion);
+	}
+	
+	if (!ErrorMessage.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("ScanStore: Cannot load %s - %s"), *FilePath, *ErrorMessage);
+		ClearScanData();
+		return false;
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("ScanStore: Loaded %d points, %d sources from %s"), Positions.Num(), Sources.Num(), *FilePath);
+	
+	UpdateMemoryStat();
+	OnScanComplete.Broadcast(Positions.Num());
+	return true;
+}
+
+bool UNKScanStoreComponent::SaveToBinary(const FString& FilePath)
+{
+	if (MappedFile && FPaths::IsSamePath(MappedFile->GetFilePath(), FilePath))
+	{
+		// Writing over the mapping we are reading from - the file already holds exactly this scan
+		return true;
+	}
+	
+	FNKScanFileData Data;
+	Data.Positions = GetPositions();
+	Data.Normals = GetNormals();
+	Data.Angles = GetAngles();
+	Data.ScanHeights = GetScanHeights();
+	Data.Distances = GetDistances();
+	Data.Timestamps = GetTimestamps();
+	Data.RingIndices = GetRingIndices();
+	Data.LayerIndices = GetLayerIndices();
+	Data.SourceIndices = GetSourceIndices();
+	Data.Sources = Sources;
+	Data.ScanDuration = GetElapsedTime();
+	
+	if (!NKScanFile::Write(FilePath, Data))
+	{
+		return false;
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("ScanStore: Saved %d points to %s"), GetPointCount(), *FilePath);
+	return true;
+}
+
+bool UNKScanStoreComponent::LoadFromBinary(const FString& FilePath)
+{
+	TUniquePtr<FNKMappedScanFile> File = FNKMappedScanFile::Open(FilePath);
+	if (!File)
+	{
+		return false;
+	}
+	
+	ClearScanData();
+	Sources = File->GetSources();
+	ScanStartTime = 0.0;
+	ScanEndTime = File->GetScanDuration();
+	MappedFile = MoveTemp(File);
+	
+	UE_LOG(LogTemp, Log, TEXT("ScanStore: Mapped %d points (%d ring chunks) from %s"),
+		MappedFile->GetPointCount(), MappedFile->GetChunks().Num(), *FilePath);
+	
+	OnScanComplete.Broadcast(MappedFile->GetPointCount());
+	return true;
+}
+
+// ===== Recording =====
+
+void UNKScanStoreComponent::BeginScan(int32 ExpectedPoints)
+{
+	ClearScanData();
+	
+	const int32 Capacity = FMath::Max(ExpectedPoints, 0);
+	Positions.Reserve(Capacity);
+	Normals.Reserve(Capacity);
+	Angles.Reserve(Capacity);
+	ScanHeights.Reserve(Capacity);
+	Distances.Reserve(Capacity);
+	Timestamps.Reserve(Capacity);
+	RingIndices.Reserve(Capacity);
+	LayerIndices.Reserve(Capacity);
+	SourceIndices.Reserve(Capacity);
+	UpdateMemoryStat();
+	
+	ScanStartTime = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0;
+}
+
+void UNKScanStoreComponent::AddPoint(const FNKScanHit& Hit)
+{
+	if (MappedFile)
+	{
+		DetachMappedFile();
+	}
+	
+	Positions.Add(FVector3f(Hit.Location));
+	Normals.Add(FVector3f(Hit.Normal));
+	Angles.Add(Hit.Angle);
+	ScanHeights.Add(Hit.ScanHeight);
+	Distances.Add(Hit.Distance);
+	Timestamps.Add(GetWorld() && ScanStartTime >= 0.0 ? static_cast<float>(GetWorld()->GetTimeSeconds() - ScanStartTime) : 0.0f);
+	RingIndices.Add(Hit.RingIndex);
+	LayerIndices.Add(static_cast<uint8>(FMath::Clamp(Hit.LayerIndex, 0, 255)));
+	SourceIndices.Add(InternSource(Hit.Component));
+	
+	bScanDataCacheValid = false;
+}
+
+void UNKScanStoreComponent::CompactPoints(TFunctionRef<bool(int32)> ShouldKeep)
+{
+	DetachMappedFile();
+	
+	const int32 PointCount = Positions.Num();
+	int32 WriteIndex = 0;
+	
+	for (int32 ReadIndex = 0; ReadIndex < PointCount; ReadIndex++)
+	{
+		if (!ShouldKeep(ReadIndex))
+		{
+			continue;
+		}
+		
+		if (WriteIndex != ReadIndex)
+		{
+			Positions[WriteIndex] = Positions[ReadIndex];
+			Normals[WriteIndex] = Normals[ReadIndex];
+			Angles[WriteIndex] = Angles[ReadIndex];
+			ScanHeights[WriteIndex] = ScanHeights[ReadIndex];
+			Distances[WriteIndex] = Distances[ReadIndex];
+			Timestamps[WriteIndex] = Timestamps[ReadIndex];
+			RingIndices[WriteIndex] = RingIndices[ReadIndex];
+			LayerIndices[WriteIndex] = LayerIndices[ReadIndex];
+			SourceIndices[WriteIndex] = SourceIndices[ReadIndex];
+		}
+		WriteIndex++;
+	}
+	
+	Positions.SetNum(WriteIndex, EAllowShrinking::No);
+	Normals.SetNum(WriteIndex, EAllowShrinking::No);
+	Angles.SetNum(WriteIndex, EAllowShrinking::No);
+	ScanHeights.SetNum(WriteIndex, EAllowShrinking::No);
+	Distances.SetNum(WriteIndex, EAllowShrinking::No);
+	Timestamps.SetNum(WriteIndex, EAllowShrinking::No);
+	RingIndices.SetNum(WriteIndex, EAllowShrinking::No);
+	LayerIndices.SetNum(WriteIndex, EAllowShrinking::No);
+	SourceIndices.SetNum(WriteIndex, EAllowShrinking::No);
+	
+	bScanDataCacheValid = false;
+	PointRevision++;
+}
+
+void UNKScanStoreComponent::SortPoints()
+{
+	DetachMappedFile();
+	
+	const int32 PointCount = Positions.Num();
+	
+	TArray<int32> Order;
+	Order.SetNumUninitialized(PointCount);
+	for (int32 i = 0; i < PointCount; i++)
+	{
+		Order[i] = i;
+	}
+	
+	Algo::StableSort(Order, [this](int32 A, int32 B)
+	{
+		if (RingIndices[A] != RingIndices[B])
+		{
+			return RingIndices[A] < RingIndices[B];
+		}
+		if (Angles[A] != Angles[B])
+		{
+			return Angles[A] < Angles[B];
+		}
+		return LayerIndices[A] < LayerIndices[B];
+	});
+	
+	// Permute every attribute array through the same order
+	auto Permute = [&Order](auto& Array)
+	{
+		auto Sorted = Array;
+		for (int32 i = 0; i < Order.Num(); i++)
+		{
+			Sorted[i] = Array[Order[i]];
+		}
+		Array = MoveTemp(Sorted);
+	};
+	Permute(Positions);
+	Permute(Normals);
+	Permute(Angles);
+	Permute(ScanHeights);
+	Permute(Distances);
+	Permute(Timestamps);
+	Permute(RingIndices);
+	Permute(LayerIndices);
+	Permute(SourceIndices);
+	
+	bScanDataCacheValid = false;
+	PointRevision++;
+}
+
+bool UNKScanStoreComponent::SetNormals(TConstArrayView<FVector> NewNormals)
+{
+	if (NewNormals.Num() != GetPointCount())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ScanStore: SetNormals got %d normals for %d points - ignored"), NewNormals.Num(), GetPointCount());
+		return false;
+	}
+	
+	DetachMappedFile();
+	
+	for (int32 PointIndex = 0; PointIndex < NewNormals.Num(); PointIndex++)
+	{
+		Normals[PointIndex] = FVector3f(NewNormals[PointIndex]);
+	}
+	
+	bScanDataCacheValid = false;
+	return true;
+}
+
+void UNKScanStoreComponent::NotifyProgress(float ProgressPercent)
+{
+	UpdateMemoryStat();
+	OnScanProgress.Broadcast(ProgressPercent, GetPointCount());
+}
+
+void UNKScanStoreComponent::NotifyScanComplete()
+{
+	ScanEndTime = GetWorld() ? GetWorld()->GetTimeSeconds() : ScanStartTime;
+	UpdateMemoryStat();
+	
+	UE_LOG(LogTemp, Log, TEXT("ScanStore: %d points, %d sources, %.2f MB"),
+		Positions.Num(), Sources.Num(), GetAllocatedBytes() / (1024.0 * 1024.0));
+	
+	OnScanComplete.Broadcast(Positions.Num());
+}
+
+// ===== Helpers =====
+
+UNKOrbitMapperComponent* UNKScanStoreComponent::GetMapper() const
+{
+	if (BoundMapper)
+	{
+		return BoundMapper;
+	}
+	return GetOwner() ? GetOwner()->FindComponentByClass<UNKOrbitMapperComponent>() : nullptr;
+}
+
+void UNKScanStoreComponent::DetachMappedFile()
+{
+	if (!MappedFile)
+	{
+		return;
+	}
+	
+	Positions = MappedFile->GetPositions();
+	Normals = MappedFile->GetNormals();
+	Angles = MappedFile->GetAngles();
+	ScanHeights = MappedFile->GetScanHeights();
+	Distances = MappedFile->GetDistances();
+	Timestamps = MappedFile->GetTimestamps();
+	RingIndices = MappedFile->GetRingIndices();
+	LayerIndices = MappedFile->GetLayerIndices();
+	SourceIndices = MappedFile->GetSourceIndices();
+	MappedFile.Reset();
+	UpdateMemoryStat();
+}
+
+void UNKScanStoreComponent::UpdateMemoryStat()
+{
+	NKSCANNER_UPDATE_MEMORY_STAT(STAT_NKScanner_StoreMemory, ReportedStatBytes, GetAllocatedBytes());
+}
+
+int32 UNKScanStoreComponent::InternSource(const UPrimitiveComponent* Component)
+{
+	if (!Component)
+	{
+		return INDEX_NONE;
+	}
+	
+	if (const int32* ExistingIndex = SourceLookup.Find(Component))
+	{
+		return *ExistingIndex;
+	}
+	
+	FNKScanSource& Source = Sources.AddDefaulted_GetRef();
+	Source.Actor = Component->GetOwner();
+	Source.ActorName = Component->GetOwner() ? Component->GetOwner()->GetFName() : NAME_None;
+	Source.ComponentName = Component->GetFName();
+	
+	const int32 SourceIndex = Sources.Num() - 1;
+	SourceLookup.Add(Component, SourceIndex);
+	return SourceIndex;
+}
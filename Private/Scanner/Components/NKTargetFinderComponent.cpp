@@ -3,6 +3,8 @@
 #include "Scanner/Components/NKTargetFinderComponent.h"
 #include "Scanner/Interfaces/INKLaserTracerInterface.h"
 #include "Scanner/Interfaces/INKCameraControllerInterface.h"
+#include "Scanner/Components/NKLaserTracerComponent.h"
+#include "Scanner/Utilities/NKScannerStats.h"
 
 UNKTargetFinderComponent::UNKTargetFinderComponent()
 	: bIsDiscovering(false)
@@ -11,10 +13,13 @@ UNKTargetFinderComponent::UNKTargetFinderComponent()
 	, bHasFoundTarget(false)
 	, FirstHitAngle(0.0f)
 	, TimeAccumulator(0.0f)
+	, FanOutOrigin(FVector::ZeroVector)
+	, FanOutRayCount(0)
 	, TargetActor(nullptr)
 	, ScanHeight(0.0f)
 	, LaserTracer(nullptr)
 	, CameraController(nullptr)
+	, BatchTracer(nullptr)
 {
 	PrimaryComponentTick.bCanEverTick = true;
 }
@@ -37,6 +42,10 @@ void UNKTargetFinderComponent::BeginPlay()
 			{
 				LaserTracer = Cast<INKLaserTracerInterface>(Component);
 			}
+			if (!BatchTracer)
+			{
+				BatchTracer = Cast<UNKLaserTracerComponent>(Component);
+			}
 			if (!CameraController)
 			{
 				CameraController = Cast<INKCameraControllerInterface>(Component);
@@ -49,7 +58,11 @@ void UNKTargetFinderComponent::TickComponent(float DeltaTime, ELevelTick TickTyp
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 	
-	if (bIsDiscovering)
+	if (bIsDiscovering && FanOutHandles.Num() > 0)
+	{
+		CollectFanOutTraces();
+	}
+	else if (bIsDiscovering)
 	{
 		// Accumulate time
 		TimeAccumulator += DeltaTime;
@@ -86,6 +99,7 @@ void UNKTargetFinderComponent::StartDiscovery(AActor* Target, float InScanHeight
 	CurrentAngle = 0.0f;
 	bHasFoundTarget = false;
 	TimeAccumulator = 0.0f;
+	FanOutHandles.Reset();
 	
 	// Position camera at configured height (don't move XY, just set Z if needed)
 	if (CameraController)
@@ -96,16 +110,271 @@ void UNKTargetFinderComponent::StartDiscovery(AActor* Target, float InScanHeight
 	}
 	
 	UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: Discovery started - Stationary rotation mode"));
+	
+	if (DiscoveryStrategy == EDiscoveryStrategy::Analytic)
+	{
+		if (PerformAnalyticAcquisition())
+		{
+			return;  // Found in this frame
+		}
+		
+		// Budget exhausted - continue with the regular sweep from 0°
+		UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: Analytic acquisition missed after %d traces - falling back to sweep"), ShotCount);
+		CurrentAngle = 0.0f;
+	}
+	else if (DiscoveryStrategy == EDiscoveryStrategy::FanOut)
+	{
+		if (StartFanOutDiscovery())
+		{
+			return;  // Resolved in this frame, or collected next frame (async)
+		}
+		
+		UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: Fan-out needs a UNKLaserTracerComponent - falling back to sweep"));
+	}
+}
+
+bool UNKTargetFinderComponent::StartFanOutDiscovery()
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_Discovery);
+	
+	if (!BatchTracer || !CameraController || !TargetActor)
+	{
+		return false;
+	}
+	
+	// Same angles the sweep would visit: 0, step, 2*step, ... < 360
+	const float StepDegrees = FMath::Max(AngularStepDegrees, 0.01f);
+	FanOutRayCount = FMath::CeilToInt(360.0f / StepDegrees);
+	FanOutOrigin = CameraController->GetCameraPosition();
+	
+	if (bFanOutAsyncTraces && BatchTracer->SupportsAsyncTraces())
+	{
+		FanOutHandles.SetNum(FanOutRayCount);
+		for (int32 RayIndex = 0; RayIndex < FanOutRayCount; RayIndex++)
+		{
+			FanOutHandles[RayIndex] = BatchTracer->SubmitAsyncTrace(FanOutOrigin, GetSweepDirection(RayIndex * StepDegrees));
+		}
+		
+		UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: Fan-out - %d async rays submitted"), FanOutRayCount);
+		return true;
+	}
+	
+	if (bFanOutAsyncTraces)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: Tracer scope has no async queries - fan-out traced as a concurrent batch"));
+	}
+	
+	TArray<FVector> Directions;
+	Directions.SetNumUninitialized(FanOutRayCount);
+	for (int32 RayIndex = 0; RayIndex < FanOutRayCount; RayIndex++)
+	{
+		Directions[RayIndex] = GetSweepDirection(RayIndex * StepDegrees);
+	}
+	
+	// One batch from the shared camera position - the winner is picked in sweep order, whichever worker finished first
+	FNKTraceBatchResults Results;
+	BatchTracer->PerformTraces(MakeArrayView(&FanOutOrigin, 1), Directions, Results);
+	
+	const int32 TargetIndex = Results.Actors.Find(TargetActor);
+	const int32 HitIndex = TargetIndex != INDEX_NONE ? Results.ActorIndices.Find(TargetIndex) : INDEX_NONE;
+	
+	FinishFanOutDiscovery(HitIndex, HitIndex != INDEX_NONE ? Results.ToHitResult(HitIndex) : FHitResult());
+	return true;
+}
+
+void UNKTargetFinderComponent::CollectFanOutTraces()
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_Discovery);
+	
+	const float StepDegrees = FMath::Max(AngularStepDegrees, 0.01f);
+	
+	// Walk the batch in sweep order - the first target hit wins once every earlier ray is known to miss it
+	for (int32 RayIndex = 0; RayIndex < FanOutHandles.Num(); RayIndex++)
+	{
+		FTraceHandle& Handle = FanOutHandles[RayIndex];
+		if (!Handle.IsValid())
+		{
+			continue;  // Already collected as a miss
+		}
+		
+		bool bHit = false;
+		FHitResult HitResult;
+		if (!BatchTracer->QueryAsyncTrace(Handle, bHit, HitResult))
+		{
+			// Results are dropped together (e.g. a frame was skipped) - resubmit every expired ray in one pass
+			for (int32 PendingIndex = RayIndex; PendingIndex < FanOutHandles.Num(); PendingIndex++)
+			{
+				FTraceHandle& PendingHandle = FanOutHandles[PendingIndex];
+				if (PendingHandle.IsValid() && BatchTracer->IsAsyncTraceExpired(PendingHandle))
+				{
+					PendingHandle = BatchTracer->SubmitAsyncTrace(FanOutOrigin, GetSweepDirection(PendingIndex * StepDegrees));
+				}
+			}
+			return;  // Keep sweep order - wait for next frame
+		}
+		
+		if (bHit && HitResult.GetActor() == TargetActor)
+		{
+			FanOutHandles.Reset();
+			FinishFanOutDiscovery(RayIndex, HitResult);
+			return;
+		}
+		
+		Handle.Invalidate();
+	}
+	
+	FanOutHandles.Reset();
+	FinishFanOutDiscovery(INDEX_NONE, FHitResult());
+}
+
+void UNKTargetFinderComponent::FinishFanOutDiscovery(int32 HitIndex, const FHitResult& HitResult)
+{
+	const float StepDegrees = FMath::Max(AngularStepDegrees, 0.01f);
+	
+	// Every ray of the batch was fired, whichever one won
+	ShotCount = FanOutRayCount;
+	CurrentAngle = HitIndex != INDEX_NONE ? HitIndex * StepDegrees : 360.0f;
+	
+	// One summarized progress event instead of one per shot
+	OnDiscoveryProgress.Broadcast(ShotCount, CurrentAngle);
+	
+	if (HitIndex == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UNKTargetFinderComponent: Discovery failed - none of %d fan-out rays hit the target"), FanOutRayCount);
+		OnDiscoveryFailed.Broadcast();
+		StopDiscovery();
+		return;
+	}
+	
+	UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: Fan-out - first target hit is ray %d of %d"), HitIndex + 1, FanOutRayCount);
+	
+	// Leave the camera facing the hit, as the sweep would have
+	RotateCameraToAngle(CurrentAngle);
+	
+	CompleteWithTargetHit(HitResult);
+}
+
+bool UNKTargetFinderComponent::PerformAnalyticAcquisition()
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_Discovery);
+	
+	if (!LaserTracer || !CameraController || !TargetActor)
+	{
+		return false;
+	}
+	
+	const FVector CameraPosition = CameraController->GetCameraPosition();
+	
+	float MinYaw = 0.0f;
+	float MaxYaw = 360.0f;
+	if (!CalculateTargetYawInterval(CameraPosition, MinYaw, MaxYaw))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: Camera inside target footprint - bisecting full circle"));
+	}
+	
+	UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: Analytic acquisition - target spans yaw %.1f° to %.1f°"), MinYaw, MaxYaw);
+	
+	// Breadth-first bisection: center first, then quarters, eighths, ...
+	// Level L samples the odd multiples of 1/2^(L+1), so no yaw is shot twice
+	int32 TracesFired = 0;
+	for (int32 Level = 0; TracesFired < MaxAcquisitionTraces; Level++)
+	{
+		const int32 Divisions = 1 << (Level + 1);
+		
+		for (int32 Odd = 1; Odd < Divisions && TracesFired < MaxAcquisitionTraces; Odd += 2)
+		{
+			const float Alpha = (float)Odd / Divisions;
+			CurrentAngle = FRotator::ClampAxis(FMath::Lerp(MinYaw, MaxYaw, Alpha));
+			
+			ShotCount++;
+			TracesFired++;
+			
+			RotateCameraToAngle(CurrentAngle);
+			
+			FHitResult HitResult;
+			bool bHit = LaserTracer->PerformTrace(HitResult);
+			
+			OnDiscoveryProgress.Broadcast(ShotCount, CurrentAngle);
+			
+			if (bHit && HitResult.GetActor() == TargetActor)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: Analytic acquisition hit after %d traces"), TracesFired);
+				CompleteWithTargetHit(HitResult);
+				return true;
+			}
+		}
+		
+		if (Level >= 16)
+		{
+			break;  // Sub-0.01° spacing - nothing left to bisect
+		}
+	}
+	
+	return false;
+}
+
+bool UNKTargetFinderComponent::CalculateTargetYawInterval(const FVector& FromPosition, float& OutMinYaw, float& OutMaxYaw) const
+{
+	const FBox TargetBounds = TargetActor->GetComponentsBoundingBox(true);
+	const FVector TargetCenter = TargetBounds.GetCenter();
+	
+	// Inside the XY footprint the target surrounds the camera
+	if (FromPosition.X >= TargetBounds.Min.X && FromPosition.X <= TargetBounds.Max.X &&
+		FromPosition.Y >= TargetBounds.Min.Y && FromPosition.Y <= TargetBounds.Max.Y)
+	{
+		OutMinYaw = 0.0f;
+		OutMaxYaw = 360.0f;
+		return false;
+	}
+	
+	// Measure every corner relative to the yaw of the center so the interval never wraps
+	const float CenterYaw = FMath::RadiansToDegrees(FMath::Atan2(TargetCenter.Y - FromPosition.Y, TargetCenter.X - FromPosition.X));
+	float MinDelta = 0.0f;
+	float MaxDelta = 0.0f;
+	
+	for (int32 Corner = 0; Corner < 4; Corner++)
+	{
+		const float CornerX = (Corner & 1) ? TargetBounds.Max.X : TargetBounds.Min.X;
+		const float CornerY = (Corner & 2) ? TargetBounds.Max.Y : TargetBounds.Min.Y;
+		const float CornerYaw = FMath::RadiansToDegrees(FMath::Atan2(CornerY - FromPosition.Y, CornerX - FromPosition.X));
+		const float Delta = FMath::FindDeltaAngleDegrees(CenterYaw, CornerYaw);
+		
+		MinDelta = FMath::Min(MinDelta, Delta);
+		MaxDelta = FMath::Max(MaxDelta, Delta);
+	}
+	
+	OutMinYaw = CenterYaw + MinDelta;
+	OutMaxYaw = CenterYaw + MaxDelta;
+	return true;
+}
+
+void UNKTargetFinderComponent::CompleteWithTargetHit(const FHitResult& HitResult)
+{
+	bHasFoundTarget = true;
+	FirstHit = HitResult;
+	FirstHitAngle = CurrentAngle;
+	
+	UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: ✅ TARGET FOUND at angle %.1f°"), CurrentAngle);
+	UE_LOG(LogTemp, Warning, TEXT("  Distance: %.2fm"), HitResult.Distance / 100.0f);
+	UE_LOG(LogTemp, Warning, TEXT("  Broadcasting OnTargetFound event..."));
+	
+	OnTargetFound.Broadcast(HitResult);
+	
+	UE_LOG(LogTemp, Warning, TEXT("  Event broadcast complete, stopping discovery"));
+	StopDiscovery();
 }
 
 void UNKTargetFinderComponent::StopDiscovery()
 {
 	bIsDiscovering = false;
+	FanOutHandles.Reset();
 	UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: Discovery stopped"));
 }
 
 void UNKTargetFinderComponent::PerformDiscoveryShot()
 {
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_Discovery);
+	
 	if (!LaserTracer || !CameraController)
 	{
 		UE_LOG(LogTemp, Error, TEXT("UNKTargetFinderComponent: Missing required components"));
@@ -155,20 +424,10 @@ void UNKTargetFinderComponent::PerformDiscoveryShot()
 		else
 		{
 			// Found target!
-			bHasFoundTarget = true;
-			FirstHit = HitResult;
-			FirstHitAngle = CurrentAngle;
-			
-			UE_LOG(LogTemp, Warning, TEXT("UNKTargetFinderComponent: ✅ TARGET FOUND at angle %.1f°"), CurrentAngle);
 			UE_LOG(LogTemp, Warning, TEXT("  Hit Actor: '%s' (%s)"), *HitActorLabel, *HitActorName);
 			UE_LOG(LogTemp, Warning, TEXT("  Component: %s (%s)"), *ComponentName, *ComponentClass);
-			UE_LOG(LogTemp, Warning, TEXT("  Distance: %.2fm"), HitResult.Distance / 100.0f);
-			UE_LOG(LogTemp, Warning, TEXT("  Broadcasting OnTargetFound event..."));
-			
-			OnTargetFound.Broadcast(HitResult);
 			
-			UE_LOG(LogTemp, Warning, TEXT("  Event broadcast complete, stopping discovery"));
-			StopDiscovery();
+			CompleteWithTargetHit(HitResult);
 			return;
 		}
 	}
@@ -6,6 +6,9 @@
 #include "Scanner/Components/NKCameraControllerComponent.h"
 #include "Scanner/Components/NKOrbitMapperComponent.h"
 #include "Scanner/Components/NKRecordingCameraComponent.h"
+#include "Scanner/Components/NKScanStoreComponent.h"
+#include "Scanner/Components/NKScanJobQueueComponent.h"
+#include "Scanner/Components/NKDebugVisualizerComponent.h"
 #include "Scanner/NKOverheadCamera.h"
 #include "GameFramework/PlayerController.h"
 #include "Kismet/GameplayStatics.h"
@@ -26,6 +29,9 @@ ANKMappingCamera::ANKMappingCamera(const FObjectInitializer& ObjectInitializer)
 	CameraControllerComponent = CreateDefaultSubobject<UNKCameraControllerComponent>(TEXT("CameraControllerComponent"));
 	OrbitMapperComponent = CreateDefaultSubobject<UNKOrbitMapperComponent>(TEXT("OrbitMapperComponent"));
 	RecordingCameraComponent = CreateDefaultSubobject<UNKRecordingCameraComponent>(TEXT("RecordingCameraComponent"));
+	ScanStoreComponent = CreateDefaultSubobject<UNKScanStoreComponent>(TEXT("ScanStoreComponent"));
+	ScanJobQueueComponent = CreateDefaultSubobject<UNKScanJobQueueComponent>(TEXT("ScanJobQueueComponent"));
+	DebugVisualizerComponent = CreateDefaultSubobject<UNKDebugVisualizerComponent>(TEXT("DebugVisualizerComponent"));
 }
 
 void ANKMappingCamera::PostInitializeComponents()
@@ -64,6 +70,14 @@ void ANKMappingCamera::BeginPlay()
 	{
 		OrbitMapperComponent->OnMappingComplete.AddDynamic(this, &ANKMappingCamera::OnMappingComplete);
 		OrbitMapperComponent->OnMappingFailed.AddDynamic(this, &ANKMappingCamera::OnMappingFailed);
+		OrbitMapperComponent->SetScanStore(ScanStoreComponent);
+		OrbitMapperComponent->SetDebugVisualizer(DebugVisualizerComponent);
+	}
+	
+	// Persistent scan visuals go through the batched visualizer
+	if (LaserTracerComponent)
+	{
+		LaserTracerComponent->SetDebugVisualizer(DebugVisualizerComponent);
 	}
 	
 	// Spawn overhead camera if enabled
@@ -280,6 +294,19 @@ void ANKMappingCamera::StartDiscovery()
 		
 		LaserTracerComponent->MaxRange = RequiredRange;
 		
+		// Trace scope - target-only skips the scene and ignores occluders, landscapes can skip it through their height grid
+		if (bIsLandscape && bLandscapeHeightfieldTraces)
+		{
+			LaserTracerComponent->TraceScope = ETraceScope::LandscapeHeightfield;
+		}
+		else
+		{
+			LaserTracerComponent->TraceScope = bTraceTargetOnly ? ETraceScope::TargetOnly : ETraceScope::World;
+		}
+		LaserTracerComponent->bUseTraceCache = bUseTraceCache;
+		LaserTracerComponent->SetTraceTarget(TargetActor);
+		LaserTracerComponent->SetShowLaser(bDrawDebugVisuals);
+		
 		UE_LOG(LogTemp, Warning, 
 			TEXT("🔬 TEST MODE: Laser range set to %.2fkm (INFINITE for testing)"),
 			RequiredRange/100000.0f);
@@ -400,6 +427,9 @@ void ANKMappingCamera::StartDiscovery()
 			*UEnum::GetValueAsString(TEXT("Engine.ECollisionChannel"), LaserTracerComponent->TraceChannel));
 		UE_LOG(LogTemp, Warning, TEXT("  Complex Collision: %s"), 
 			LaserTracerComponent->bUseComplexCollision ? TEXT("YES") : TEXT("NO"));
+		UE_LOG(LogTemp, Warning, TEXT("  Trace Scope: %s"), 
+			LaserTracerComponent->TraceScope == ETraceScope::TargetOnly ? TEXT("TARGET ONLY") :
+			LaserTracerComponent->TraceScope == ETraceScope::LandscapeHeightfield ? TEXT("LANDSCAPE HEIGHTFIELD") : TEXT("WORLD"));
 		UE_LOG(LogTemp, Warning, TEXT("  Fallback Enabled: %s"), 
 			LaserTracerComponent->bUseFallbackChannel ? TEXT("YES") : TEXT("NO"));
 		if (LaserTracerComponent->bUseFallbackChannel)
@@ -412,9 +442,12 @@ void ANKMappingCamera::StartDiscovery()
 	UE_LOG(LogTemp, Warning, TEXT("========================================"));
 	
 	// Start discovery - camera stays in place and rotates 360°
-	TargetFinderComponent->StartDiscovery(TargetActor, ScanHeight);
-	
+	// Enter Discovering first: analytic and fan-out acquisition can find the target within StartDiscovery
 	TransitionToState(EMappingScannerState::Discovering);
+	
+	TargetFinderComponent->DiscoveryStrategy = DiscoveryStrategy;
+	TargetFinderComponent->bFanOutAsyncTraces = bFanOutAsyncTraces;
+	TargetFinderComponent->StartDiscovery(TargetActor, ScanHeight);
 }
 
 void ANKMappingCamera::Stop()
@@ -483,6 +516,12 @@ void ANKMappingCamera::StartMapping()
 		LaserTracerComponent->TraceChannel = DiscoveryConfig.WorkingTraceChannel;
 		LaserTracerComponent->bUseComplexCollision = DiscoveryConfig.bUseComplexCollision;
 		LaserTracerComponent->MaxRange = DiscoveryConfig.MaxTraceRange;
+		LaserTracerComponent->TraceScope = DiscoveryConfig.TraceScope;
+		LaserTracerComponent->bUseTraceCache = bUseTraceCache;
+		LaserTracerComponent->SetTraceTarget(DiscoveryConfig.TargetActor);
+		LaserTracerComponent->bCaptureHitLayers = bCaptureHitLayers;
+		LaserTracerComponent->MaxHitLayers = MaxHitLayers;
+		LaserTracerComponent->SetShowLaser(bDrawDebugVisuals);
 		UE_LOG(LogTemp, Warning, TEXT("Laser tracer configured with proven settings"));
 	}
 	
@@ -499,10 +538,54 @@ void ANKMappingCamera::StartMapping()
 	UE_LOG(LogTemp, Warning, TEXT("  Orbit Radius: %.2f m"), OrbitRadius/100.0f);
 	UE_LOG(LogTemp, Warning, TEXT("  Start Angle: %.1f°"), DiscoveryConfig.FirstHitAngle);
 	UE_LOG(LogTemp, Warning, TEXT("  Angular Step: %.1f°"), OrbitMapperComponent->AngularStepDegrees);
+	UE_LOG(LogTemp, Warning, TEXT("  Burst Mapping: %s"), bBurstMapping ? TEXT("YES") : TEXT("NO"));
+	UE_LOG(LogTemp, Warning, TEXT("  Async Traces: %s"), bAsyncMappingTraces ? TEXT("YES") : TEXT("NO"));
+	UE_LOG(LogTemp, Warning, TEXT("  Virtual Pose: %s"), bVirtualPoseMapping ? TEXT("YES") : TEXT("NO"));
+	UE_LOG(LogTemp, Warning, TEXT("  Hit Layers: %s"), bCaptureHitLayers ? TEXT("YES") : TEXT("NO"));
 	
 	// Configure and start orbit mapper
 	// Use component defaults: AngularStepDegrees = 0.5f, ShotDelay = 0.1f
-	OrbitMapperComponent->bDrawDebugVisuals = true;
+	OrbitMapperComponent->bDrawDebugVisuals = bDrawDebugVisuals;
+	OrbitMapperComponent->MappingMode = MappingMode;
+	OrbitMapperComponent->SpiralPitch = SpiralPitchMeters * 100.0f;
+	OrbitMapperComponent->bBurstMode = bBurstMapping;
+	OrbitMapperComponent->BurstBudgetMs = MappingBurstBudgetMs;
+	OrbitMapperComponent->bUseAsyncTraces = bAsyncMappingTraces;
+	OrbitMapperComponent->bVirtualPoseScanning = bVirtualPoseMapping;
+	OrbitMapperComponent->VisualFeedbackInterval = MappingVisualFeedbackInterval;
+	
+	if (ScanStoreComponent)
+	{
+		ScanStoreComponent->TargetActor = DiscoveryConfig.TargetActor;
+	}
+	
+	// Transition to mapping state first - ring scans complete synchronously
+	TransitionToState(EMappingScannerState::Mapping);
+	
+	// A spiral already covers the full height in one pass; adaptive mode refines each ring (see StartRingScan)
+	if (bStackedRingMapping && MappingMode != EMappingMode::Spiral)
+	{
+		// Stacked rings evenly spread between the target's bottom and top (ring centers, not the bounds themselves)
+		const FBox& Bounds = DiscoveryConfig.TargetBounds;
+		TArray<float> RingHeights;
+		for (int32 RingIndex = 0; RingIndex < StackedRingCount; RingIndex++)
+		{
+			const float Alpha = (RingIndex + 0.5f) / StackedRingCount;
+			RingHeights.Add(FMath::Lerp(Bounds.Min.Z, Bounds.Max.Z, Alpha));
+		}
+		
+		UE_LOG(LogTemp, Warning, TEXT("  Stacked Rings: %d"), StackedRingCount);
+		
+		OrbitMapperComponent->StartRingScan(
+			DiscoveryConfig.TargetActor,
+			OrbitCenter,
+			OrbitRadius,
+			RingHeights,
+			DiscoveryConfig.FirstHitAngle,
+			LaserTracerComponent
+		);
+		return;
+	}
 	
 	OrbitMapperComponent->StartMapping(
 		DiscoveryConfig.TargetActor,
@@ -513,14 +596,50 @@ void ANKMappingCamera::StartMapping()
 		LaserTracerComponent
 	);
 	
-	// Transition to mapping state
-	TransitionToState(EMappingScannerState::Mapping);
-	
 	UE_LOG(LogTemp, Warning, TEXT("========================================"));
 	UE_LOG(LogTemp, Warning, TEXT("Async Orbit Mapping Started!"));
 	UE_LOG(LogTemp, Warning, TEXT("========================================"));
 }
 
+TArray<int32> ANKMappingCamera::EnqueueScanJobs(const TArray<AActor*>& Targets)
+{
+	if (!ScanJobQueueComponent)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ANKMappingCamera::EnqueueScanJobs - Missing ScanJobQueueComponent!"));
+		return TArray<int32>();
+	}
+	
+	// Jobs orbit like Relative mode and trace like the single-target scan
+	ScanJobQueueComponent->OrbitClearance = DistanceMeters * 100.0f;
+	ScanJobQueueComponent->HeightPercent = HeightPercent;
+	ScanJobQueueComponent->MappingMode = MappingMode;
+	ScanJobQueueComponent->SpiralPitch = SpiralPitchMeters * 100.0f;
+	ScanJobQueueComponent->bTraceTargetOnly = bTraceTargetOnly;
+	ScanJobQueueComponent->bLandscapeHeightfieldTraces = bLandscapeHeightfieldTraces;
+	ScanJobQueueComponent->bCaptureHitLayers = bCaptureHitLayers;
+	ScanJobQueueComponent->MaxHitLayers = MaxHitLayers;
+	
+	return ScanJobQueueComponent->EnqueueScanJobs(Targets);
+}
+
+int32 ANKMappingCamera::RescanChangedSectors()
+{
+	if (CurrentState != EMappingScannerState::Complete)
+	{
+		UE_LOG(LogTemp, Warning, 
+			TEXT("ANKMappingCamera::RescanChangedSectors - Mapping not complete (current: %d)"), (int32)CurrentState);
+		return 0;
+	}
+	
+	if (!OrbitMapperComponent)
+	{
+		UE_LOG(LogTemp, Error, TEXT("ANKMappingCamera::RescanChangedSectors - Missing OrbitMapperComponent!"));
+		return 0;
+	}
+	
+	return OrbitMapperComponent->RescanChangedSectors();
+}
+
 int32 ANKMappingCamera::GetDiscoveryShotCount() const
 {
 	return TargetFinderComponent ? TargetFinderComponent->GetShotCount() : 0;
@@ -588,6 +707,7 @@ void ANKMappingCamera::OnTargetFound(FHitResult HitResult)
 	{
 		DiscoveryConfig.WorkingTraceChannel = LaserTracerComponent->TraceChannel;
 		DiscoveryConfig.bUseComplexCollision = LaserTracerComponent->bUseComplexCollision;
+		DiscoveryConfig.TraceScope = LaserTracerComponent->TraceScope;
 		DiscoveryConfig.MaxTraceRange = LaserTracerComponent->MaxRange;
 	}
 	
@@ -658,8 +778,8 @@ void ANKMappingCamera::StartRecordingPlayback()
 		return;
 	}
 	
-	// Get hit points from orbit mapper using the getter method
-	const TArray<FVector>& HitPoints = OrbitMapperComponent->GetMappingHitPoints();
+	// Get hit points from orbit mapper - one ring forms the playback path (middle ring for stacked scans)
+	const TArray<FVector> HitPoints = OrbitMapperComponent->GetRingPathPoints(OrbitMapperComponent->GetRingCount() / 2);
 	
 	if (HitPoints.Num() < 2)
 	{
@@ -0,0 +1,557 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/NKScannerBenchmark.h"
+#include "Scanner/NKMappingCamera.h"
+#include "Scanner/Components/NKOrbitMapperComponent.h"
+#include "Scanner/Components/NKScanStoreComponent.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/CollisionProfile.h"
+#include "Components/StaticMeshComponent.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "Misc/EngineVersion.h"
+#include "HAL/PlatformProperties.h"
+#include "HAL/FileManager.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+
+namespace
+{
+	const TCHAR* const ReportFormatName = TEXT("nkscanner-benchmark");
+	constexpr int32 ReportFormatVersion = 1;
+	
+	typedef TJsonWriter<UTF8CHAR, TPrettyJsonPrintPolicy<UTF8CHAR>> FReportJsonWriter;
+	
+	/** Mesh name for spawned mesh targets (their actor names say nothing), actor name otherwise */
+	FString DescribeTarget(const AActor* Target)
+	{
+		if (const AStaticMeshActor* MeshActor = Cast<AStaticMeshActor>(Target))
+		{
+			const UStaticMesh* Mesh = MeshActor->GetStaticMeshComponent() ? MeshActor->GetStaticMeshComponent()->GetStaticMesh() : nullptr;
+			if (Mesh)
+			{
+				return FString::Printf(TEXT("%s (%s)"), *Target->GetName(), *Mesh->GetName());
+			}
+		}
+		return GetNameSafe(Target);
+	}
+	
+	const TCHAR* MappingModeName(EMappingMode Mode)
+	{
+		switch (Mode)
+		{
+		case EMappingMode::Adaptive: return TEXT("Adaptive");
+		case EMappingMode::Spiral: return TEXT("Spiral");
+		default: return TEXT("Orbit");
+		}
+	}
+	
+	const TCHAR* DiscoveryStrategyName(EDiscoveryStrategy Strategy)
+	{
+		switch (Strategy)
+		{
+		case EDiscoveryStrategy::Analytic: return TEXT("Analytic");
+		case EDiscoveryStrategy::FanOut: return TEXT("FanOut");
+		default: return TEXT("Sweep");
+		}
+	}
+}
+
+ANKScannerBenchmark::ANKScannerBenchmark()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	
+	CubeMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Engine/BasicShapes/Cube.Cube")));
+	DenseMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Engine/EngineMeshes/Sphere.Sphere")));
+	Cases = MakeDefaultCases();
+}
+
+void ANKScannerBenchmark::BeginPlay()
+{
+	Super::BeginPlay();
+	
+	if (bRunOnBeginPlay)
+	{
+		StartBenchmark();
+	}
+}
+
+void ANKScannerBenchmark::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// World teardown destroys the scanner and targets itself
+	if (EndPlayReason == EEndPlayReason::Destroyed && IsValid(RunCamera))
+	{
+		RunCamera->Stop();
+		RunCamera->Destroy();
+	}
+	RunCamera = nullptr;
+	Phase = ENKBenchmarkPhase::Idle;
+	
+	Super::EndPlay(EndPlayReason);
+}
+
+TArray<FNKScannerBenchmarkCase> ANKScannerBenchmark::MakeDefaultCases()
+{
+	TArray<FNKScannerBenchmarkCase> DefaultCases;
+	
+	auto AddCase = [&DefaultCases](const TCHAR* Name, EMappingMode Mode, float StepDegrees) -> FNKScannerBenchmarkCase&
+	{
+		FNKScannerBenchmarkCase& Case = DefaultCases.AddDefaulted_GetRef();
+		Case.Name = Name;
+		Case.MappingMode = Mode;
+		Case.AngularStepDegrees = StepDegrees;
+		return Case;
+	};
+	
+	// Step sizes
+	AddCase(TEXT("Orbit 2.0"), EMappingMode::Orbit, 2.0f);
+	AddCase(TEXT("Orbit 1.0"), EMappingMode::Orbit, 1.0f);
+	AddCase(TEXT("Orbit 0.25"), EMappingMode::Orbit, 0.25f);
+	
+	// Modes
+	AddCase(TEXT("Adaptive 1.0"), EMappingMode::Adaptive, 1.0f);
+	AddCase(TEXT("Spiral 1.0"), EMappingMode::Spiral, 1.0f);
+	AddCase(TEXT("Stacked x8 1.0"), EMappingMode::Orbit, 1.0f).StackedRingCount = 8;
+	
+	// Trace paths
+	AddCase(TEXT("Orbit 1.0 async"), EMappingMode::Orbit, 1.0f).bAsyncTraces = true;
+	AddCase(TEXT("Orbit 1.0 moving camera"), EMappingMode::Orbit, 1.0f).bVirtualPose = false;
+	AddCase(TEXT("Orbit 1.0 heightfield landscape"), EMappingMode::Orbit, 1.0f).bLandscapeHeightfield = true;  // Only differs on landscape targets
+	
+	return DefaultCases;
+}
+
+// ===== Public API =====
+
+void ANKScannerBenchmark::StartBenchmark()
+{
+	if (IsRunning())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("NKScannerBenchmark: Already running"));
+		return;
+	}
+	
+	if (Cases.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScannerBenchmark: No cases configured"));
+		return;
+	}
+	
+	SpawnTargets();
+	if (Targets.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScannerBenchmark: No targets - nothing to benchmark"));
+		return;
+	}
+	
+	Results.Reset();
+	RunIndex = 0;
+	
+	UE_LOG(LogTemp, Warning, TEXT("========================================"));
+	UE_LOG(LogTemp, Warning, TEXT("NKScannerBenchmark: %d targets x %d cases"), Targets.Num(), Cases.Num());
+	UE_LOG(LogTemp, Warning, TEXT("========================================"));
+	
+	StartNextRun();
+}
+
+void ANKScannerBenchmark::StopBenchmark()
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+	
+	// Record the interrupted run as the last one
+	RunIndex = Targets.Num() * Cases.Num() - 1;
+	FinishRun(TEXT("Benchmark stopped"));
+}
+
+// ===== Run Loop =====
+
+void ANKScannerBenchmark::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	
+	if (!IsRunning())
+	{
+		return;
+	}
+	
+	const int64 UsedPhysical = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical);
+	CurrentResult.PeakUsedPhysicalBytes = FMath::Max(CurrentResult.PeakUsedPhysicalBytes, UsedPhysical);
+	
+	if (!IsValid(RunCamera))
+	{
+		FinishRun(TEXT("Scanner destroyed"));
+		return;
+	}
+	
+	if (Phase == ENKBenchmarkPhase::Discovering)
+	{
+		const EMappingScannerState State = RunCamera->GetScannerState();
+		if (State == EMappingScannerState::Discovered)
+		{
+			CurrentResult.DiscoverySeconds = FPlatformTime::Seconds() - PhaseStartTime;
+			CurrentResult.DiscoveryShots = RunCamera->GetDiscoveryShotCount();
+			
+			Phase = ENKBenchmarkPhase::Mapping;
+			PhaseStartTime = FPlatformTime::Seconds();
+			RunCamera->StartMapping();
+		}
+		else if (State != EMappingScannerState::Discovering)
+		{
+			FinishRun(TEXT("Discovery failed"));
+			return;
+		}
+	}
+	
+	// Checked in the same tick - stacked ring scans complete inside StartMapping
+	if (Phase == ENKBenchmarkPhase::Mapping)
+	{
+		const EMappingScannerState State = RunCamera->GetScannerState();
+		if (State == EMappingScannerState::Complete)
+		{
+			FinishRun(FString());
+			return;
+		}
+		if (State != EMappingScannerState::Mapping)
+		{
+			FinishRun(TEXT("Mapping failed"));
+			return;
+		}
+	}
+	
+	if (FPlatformTime::Seconds() - RunStartTime > RunTimeoutSeconds)
+	{
+		FinishRun(FString::Printf(TEXT("Timed out after %.0f s"), RunTimeoutSeconds));
+	}
+}
+
+void ANKScannerBenchmark::SpawnTargets()
+{
+	for (AActor* Target : SpawnedTargets)
+	{
+		if (IsValid(Target))
+		{
+			Target->Destroy();
+		}
+	}
+	SpawnedTargets.Reset();
+	Targets.Reset();
+	
+	// Spawned targets are lined up along X from the benchmark actor
+	const FVector Spacing(TargetSpacingMeters * 100.0f, 0.0f, 0.0f);
+	
+	if (bSpawnCubeTarget)
+	{
+		if (AActor* Target = SpawnMeshTarget(CubeMesh, GetActorLocation() + Spacing * SpawnedTargets.Num()))
+		{
+			SpawnedTargets.Add(Target);
+		}
+	}
+	
+	if (bSpawnDenseMeshTarget)
+	{
+		if (AActor* Target = SpawnMeshTarget(DenseMesh, GetActorLocation() + Spacing * SpawnedTargets.Num()))
+		{
+			SpawnedTargets.Add(Target);
+		}
+	}
+	
+	Targets.Append(SpawnedTargets);
+	
+	if (IsValid(LandscapeTarget))
+	{
+		Targets.Add(LandscapeTarget);
+	}
+	
+	for (AActor* Target : AdditionalTargets)
+	{
+		if (IsValid(Target))
+		{
+			Targets.AddUnique(Target);
+		}
+	}
+}
+
+AActor* ANKScannerBenchmark::SpawnMeshTarget(const TSoftObjectPtr<UStaticMesh>& Mesh, const FVector& Location)
+{
+	UStaticMesh* LoadedMesh = Mesh.LoadSynchronous();
+	if (!LoadedMesh)
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScannerBenchmark: Cannot load mesh %s - target skipped"), *Mesh.ToString());
+		return nullptr;
+	}
+	
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = this;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	
+	AStaticMeshActor* Target = GetWorld()->SpawnActor<AStaticMeshActor>(
+		AStaticMeshActor::StaticClass(),
+		Location,
+		FRotator::ZeroRotator,
+		SpawnParams
+	);
+	
+	if (!Target)
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScannerBenchmark: Failed to spawn target for %s"), *LoadedMesh->GetName());
+		return nullptr;
+	}
+	
+	// Static components reject mesh changes once registered - spawn as movable
+	UStaticMeshComponent* MeshComponent = Target->GetStaticMeshComponent();
+	MeshComponent->SetMobility(EComponentMobility::Movable);
+	MeshComponent->SetStaticMesh(LoadedMesh);
+	MeshComponent->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	Target->SetActorScale3D(FVector(TargetScale));
+	
+	return Target;
+}
+
+void ANKScannerBenchmark::StartNextRun()
+{
+	const int32 RunCount = Targets.Num() * Cases.Num();
+	while (RunIndex < RunCount)
+	{
+		AActor* Target = Targets[RunIndex / Cases.Num()];
+		const FNKScannerBenchmarkCase& Case = Cases[RunIndex % Cases.Num()];
+		
+		CurrentResult = FNKScannerBenchmarkResult();
+		CurrentResult.TargetName = DescribeTarget(Target);
+		CurrentResult.Case = Case;
+		
+		if (!IsValid(Target))
+		{
+			CurrentResult.FailureReason = TEXT("Target destroyed");
+			Results.Add(CurrentResult);
+			RunIndex++;
+			continue;
+		}
+		
+		// Relative mode moves the scanner onto its orbit - it only needs a horizontal offset to start from
+		const FBox Bounds = Target->GetComponentsBoundingBox(true);
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		
+		RunCamera = GetWorld()->SpawnActor<ANKMappingCamera>(
+			ANKMappingCamera::StaticClass(),
+			Bounds.GetCenter() - FVector(0.0f, 100.0f, 0.0f),
+			FRotator::ZeroRotator,
+			SpawnParams
+		);
+		
+		if (!RunCamera)
+		{
+			CurrentResult.FailureReason = TEXT("Failed to spawn scanner");
+			Results.Add(CurrentResult);
+			RunIndex++;
+			continue;
+		}
+		
+		RunCamera->TargetActor = Target;
+		RunCamera->CameraPositionMode = ECameraPositionMode::Relative;
+		RunCamera->DistanceMeters = DistanceMeters;
+		RunCamera->HeightPercent = HeightPercent;
+		RunCamera->DiscoveryStrategy = DiscoveryStrategy;
+		RunCamera->bTraceTargetOnly = Case.bTraceTargetOnly;
+		RunCamera->bLandscapeHeightfieldTraces = Case.bLandscapeHeightfield;
+		RunCamera->MappingMode = Case.MappingMode;
+		RunCamera->SpiralPitchMeters = SpiralPitchMeters;
+		RunCamera->bStackedRingMapping = Case.StackedRingCount > 0;
+		RunCamera->StackedRingCount = FMath::Max(Case.StackedRingCount, 1);
+		RunCamera->bBurstMapping = true;
+		RunCamera->MappingBurstBudgetMs = MappingBurstBudgetMs;
+		RunCamera->bAsyncMappingTraces = Case.bAsyncTraces;
+		RunCamera->bVirtualPoseMapping = Case.bVirtualPose;
+		RunCamera->MappingVisualFeedbackInterval = 0.0f;
+		RunCamera->bDrawDebugVisuals = false;
+		
+		// The camera leaves the mapper's step alone - set it directly
+		if (UNKOrbitMapperComponent* Mapper = RunCamera->FindComponentByClass<UNKOrbitMapperComponent>())
+		{
+			Mapper->AngularStepDegrees = Case.AngularStepDegrees;
+		}
+		
+		UE_LOG(LogTemp, Warning, TEXT("NKScannerBenchmark: Run %d/%d - %s / %s"),
+			RunIndex + 1, RunCount, *CurrentResult.TargetName, *Case.Name);
+		
+		Phase = ENKBenchmarkPhase::Discovering;
+		RunStartTime = FPlatformTime::Seconds();
+		PhaseStartTime = RunStartTime;
+		RunCamera->StartDiscovery();
+		return;
+	}
+	
+	FinishBenchmark();
+}
+
+void ANKScannerBenchmark::FinishRun(const FString& FailureReason)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (Phase == ENKBenchmarkPhase::Mapping)
+	{
+		CurrentResult.MappingSeconds = Now - PhaseStartTime;
+	}
+	else if (Phase == ENKBenchmarkPhase::Discovering)
+	{
+		CurrentResult.DiscoverySeconds = Now - PhaseStartTime;
+	}
+	
+	if (IsValid(RunCamera))
+	{
+		CurrentResult.DiscoveryShots = RunCamera->GetDiscoveryShotCount();
+		CurrentResult.MappingShots = RunCamera->GetMappingShotCount();
+		CurrentResult.MappingHits = RunCamera->GetMappingHitCount();
+		if (const UNKScanStoreComponent* Store = RunCamera->GetScanStore())
+		{
+			CurrentResult.StoreBytes = Store->GetAllocatedBytes();
+		}
+		
+		RunCamera->Stop();
+		RunCamera->Destroy();
+	}
+	RunCamera = nullptr;
+	
+	CurrentResult.bSucceeded = FailureReason.IsEmpty();
+	CurrentResult.FailureReason = FailureReason;
+	if (CurrentResult.MappingShots > 0)
+	{
+		CurrentResult.HitRate = double(CurrentResult.MappingHits) / CurrentResult.MappingShots;
+		CurrentResult.MsPerShot = CurrentResult.MappingSeconds * 1000.0 / CurrentResult.MappingShots;
+	}
+	if (CurrentResult.MappingSeconds > 0.0)
+	{
+		CurrentResult.ShotsPerSecond = CurrentResult.MappingShots / CurrentResult.MappingSeconds;
+	}
+	
+	if (CurrentResult.bSucceeded)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("NKScannerBenchmark:   %d shots in %.3f s - %.0f shots/s, %.4f ms/shot, %.1f%% hits"),
+			CurrentResult.MappingShots, CurrentResult.MappingSeconds, CurrentResult.ShotsPerSecond,
+			CurrentResult.MsPerShot, CurrentResult.HitRate * 100.0);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScannerBenchmark:   %s"), *FailureReason);
+	}
+	
+	Results.Add(CurrentResult);
+	RunIndex++;
+	Phase = ENKBenchmarkPhase::Idle;
+	
+	StartNextRun();
+}
+
+void ANKScannerBenchmark::FinishBenchmark()
+{
+	Phase = ENKBenchmarkPhase::Idle;
+	
+	for (AActor* Target : SpawnedTargets)
+	{
+		if (IsValid(Target))
+		{
+			Target->Destroy();
+		}
+	}
+	SpawnedTargets.Reset();
+	Targets.Reset();
+	
+	LastReportPath = WriteReport();
+	
+	int32 FailedRuns = 0;
+	for (const FNKScannerBenchmarkResult& Result : Results)
+	{
+		FailedRuns += Result.bSucceeded ? 0 : 1;
+	}
+	
+	UE_LOG(LogTemp, Warning, TEXT("========================================"));
+	UE_LOG(LogTemp, Warning, TEXT("SCANNER BENCHMARK COMPLETE"));
+	UE_LOG(LogTemp, Warning, TEXT("========================================"));
+	UE_LOG(LogTemp, Warning, TEXT("  Runs: %d (%d failed)"), Results.Num(), FailedRuns);
+	UE_LOG(LogTemp, Warning, TEXT("  Report: %s"), LastReportPath.IsEmpty() ? TEXT("NOT WRITTEN") : *LastReportPath);
+	UE_LOG(LogTemp, Warning, TEXT("========================================"));
+	
+	OnBenchmarkFinished.Broadcast(LastReportPath);
+	
+	if (bQuitWhenFinished)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, FailedRuns > 0 ? 1 : 0);
+	}
+}
+
+FString ANKScannerBenchmark::WriteReport() const
+{
+	const FString Directory = ReportDirectory.IsEmpty() ? FPaths::ProjectSavedDir() / TEXT("Benchmarks") : ReportDirectory;
+	IFileManager::Get().MakeDirectory(*Directory, true);
+	const FString FilePath = Directory / FString::Printf(TEXT("ScannerBenchmark_%s.json"), *FDateTime::Now().ToString());
+	
+	TUniquePtr<FArchive> FileWriter(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!FileWriter)
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScannerBenchmark: Cannot open %s for writing"), *FilePath);
+		return FString();
+	}
+	
+	TSharedRef<FReportJsonWriter> Writer = TJsonWriterFactory<UTF8CHAR, TPrettyJsonPrintPolicy<UTF8CHAR>>::Create(FileWriter.Get());
+	
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("format"), ReportFormatName);
+	Writer->WriteValue(TEXT("version"), ReportFormatVersion);
+	Writer->WriteValue(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	Writer->WriteValue(TEXT("engineVersion"), FEngineVersion::Current().ToString());
+	Writer->WriteValue(TEXT("buildConfiguration"), LexToString(FApp::GetBuildConfiguration()));
+	Writer->WriteValue(TEXT("platform"), FString(FPlatformProperties::IniPlatformName()));
+	Writer->WriteValue(TEXT("cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+	Writer->WriteValue(TEXT("logicalCores"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	Writer->WriteValue(TEXT("canRender"), FApp::CanEverRender());
+	Writer->WriteValue(TEXT("discoveryStrategy"), DiscoveryStrategyName(DiscoveryStrategy));
+	Writer->WriteValue(TEXT("mappingBurstBudgetMs"), MappingBurstBudgetMs);
+	Writer->WriteValue(TEXT("peakUsedPhysicalBytes"), static_cast<int64>(FPlatformMemory::GetStats().PeakUsedPhysical));
+	
+	Writer->WriteArrayStart(TEXT("runs"));
+	for (const FNKScannerBenchmarkResult& Result : Results)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("target"), Result.TargetName);
+		Writer->WriteValue(TEXT("case"), Result.Case.Name);
+		Writer->WriteValue(TEXT("mappingMode"), MappingModeName(Result.Case.MappingMode));
+		Writer->WriteValue(TEXT("angularStepDegrees"), Result.Case.AngularStepDegrees);
+		Writer->WriteValue(TEXT("stackedRings"), Result.Case.StackedRingCount);
+		Writer->WriteValue(TEXT("virtualPose"), Result.Case.bVirtualPose);
+		Writer->WriteValue(TEXT("asyncTraces"), Result.Case.bAsyncTraces);
+		Writer->WriteValue(TEXT("traceTargetOnly"), Result.Case.bTraceTargetOnly);
+		Writer->WriteValue(TEXT("landscapeHeightfield"), Result.Case.bLandscapeHeightfield);
+		Writer->WriteValue(TEXT("succeeded"), Result.bSucceeded);
+		if (!Result.bSucceeded)
+		{
+			Writer->WriteValue(TEXT("failureReason"), Result.FailureReason);
+		}
+		Writer->WriteValue(TEXT("discoveryShots"), Result.DiscoveryShots);
+		Writer->WriteValue(TEXT("discoveryMs"), Result.DiscoverySeconds * 1000.0);
+		Writer->WriteValue(TEXT("mappingShots"), Result.MappingShots);
+		Writer->WriteValue(TEXT("mappingHits"), Result.MappingHits);
+		Writer->WriteValue(TEXT("mappingMs"), Result.MappingSeconds * 1000.0);
+		Writer->WriteValue(TEXT("shotsPerSecond"), Result.ShotsPerSecond);
+		Writer->WriteValue(TEXT("msPerShot"), Result.MsPerShot);
+		Writer->WriteValue(TEXT("hitRate"), Result.HitRate);
+		Writer->WriteValue(TEXT("storeBytes"), Result.StoreBytes);
+		Writer->WriteValue(TEXT("peakUsedPhysicalBytes"), Result.PeakUsedPhysicalBytes);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	
+	const bool bClosed = Writer->Close();
+	if (!bClosed || !FileWriter->Close() || FileWriter->IsError())
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScannerBenchmark: Report write failed for %s"), *FilePath);
+		return FString();
+	}
+	
+	return FilePath;
+}
@@ -0,0 +1,330 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/Utilities/NKLandscapeHeightGrid.h"
+#include "Scanner/Utilities/NKScannerStats.h"
+#include "LandscapeProxy.h"
+#include "LandscapeHeightfieldCollisionComponent.h"
+#include "Engine/HitResult.h"
+
+namespace
+{
+	/** Slack on the cell time interval so hits on a cell edge are not lost between cells */
+	constexpr double CellTimeTolerance = 1.0e-9;
+	
+	constexpr double NeverTime = TNumericLimits<double>::Max();
+}
+
+bool FNKLandscapeHeightGrid::Build(ALandscapeProxy* InLandscape, int32 MaxSamples)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_HeightGridBuild);
+	
+	Reset();
+	if (!InLandscape)
+	{
+		return false;
+	}
+	
+	const FBox Bounds = InLandscape->GetComponentsBoundingBox(false);
+	if (!Bounds.IsValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FNKLandscapeHeightGrid: '%s' has no colliding components"), *InLandscape->GetName());
+		return false;
+	}
+	
+	const double StartTime = FPlatformTime::Seconds();
+	
+	// Start at the landscape's quad size (vertex lattice) and coarsen until the vertex count fits
+	const FVector LatticeOrigin = InLandscape->GetActorLocation();
+	const int64 SampleBudget = FMath::Max(MaxSamples, 4);
+	const double QuadSize = FMath::Max(FMath::Abs(InLandscape->GetActorScale3D().X), 1.0);
+	Spacing = QuadSize;
+	for (;;)
+	{
+		Origin.X = LatticeOrigin.X + (FMath::FloorToDouble((Bounds.Min.X - LatticeOrigin.X) / Spacing) * Spacing);
+		Origin.Y = LatticeOrigin.Y + (FMath::FloorToDouble((Bounds.Min.Y - LatticeOrigin.Y) / Spacing) * Spacing);
+		CellsX = FMath::Max(FMath::CeilToInt32((Bounds.Max.X - Origin.X) / Spacing), 1);
+		CellsY = FMath::Max(FMath::CeilToInt32((Bounds.Max.Y - Origin.Y) / Spacing), 1);
+		
+		if (int64(CellsX + 1) * int64(CellsY + 1) <= SampleBudget)
+		{
+			break;
+		}
+		Spacing *= 2.0;
+	}
+	
+	if (Spacing > QuadSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FNKLandscapeHeightGrid: '%s' sampled every %.0f cm instead of its %.0f cm quads - raise MaxLandscapeGridSamples for full resolution"),
+			*InLandscape->GetName(), Spacing, QuadSize);
+	}
+	
+	// 1. Vertex heights (GetHeightAtLocation is not documented as thread-safe, so this stays on the game thread)
+	const int32 VerticesX = CellsX + 1;
+	const int32 VerticesY = CellsY + 1;
+	Heights.SetNumUninitialized(VerticesX * VerticesY);
+	MinHeight = MAX_FLT;
+	MaxHeight = -MAX_FLT;
+	int32 SampledCount = 0;
+	
+	for (int32 Y = 0; Y < VerticesY; Y++)
+	{
+		for (int32 X = 0; X < VerticesX; X++)
+		{
+			const FVector SampleLocation(Origin.X + (X * Spacing), Origin.Y + (Y * Spacing), Bounds.Max.Z);
+			const TOptional<float> Height = InLandscape->GetHeightAtLocation(SampleLocation, EHeightfieldSource::Complex);
+			
+			float& Vertex = Heights[(Y * VerticesX) + X];
+			Vertex = Height.IsSet() ? Height.GetValue() : NoHeight;
+			if (Height.IsSet())
+			{
+				MinHeight = FMath::Min(MinHeight, Vertex);
+				MaxHeight = FMath::Max(MaxHeight, Vertex);
+				SampledCount++;
+			}
+		}
+	}
+	
+	if (SampledCount == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FNKLandscapeHeightGrid: No heights sampled from '%s'"), *InLandscape->GetName());
+		Reset();
+		return false;
+	}
+	
+	// 2. Highest corner per cell - lets the DDA skip every cell the ray passes above
+	CellMaxHeights.SetNumUninitialized(CellsX * CellsY);
+	for (int32 CellY = 0; CellY < CellsY; CellY++)
+	{
+		for (int32 CellX = 0; CellX < CellsX; CellX++)
+		{
+			const float H00 = GetHeight(CellX, CellY);
+			const float H10 = GetHeight(CellX + 1, CellY);
+			const float H01 = GetHeight(CellX, CellY + 1);
+			const float H11 = GetHeight(CellX + 1, CellY + 1);
+			
+			const bool bComplete = H00 != NoHeight && H10 != NoHeight && H01 != NoHeight && H11 != NoHeight;
+			CellMaxHeights[(CellY * CellsX) + CellX] = bComplete ? FMath::Max(FMath::Max(H00, H10), FMath::Max(H01, H11)) : NoHeight;
+		}
+	}
+	
+	// 3. Collision component per cell (hits report it like a scene trace would)
+	CellComponents.Init(MAX_uint16, CellsX * CellsY);
+	for (ULandscapeHeightfieldCollisionComponent* Component : InLandscape->CollisionComponents)
+	{
+		if (!Component || Components.Num() >= MAX_uint16)
+		{
+			continue;
+		}
+		
+		const uint16 ComponentIndex = static_cast<uint16>(Components.Add(Component));
+		const FBox ComponentBox = Component->Bounds.GetBox();
+		
+		// Cells whose center lies inside the component's bounds
+		const int32 FirstX = FMath::Max(FMath::CeilToInt32(((ComponentBox.Min.X - Origin.X) / Spacing) - 0.5), 0);
+		const int32 LastX = FMath::Min(FMath::FloorToInt32(((ComponentBox.Max.X - Origin.X) / Spacing) - 0.5), CellsX - 1);
+		const int32 FirstY = FMath::Max(FMath::CeilToInt32(((ComponentBox.Min.Y - Origin.Y) / Spacing) - 0.5), 0);
+		const int32 LastY = FMath::Min(FMath::FloorToInt32(((ComponentBox.Max.Y - Origin.Y) / Spacing) - 0.5), CellsY - 1);
+		
+		for (int32 CellY = FirstY; CellY <= LastY; CellY++)
+		{
+			for (int32 CellX = FirstX; CellX <= LastX; CellX++)
+			{
+				CellComponents[(CellY * CellsX) + CellX] = ComponentIndex;
+			}
+		}
+	}
+	
+	Landscape = InLandscape;
+	
+	UE_LOG(LogTemp, Log, TEXT("FNKLandscapeHeightGrid: Sampled '%s' - %d x %d vertices at %.0f cm (%d with height, %.1f MB) in %.2fs"),
+		*InLandscape->GetName(), VerticesX, VerticesY, Spacing, SampledCount,
+		GetAllocatedSize() / (1024.0 * 1024.0), FPlatformTime::Seconds() - StartTime);
+	
+	return true;
+}
+
+void FNKLandscapeHeightGrid::Reset()
+{
+	Landscape.Reset();
+	Origin = FVector2D::ZeroVector;
+	Spacing = 0.0;
+	CellsX = 0;
+	CellsY = 0;
+	Heights.Empty();
+	CellMaxHeights.Empty();
+	CellComponents.Empty();
+	Components.Empty();
+	MinHeight = 0.0f;
+	MaxHeight = 0.0f;
+}
+
+SIZE_T FNKLandscapeHeightGrid::GetAllocatedSize() const
+{
+	return Heights.GetAllocatedSize() + CellMaxHeights.GetAllocatedSize() +
+		CellComponents.GetAllocatedSize() + Components.GetAllocatedSize();
+}
+
+bool FNKLandscapeHeightGrid::TraceRay(const FVector& Start, const FVector& End, FHitResult& OutHit) const
+{
+	if (!IsValid())
+	{
+		return false;
+	}
+	
+	const FVector Delta = End - Start;
+	
+	// 1. Clip the segment to the grid's footprint and height range (padded so flat landscapes keep a slab)
+	const FVector BoxMin(Origin.X, Origin.Y, MinHeight - 1.0f);
+	const FVector BoxMax(Origin.X + (CellsX * Spacing), Origin.Y + (CellsY * Spacing), MaxHeight + 1.0f);
+	double EnterTime = 0.0;
+	double ExitTime = 1.0;
+	
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		if (FMath::IsNearlyZero(Delta[Axis]))
+		{
+			if (Start[Axis] < BoxMin[Axis] || Start[Axis] > BoxMax[Axis])
+			{
+				return false;
+			}
+			continue;
+		}
+		
+		double SlabEnter = (BoxMin[Axis] - Start[Axis]) / Delta[Axis];
+		double SlabExit = (BoxMax[Axis] - Start[Axis]) / Delta[Axis];
+		if (SlabEnter > SlabExit)
+		{
+			Swap(SlabEnter, SlabExit);
+		}
+		
+		EnterTime = FMath::Max(EnterTime, SlabEnter);
+		ExitTime = FMath::Min(ExitTime, SlabExit);
+		if (EnterTime > ExitTime)
+		{
+			return false;
+		}
+	}
+	
+	// 2. Walk the cells under the clipped segment (2D DDA)
+	const FVector EnterPoint = Start + (Delta * EnterTime);
+	int32 CellX = FMath::Clamp(FMath::FloorToInt32((EnterPoint.X - Origin.X) / Spacing), 0, CellsX - 1);
+	int32 CellY = FMath::Clamp(FMath::FloorToInt32((EnterPoint.Y - Origin.Y) / Spacing), 0, CellsY - 1);
+	
+	const bool bMovesX = !FMath::IsNearlyZero(Delta.X);
+	const bool bMovesY = !FMath::IsNearlyZero(Delta.Y);
+	const int32 StepX = Delta.X > 0.0 ? 1 : -1;
+	const int32 StepY = Delta.Y > 0.0 ? 1 : -1;
+	const double CellTimeX = bMovesX ? Spacing / FMath::Abs(Delta.X) : NeverTime;
+	const double CellTimeY = bMovesY ? Spacing / FMath::Abs(Delta.Y) : NeverTime;
+	double NextTimeX = bMovesX ? ((Origin.X + ((CellX + (StepX > 0 ? 1 : 0)) * Spacing)) - Start.X) / Delta.X : NeverTime;
+	double NextTimeY = bMovesY ? ((Origin.Y + ((CellY + (StepY > 0 ? 1 : 0)) * Spacing)) - Start.Y) / Delta.Y : NeverTime;
+	double CellEnterTime = EnterTime;
+	
+	for (;;)
+	{
+		const double CellExitTime = FMath::Min3(NextTimeX, NextTimeY, ExitTime);
+		
+		// Only cells the ray dips below their highest corner can be hit
+		const float CellMax = CellMaxHeights[(CellY * CellsX) + CellX];
+		const double RayLowZ = Start.Z + (Delta.Z * (Delta.Z < 0.0 ? CellExitTime : CellEnterTime));
+		
+		double HitTime;
+		FVector HitNormal;
+		if (CellMax != NoHeight && RayLowZ <= CellMax &&
+			IntersectCell(CellX, CellY, Start, Delta, CellEnterTime, CellExitTime, HitTime, HitNormal))
+		{
+			OutHit = FHitResult(Start, End);
+			OutHit.bBlockingHit = true;
+			OutHit.Time = static_cast<float>(HitTime);
+			OutHit.Distance = static_cast<float>(Delta.Size() * HitTime);
+			OutHit.Location = Start + (Delta * HitTime);
+			OutHit.ImpactPoint = OutHit.Location;
+			OutHit.Normal = HitNormal;
+			OutHit.ImpactNormal = HitNormal;
+			OutHit.HitObjectHandle = FActorInstanceHandle(Landscape.Get());
+			
+			const uint16 ComponentIndex = CellComponents[(CellY * CellsX) + CellX];
+			if (ComponentIndex != MAX_uint16)
+			{
+				OutHit.Component = Components[ComponentIndex];
+			}
+			return true;
+		}
+		
+		if (CellExitTime >= ExitTime)
+		{
+			break;
+		}
+		
+		if (NextTimeX < NextTimeY)
+		{
+			CellX += StepX;
+			CellEnterTime = NextTimeX;
+			NextTimeX += CellTimeX;
+		}
+		else
+		{
+			CellY += StepY;
+			CellEnterTime = NextTimeY;
+			NextTimeY += CellTimeY;
+		}
+		
+		if (CellX < 0 || CellX >= CellsX || CellY < 0 || CellY >= CellsY)
+		{
+			break;
+		}
+	}
+	
+	return false;
+}
+
+bool FNKLandscapeHeightGrid::IntersectCell(int32 CellX, int32 CellY, const FVector& Start, const FVector& Delta, double MinTime, double MaxTime, double& OutTime, FVector& OutNormal) const
+{
+	const double X0 = Origin.X + (CellX * Spacing);
+	const double Y0 = Origin.Y + (CellY * Spacing);
+	const FVector P00(X0, Y0, GetHeight(CellX, CellY));
+	const FVector P10(X0 + Spacing, Y0, GetHeight(CellX + 1, CellY));
+	const FVector P01(X0, Y0 + Spacing, GetHeight(CellX, CellY + 1));
+	const FVector P11(X0 + Spacing, Y0 + Spacing, GetHeight(CellX + 1, CellY + 1));
+	
+	// Same split as landscape collision: diagonal from (0, 0) to (1, 1)
+	// Triangle 0 covers the half with U >= V, triangle 1 the half with V >= U
+	const FVector Triangles[2][3] = { { P00, P10, P11 }, { P00, P11, P01 } };
+	bool bHit = false;
+	
+	for (int32 TriangleIndex = 0; TriangleIndex < 2; TriangleIndex++)
+	{
+		const FVector& A = Triangles[TriangleIndex][0];
+		const FVector& B = Triangles[TriangleIndex][1];
+		const FVector& C = Triangles[TriangleIndex][2];
+		
+		// Counter-clockwise seen from above, so the normal points up
+		const FVector Normal = FVector::CrossProduct(B - A, C - A);
+		const double Facing = FVector::DotProduct(Delta, Normal);
+		if (Facing >= 0.0)
+		{
+			continue;  // Parallel or coming from below
+		}
+		
+		const double Time = FVector::DotProduct(A - Start, Normal) / Facing;
+		if (Time < MinTime - CellTimeTolerance || Time > MaxTime + CellTimeTolerance || (bHit && Time >= OutTime))
+		{
+			continue;
+		}
+		
+		// Inside the cell (given by the time interval) - only the side of the diagonal is left to check
+		const FVector Point = Start + (Delta * Time);
+		const double U = (Point.X - X0) / Spacing;
+		const double V = (Point.Y - Y0) / Spacing;
+		if (TriangleIndex == 0 ? U < V - 1.0e-6 : V < U - 1.0e-6)
+		{
+			continue;
+		}
+		
+		OutTime = Time;
+		OutNormal = Normal.GetSafeNormal();
+		bHit = true;
+	}
+	
+	return bHit;
+}
@@ -0,0 +1,253 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/Utilities/NKScanFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+
+namespace
+{
+	void WritePadding(FArchive& Ar, uint64 Alignment)
+	{
+		static const uint8 Zeros[NKScanFile::StreamAlignment] = {};
+		const uint64 Misalignment = static_cast<uint64>(Ar.Tell()) % Alignment;
+		if (Misalignment != 0)
+		{
+			Ar.Serialize(const_cast<uint8*>(Zeros), Alignment - Misalignment);
+		}
+	}
+	
+	void WriteName(FArchive& Ar, FName Name)
+	{
+		const FTCHARToUTF8 Utf8(*Name.ToString());
+		uint32 Length = Utf8.Length();
+		Ar << Length;
+		Ar.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Length);
+	}
+	
+	/** Smallest encoded source - two empty names, length prefixes only */
+	constexpr uint64 MinEncodedSourceBytes = 2 * sizeof(uint32);
+	
+	bool ReadName(const uint8*& Cursor, const uint8* End, FName& OutName)
+	{
+		uint32 Length = 0;
+		if (End - Cursor < static_cast<int64>(sizeof(Length)))
+		{
+			return false;
+		}
+		FMemory::Memcpy(&Length, Cursor, sizeof(Length));
+		Cursor += sizeof(Length);
+		
+		if (End - Cursor < static_cast<int64>(Length))
+		{
+			return false;
+		}
+		OutName = FName(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Cursor), Length));
+		Cursor += Length;
+		return true;
+	}
+	
+	template<typename T>
+	void WriteStream(FArchive& Ar, FNKScanFileHeader& Header, NKScanFile::EStream Stream, TConstArrayView<T> Values)
+	{
+		static_assert(sizeof(T) == 12 || sizeof(T) == 4 || sizeof(T) == 1, "Stream element must match the file format");
+		check(sizeof(T) == NKScanFile::StreamElementSize[Stream]);
+		
+		WritePadding(Ar, NKScanFile::StreamAlignment);
+		Header.StreamOffsets[Stream] = Ar.Tell();
+		Ar.Serialize(const_cast<T*>(Values.GetData()), Values.Num() * sizeof(T));
+	}
+}
+
+// ===== Writing =====
+
+bool NKScanFile::Write(const FString& FilePath, const FNKScanFileData& Data)
+{
+#if !PLATFORM_LITTLE_ENDIAN
+	UE_LOG(LogTemp, Error, TEXT("NKScanFile: Binary scan files are little-endian only"));
+	return false;
+#endif
+
+	const int32 PointCount = Data.Positions.Num();
+	if (Data.Normals.Num() != PointCount || Data.Angles.Num() != PointCount || Data.ScanHeights.Num() != PointCount
+		|| Data.Distances.Num() != PointCount || Data.Timestamps.Num() != PointCount || Data.RingIndices.Num() != PointCount
+		|| Data.LayerIndices.Num() != PointCount || Data.SourceIndices.Num() != PointCount)
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScanFile: Point streams differ in length - not writing %s"), *FilePath);
+		return false;
+	}
+	
+	// One chunk per run of equal ring index
+	TArray<FNKScanFileChunk> Chunks;
+	for (int32 PointIndex = 0; PointIndex < PointCount; PointIndex++)
+	{
+		if (Chunks.Num() == 0 || Chunks.Last().RingIndex != Data.RingIndices[PointIndex])
+		{
+			FNKScanFileChunk& Chunk = Chunks.AddDefaulted_GetRef();
+			Chunk.RingIndex = Data.RingIndices[PointIndex];
+			Chunk.FirstPoint = PointIndex;
+		}
+		Chunks.Last().PointCount++;
+	}
+	
+	TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Ar)
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScanFile: Cannot open %s for writing"), *FilePath);
+		return false;
+	}
+	
+	FNKScanFileHeader Header;
+	Header.PointCount = PointCount;
+	Header.ChunkCount = Chunks.Num();
+	Header.SourceCount = Data.Sources.Num();
+	Header.ScanDuration = Data.ScanDuration;
+	
+	// Placeholder - rewritten once every offset is known
+	Ar->Serialize(&Header, sizeof(Header));
+	
+	WritePadding(*Ar, NKScanFile::StreamAlignment);
+	Header.ChunkTableOffset = Ar->Tell();
+	Ar->Serialize(Chunks.GetData(), Chunks.Num() * sizeof(FNKScanFileChunk));
+	
+	Header.SourceTableOffset = Ar->Tell();
+	for (const FNKScanSource& Source : Data.Sources)
+	{
+		WriteName(*Ar, Source.ActorName);
+		WriteName(*Ar, Source.ComponentName);
+	}
+	Header.SourceTableSize = Ar->Tell() - Header.SourceTableOffset;
+	
+	WriteStream(*Ar, Header, NKScanFile::Position, Data.Positions);
+	WriteStream(*Ar, Header, NKScanFile::Normal, Data.Normals);
+	WriteStream(*Ar, Header, NKScanFile::Angle, Data.Angles);
+	WriteStream(*Ar, Header, NKScanFile::ScanHeight, Data.ScanHeights);
+	WriteStream(*Ar, Header, NKScanFile::Distance, Data.Distances);
+	WriteStream(*Ar, Header, NKScanFile::Timestamp, Data.Timestamps);
+	WriteStream(*Ar, Header, NKScanFile::RingIndex, Data.RingIndices);
+	WriteStream(*Ar, Header, NKScanFile::LayerIndex, Data.LayerIndices);
+	WriteStream(*Ar, Header, NKScanFile::SourceIndex, Data.SourceIndices);
+	
+	Header.FileSize = Ar->Tell();
+	Ar->Seek(0);
+	Ar->Serialize(&Header, sizeof(Header));
+	
+	const bool bSuccess = Ar->Close() && !Ar->IsError();
+	if (!bSuccess)
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScanFile: Write failed for %s"), *FilePath);
+	}
+	return bSuccess;
+}
+
+// ===== Mapped Reading =====
+
+FNKMappedScanFile::~FNKMappedScanFile()
+{
+	// Region must go before the handle that owns the mapping
+	delete MappedRegion;
+	delete MappedHandle;
+}
+
+TUniquePtr<FNKMappedScanFile> FNKMappedScanFile::Open(const FString& FilePath)
+{
+#if !PLATFORM_LITTLE_ENDIAN
+	UE_LOG(LogTemp, Error, TEXT("NKScanFile: Binary scan files are little-endian only"));
+	return nullptr;
+#endif
+
+	TUniquePtr<FNKMappedScanFile> File(new FNKMappedScanFile());
+	File->FilePath = FilePath;
+	
+	File->MappedHandle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath);
+	if (!File->MappedHandle)
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScanFile: Cannot map %s"), *FilePath);
+		return nullptr;
+	}
+	
+	File->MappedRegion = File->MappedHandle->MapRegion(0, File->MappedHandle->GetFileSize());
+	if (!File->MappedRegion)
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScanFile: Cannot map a region of %s"), *FilePath);
+		return nullptr;
+	}
+	
+	File->MappedData = File->MappedRegion->GetMappedPtr();
+	File->MappedSize = File->MappedRegion->GetMappedSize();
+	
+	if (!File->Validate())
+	{
+		UE_LOG(LogTemp, Error, TEXT("NKScanFile: %s is not a valid version %u scan file"), *FilePath, NKScanFile::Version);
+		return nullptr;
+	}
+	return File;
+}
+
+bool FNKMappedScanFile::Validate()
+{
+	const uint64 Size = static_cast<uint64>(MappedSize);
+	if (Size < sizeof(FNKScanFileHeader))
+	{
+		return false;
+	}
+	FMemory::Memcpy(&Header, MappedData, sizeof(Header));
+	
+	if (Header.Magic != NKScanFile::Magic || Header.Version != NKScanFile::Version
+		|| Header.HeaderSize != sizeof(FNKScanFileHeader) || Header.FileSize != Size
+		|| Header.PointCount > static_cast<uint64>(MAX_int32))
+	{
+		return false;
+	}
+	PointCount = static_cast<int32>(Header.PointCount);
+	
+	// Every stream fully inside the file and aligned for in-place use
+	for (uint32 Stream = 0; Stream < NKScanFile::StreamCount; Stream++)
+	{
+		const uint64 Offset = Header.StreamOffsets[Stream];
+		const uint64 Bytes = Header.PointCount * NKScanFile::StreamElementSize[Stream];
+		if (Offset % NKScanFile::StreamAlignment != 0 || Offset > Size || Bytes > Size - Offset)
+		{
+			return false;
+		}
+	}
+	
+	// Chunk table - in range and covering only existing points
+	const uint64 ChunkBytes = static_cast<uint64>(Header.ChunkCount) * sizeof(FNKScanFileChunk);
+	if (Header.ChunkTableOffset % alignof(FNKScanFileChunk) != 0 || Header.ChunkTableOffset > Size || ChunkBytes > Size - Header.ChunkTableOffset)
+	{
+		return false;
+	}
+	Chunks = TConstArrayView<FNKScanFileChunk>(reinterpret_cast<const FNKScanFileChunk*>(MappedData + Header.ChunkTableOffset), Header.ChunkCount);
+	for (const FNKScanFileChunk& Chunk : Chunks)
+	{
+		if (Chunk.FirstPoint > Header.PointCount || Chunk.PointCount > Header.PointCount - Chunk.FirstPoint)
+		{
+			return false;
+		}
+	}
+	
+	// Source table - the only part that is copied
+	if (Header.SourceTableOffset > Size || Header.SourceTableSize > Size - Header.SourceTableOffset)
+	{
+		return false;
+	}
+	
+	// Reject counts the table cannot hold before allocating for them
+	if (Header.SourceCount > Header.SourceTableSize / MinEncodedSourceBytes || Header.SourceCount > static_cast<uint32>(MAX_int32))
+	{
+		return false;
+	}
+	
+	const uint8* Cursor = MappedData + Header.SourceTableOffset;
+	const uint8* End = Cursor + Header.SourceTableSize;
+	Sources.SetNum(static_cast<int32>(Header.SourceCount));
+	for (FNKScanSource& Source : Sources)
+	{
+		if (!ReadName(Cursor, End, Source.ActorName) || !ReadName(Cursor, End, Source.ComponentName))
+		{
+			return false;
+		}
+	}
+	return true;
+}
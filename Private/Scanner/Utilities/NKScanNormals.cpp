@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/Utilities/NKScanNormals.h"
+#include "Scanner/Utilities/NKScanSpatialIndex.h"
+#include "Scanner/Utilities/NKScannerStats.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Sort.h"
+
+void NKScanNormals::EstimateNormals(TConstArrayView<FVector> Points, const FNKScanSpatialIndex& Index,
+	TConstArrayView<FVector> Viewpoints, int32 NeighbourCount, float MaxNeighbourDistance, TArray<FVector>& OutNormals)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_NormalEstimation);
+	
+	const int32 PointCount = Points.Num();
+	OutNormals.SetNumZeroed(PointCount);
+	if (PointCount == 0 || Index.Num() != PointCount)
+	{
+		return;
+	}
+	
+	const int32 K = FMath::Max(NeighbourCount, 3);
+	const bool bHasViewpoints = Viewpoints.Num() == PointCount;
+	
+	// Points are independent - batch them so every task reuses its neighbour buffer
+	constexpr int32 PointsPerTask = 256;
+	const int32 TaskCount = FMath::DivideAndRoundUp(PointCount, PointsPerTask);
+	ParallelFor(TaskCount, [&](int32 TaskIndex)
+	{
+		TArray<int32> Neighbours;
+		Neighbours.Reserve(K);
+		
+		const int32 First = TaskIndex * PointsPerTask;
+		const int32 Last = FMath::Min(First + PointsPerTask, PointCount);
+		for (int32 PointIndex = First; PointIndex < Last; PointIndex++)
+		{
+			// Bounded search - isolated points would otherwise grow shells across the whole cloud
+			Index.QueryNearest(Points[PointIndex], K, Neighbours, MaxNeighbourDistance);
+			if (Neighbours.Num() < 3)
+			{
+				continue;
+			}
+			
+			FVector Mean = FVector::ZeroVector;
+			for (int32 Neighbour : Neighbours)
+			{
+				Mean += Points[Neighbour];
+			}
+			Mean /= Neighbours.Num();
+			
+			double Covariance[3][3] = {};
+			for (int32 Neighbour : Neighbours)
+			{
+				const FVector Offset = Points[Neighbour] - Mean;
+				for (int32 Row = 0; Row < 3; Row++)
+				{
+					for (int32 Column = Row; Column < 3; Column++)
+					{
+						Covariance[Row][Column] += Offset[Row] * Offset[Column];
+					}
+				}
+			}
+			Covariance[1][0] = Covariance[0][1];
+			Covariance[2][0] = Covariance[0][2];
+			Covariance[2][1] = Covariance[1][2];
+			
+			double Eigenvalues[3];
+			FVector Eigenvectors[3];
+			SolveSymmetric3x3(Covariance, Eigenvalues, Eigenvectors);
+			
+			// Least variance = across the surface
+			FVector Normal = Eigenvectors[0];
+			if (bHasViewpoints && FVector::DotProduct(Normal, Viewpoints[PointIndex] - Points[PointIndex]) < 0.0)
+			{
+				Normal = -Normal;
+			}
+			OutNormals[PointIndex] = Normal;
+		}
+	});
+}
+
+void NKScanNormals::SolveSymmetric3x3(const double Matrix[3][3], double OutEigenvalues[3], FVector OutEigenvectors[3])
+{
+	double A[3][3];
+	double V[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+	FMemory::Memcpy(A, Matrix, sizeof(A));
+	
+	// Cyclic Jacobi - converges in a handful of sweeps for 3x3
+	constexpr int32 MaxSweeps = 16;
+	for (int32 Sweep = 0; Sweep < MaxSweeps; Sweep++)
+	{
+		const double OffDiagonal = FMath::Abs(A[0][1]) + FMath::Abs(A[0][2]) + FMath::Abs(A[1][2]);
+		if (OffDiagonal < 1.0e-12)
+		{
+			break;
+		}
+		
+		for (int32 P = 0; P < 2; P++)
+		{
+			for (int32 Q = P + 1; Q < 3; Q++)
+			{
+				if (FMath::Abs(A[P][Q]) < 1.0e-15)
+				{
+					continue;
+				}
+				
+				// Rotation that zeroes A[P][Q]
+				const double Theta = (A[Q][Q] - A[P][P]) / (2.0 * A[P][Q]);
+				const double T = (Theta >= 0.0 ? 1.0 : -1.0) / (FMath::Abs(Theta) + FMath::Sqrt(Theta * Theta + 1.0));
+				const double C = 1.0 / FMath::Sqrt(T * T + 1.0);
+				const double S = T * C;
+				
+				for (int32 R = 0; R < 3; R++)
+				{
+					const double ARP = A[R][P];
+					const double ARQ = A[R][Q];
+					A[R][P] = C * ARP - S * ARQ;
+					A[R][Q] = S * ARP + C * ARQ;
+				}
+				for (int32 R = 0; R < 3; R++)
+				{
+					const double APR = A[P][R];
+					const double AQR = A[Q][R];
+					A[P][R] = C * APR - S * AQR;
+					A[Q][R] = S * APR + C * AQR;
+				}
+				for (int32 R = 0; R < 3; R++)
+				{
+					const double VRP = V[R][P];
+					const double VRQ = V[R][Q];
+					V[R][P] = C * VRP - S * VRQ;
+					V[R][Q] = S * VRP + C * VRQ;
+				}
+			}
+		}
+	}
+	
+	// Sort ascending; eigenvectors are the columns of V
+	int32 Order[3] = { 0, 1, 2 };
+	Algo::Sort(Order, [&A](int32 Left, int32 Right) { return A[Left][Left] < A[Right][Right]; });
+	for (int32 i = 0; i < 3; i++)
+	{
+		const int32 Column = Order[i];
+		OutEigenvalues[i] = A[Column][Column];
+		OutEigenvectors[i] = FVector(V[0][Column], V[1][Column], V[2][Column]).GetSafeNormal();
+	}
+}
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/Utilities/NKScanSignature.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/Actor.h"
+
+namespace
+{
+	// Quantization steps - below these a change cannot move a hit point noticeably
+	constexpr double LocationQuantum = 0.1;    // cm
+	constexpr double RotationQuantum = 1.0e-4; // quaternion component
+	constexpr double ScaleQuantum = 1.0e-3;
+
+	uint32 HashQuantizedVector(const FVector& Vector, double Quantum)
+	{
+		uint32 Hash = GetTypeHash(FMath::RoundToInt64(Vector.X / Quantum));
+		Hash = HashCombineFast(Hash, GetTypeHash(FMath::RoundToInt64(Vector.Y / Quantum)));
+		return HashCombineFast(Hash, GetTypeHash(FMath::RoundToInt64(Vector.Z / Quantum)));
+	}
+
+	void GetQueryablePrimitives(const AActor* Actor, TArray<UPrimitiveComponent*>& OutPrimitives)
+	{
+		OutPrimitives.Reset();
+		if (!Actor)
+		{
+			return;
+		}
+
+		Actor->GetComponents<UPrimitiveComponent>(OutPrimitives);
+		OutPrimitives.RemoveAllSwap([](const UPrimitiveComponent* Primitive)
+		{
+			return !Primitive || !Primitive->IsQueryCollisionEnabled();
+		}, EAllowShrinking::No);
+	}
+
+	/** Add a component hash to every sector in [FromAngle, ToAngle] (degrees, ToAngle >= FromAngle) */
+	void AccumulateSpan(TArray<uint32>& Signatures, uint32 ComponentHash, float FromAngle, float ToAngle, float StartAngle)
+	{
+		const int32 SectorCount = Signatures.Num();
+		const float SectorSize = 360.0f / SectorCount;
+
+		const int32 FirstSector = FMath::FloorToInt((FromAngle - StartAngle) / SectorSize);
+		const int32 LastSector = FMath::Min(FMath::FloorToInt((ToAngle - StartAngle) / SectorSize), FirstSector + SectorCount - 1);
+
+		for (int32 Sector = FirstSector; Sector <= LastSector; Sector++)
+		{
+			// Sum is order independent and (unlike XOR) never cancels a component counted twice
+			Signatures[((Sector % SectorCount) + SectorCount) % SectorCount] += ComponentHash;
+		}
+	}
+}
+
+uint32 NKScanSignature::HashComponent(const UPrimitiveComponent* Component)
+{
+	if (!Component)
+	{
+		return 0;
+	}
+
+	// Identity - a replaced component is a change even if it ends up in the same place
+	uint32 Hash = GetTypeHash(Component);
+
+	const FTransform& Transform = Component->GetComponentTransform();
+	Hash = HashCombineFast(Hash, HashQuantizedVector(Transform.GetLocation(), LocationQuantum));
+	Hash = HashCombineFast(Hash, HashQuantizedVector(Transform.GetRotation().Vector(), RotationQuantum));
+	Hash = HashCombineFast(Hash, GetTypeHash(FMath::RoundToInt64(Transform.GetRotation().W / RotationQuantum)));
+	Hash = HashCombineFast(Hash, HashQuantizedVector(Transform.GetScale3D(), ScaleQuantum));
+
+	const FBox Box = Component->Bounds.GetBox();
+	Hash = HashCombineFast(Hash, HashQuantizedVector(Box.Min, LocationQuantum));
+	Hash = HashCombineFast(Hash, HashQuantizedVector(Box.Max, LocationQuantum));
+
+	if (const UStaticMeshComponent* MeshComponent = Cast<UStaticMeshComponent>(Component))
+	{
+		Hash = HashCombineFast(Hash, GetTypeHash(MeshComponent->GetStaticMesh()));
+	}
+
+	Hash = HashCombineFast(Hash, GetTypeHash(static_cast<uint8>(Component->GetCollisionEnabled())));
+	return HashCombineFast(Hash, GetTypeHash(static_cast<uint8>(Component->GetCollisionObjectType())));
+}
+
+uint32 NKScanSignature::HashActor(const AActor* Actor)
+{
+	TArray<UPrimitiveComponent*> Primitives;
+	GetQueryablePrimitives(Actor, Primitives);
+
+	uint32 Hash = 0;
+	for (const UPrimitiveComponent* Primitive : Primitives)
+	{
+		Hash += HashComponent(Primitive);
+	}
+	return Hash;
+}
+
+void NKScanSignature::ComputeSectorSignatures(const AActor* Actor, const FVector& Center, float StartAngle, int32 SectorCount, TArray<uint32>& OutSignatures)
+{
+	OutSignatures.Reset();
+	if (SectorCount <= 0)
+	{
+		return;
+	}
+	OutSignatures.SetNumZeroed(SectorCount);
+
+	TArray<UPrimitiveComponent*> Primitives;
+	GetQueryablePrimitives(Actor, Primitives);
+
+	for (const UPrimitiveComponent* Primitive : Primitives)
+	{
+		const uint32 ComponentHash = HashComponent(Primitive);
+		const FBox Box = Primitive->Bounds.GetBox();
+
+		// Bounds around the axis - visible from every angle
+		if (Center.X >= Box.Min.X && Center.X <= Box.Max.X && Center.Y >= Box.Min.Y && Center.Y <= Box.Max.Y)
+		{
+			AccumulateSpan(OutSignatures, ComponentHash, StartAngle, StartAngle + 360.0f, StartAngle);
+			continue;
+		}
+
+		// Yaw interval subtended by the XY corners, measured around the direction to the box center
+		const FVector BoxCenter = Box.GetCenter();
+		const float MidAngle = FMath::RadiansToDegrees(FMath::Atan2(BoxCenter.Y - Center.Y, BoxCenter.X - Center.X));
+		float MinOffset = 0.0f;
+		float MaxOffset = 0.0f;
+
+		const FVector2D Corners[4] = {
+			FVector2D(Box.Min.X, Box.Min.Y), FVector2D(Box.Max.X, Box.Min.Y),
+			FVector2D(Box.Min.X, Box.Max.Y), FVector2D(Box.Max.X, Box.Max.Y)
+		};
+		for (const FVector2D& Corner : Corners)
+		{
+			const float CornerAngle = FMath::RadiansToDegrees(FMath::Atan2(Corner.Y - Center.Y, Corner.X - Center.X));
+			const float Offset = FMath::UnwindDegrees(CornerAngle - MidAngle);
+			MinOffset = FMath::Min(MinOffset, Offset);
+			MaxOffset = FMath::Max(MaxOffset, Offset);
+		}
+
+		AccumulateSpan(OutSignatures, ComponentHash, MidAngle + MinOffset, MidAngle + MaxOffset, StartAngle);
+		AccumulateSpan(OutSignatures, ComponentHash, MidAngle + MinOffset + 180.0f, MidAngle + MaxOffset + 180.0f, StartAngle);
+	}
+}
+
+int32 NKScanSignature::GetSectorIndex(float Angle, float StartAngle, int32 SectorCount)
+{
+	if (SectorCount <= 0)
+	{
+		return 0;
+	}
+
+	const float Relative = FMath::Fmod(FMath::Fmod(Angle - StartAngle, 360.0f) + 360.0f, 360.0f);
+	return FMath::Clamp(FMath::FloorToInt(Relative / (360.0f / SectorCount)), 0, SectorCount - 1);
+}
@@ -0,0 +1,361 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/Utilities/NKScanSpatialIndex.h"
+
+FNKScanSpatialIndex::FNKScanSpatialIndex(float InCellSize)
+{
+	Reset(InCellSize);
+}
+
+void FNKScanSpatialIndex::Reset(float InCellSize)
+{
+	if (InCellSize > 0.0f)
+	{
+		CellSize = FMath::Max(InCellSize, 1.0f);
+		InvCellSize = 1.0f / CellSize;
+	}
+	
+	Points.Reset();
+	NextInCell.Reset();
+	CellHeads.Reset();
+	MinCell = FIntVector::ZeroValue;
+	MaxCell = FIntVector::ZeroValue;
+}
+
+void FNKScanSpatialIndex::Reserve(int32 PointCount)
+{
+	Points.Reserve(PointCount);
+	NextInCell.Reserve(PointCount);
+}
+
+int32 FNKScanSpatialIndex::Insert(const FVector& Location)
+{
+	const FIntVector Cell = GetCell(Location);
+	const int32 PointIndex = Points.Add(Location);
+	
+	int32& Head = CellHeads.FindOrAdd(Cell, INDEX_NONE);
+	NextInCell.Add(Head);
+	Head = PointIndex;
+	
+	if (PointIndex == 0)
+	{
+		MinCell = Cell;
+		MaxCell = Cell;
+	}
+	else
+	{
+		MinCell = FIntVector(FMath::Min(MinCell.X, Cell.X), FMath::Min(MinCell.Y, Cell.Y), FMath::Min(MinCell.Z, Cell.Z));
+		MaxCell = FIntVector(FMath::Max(MaxCell.X, Cell.X), FMath::Max(MaxCell.Y, Cell.Y), FMath::Max(MaxCell.Z, Cell.Z));
+	}
+	return PointIndex;
+}
+
+void FNKScanSpatialIndex::Build(TConstArrayView<FVector> Locations)
+{
+	Reset();
+	Reserve(Locations.Num());
+	for (const FVector& Location : Locations)
+	{
+		Insert(Location);
+	}
+}
+
+void FNKScanSpatialIndex::Build(TConstArrayView<FVector3f> Locations)
+{
+	Reset();
+	Reserve(Locations.Num());
+	for (const FVector3f& Location : Locations)
+	{
+		Insert(FVector(Location));
+	}
+}
+
+FIntVector FNKScanSpatialIndex::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X * InvCellSize),
+		FMath::FloorToInt32(Location.Y * InvCellSize),
+		FMath::FloorToInt32(Location.Z * InvCellSize));
+}
+
+// ===== Queries =====
+
+void FNKScanSpatialIndex::QueryRadius(const FVector& Center, float Radius, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+	if (Points.Num() == 0 || Radius < 0.0f)
+	{
+		return;
+	}
+	
+	const float RadiusSquared = Radius * Radius;
+	auto TestPoint = [&](int32 PointIndex)
+	{
+		if (FVector::DistSquared(Points[PointIndex], Center) <= RadiusSquared)
+		{
+			OutIndices.Add(PointIndex);
+		}
+	};
+	
+	// Clamp the cell box to occupied space; walk occupied cells instead if that is cheaper
+	const FIntVector Lo = GetCell(Center - FVector(Radius));
+	const FIntVector Hi = GetCell(Center + FVector(Radius));
+	const FIntVector From(FMath::Max(Lo.X, MinCell.X), FMath::Max(Lo.Y, MinCell.Y), FMath::Max(Lo.Z, MinCell.Z));
+	const FIntVector To(FMath::Min(Hi.X, MaxCell.X), FMath::Min(Hi.Y, MaxCell.Y), FMath::Min(Hi.Z, MaxCell.Z));
+	if (From.X > To.X || From.Y > To.Y || From.Z > To.Z)
+	{
+		return;
+	}
+	
+	const int64 BoxCells = int64(To.X - From.X + 1) * (To.Y - From.Y + 1) * (To.Z - From.Z + 1);
+	if (BoxCells > CellHeads.Num())
+	{
+		for (const TPair<FIntVector, int32>& CellHead : CellHeads)
+		{
+			const FIntVector& Cell = CellHead.Key;
+			if (Cell.X >= From.X && Cell.X <= To.X && Cell.Y >= From.Y && Cell.Y <= To.Y && Cell.Z >= From.Z && Cell.Z <= To.Z)
+			{
+				ForEachInCell(Cell, TestPoint);
+			}
+		}
+		return;
+	}
+	
+	for (int32 Z = From.Z; Z <= To.Z; Z++)
+	{
+		for (int32 Y = From.Y; Y <= To.Y; Y++)
+		{
+			for (int32 X = From.X; X <= To.X; X++)
+			{
+				ForEachInCell(FIntVector(X, Y, Z), TestPoint);
+			}
+		}
+	}
+}
+
+void FNKScanSpatialIndex::QueryNearest(const FVector& Location, int32 Count, TArray<int32>& OutIndices, float MaxDistance) const
+{
+	OutIndices.Reset();
+	if (Points.Num() == 0 || Count <= 0)
+	{
+		return;
+	}
+	
+	struct FCandidate
+	{
+		double DistanceSquared;
+		int32 PointIndex;
+	};
+	TArray<FCandidate, TInlineAllocator<32>> Candidates;
+	const double MaxDistanceSquared = double(MaxDistance) * MaxDistance;
+	
+	auto TestPoint = [&](int32 PointIndex)
+	{
+		const double DistanceSquared = FVector::DistSquared(Points[PointIndex], Location);
+		if (DistanceSquared <= MaxDistanceSquared)
+		{
+			Candidates.Add({ DistanceSquared, PointIndex });
+		}
+	};
+	
+	// Nothing can qualify if the occupied bounds are out of reach
+	const FBox OccupiedBounds(FVector(MinCell) * CellSize, FVector(MaxCell + FIntVector(1)) * CellSize);
+	if (OccupiedBounds.ComputeSquaredDistanceToPoint(Location) > MaxDistanceSquared)
+	{
+		return;
+	}
+	
+	// Grow a cube shell by shell; after shell N every point closer than N * CellSize has been seen.
+	// Shells that cannot reach the occupied cells are skipped, and each shell is clipped to them,
+	// so a query costs the cells around its k nearest points rather than the cloud's volume.
+	const FIntVector Center = GetCell(Location);
+	auto OutsideBy = [](int32 Value, int32 Lo, int32 Hi) { return FMath::Max3(Lo - Value, Value - Hi, 0); };
+	const int32 FirstShell = FMath::Max3(
+		OutsideBy(Center.X, MinCell.X, MaxCell.X),
+		OutsideBy(Center.Y, MinCell.Y, MaxCell.Y),
+		OutsideBy(Center.Z, MinCell.Z, MaxCell.Z));
+	const int32 LastShell = FMath::Max3(
+		FMath::Max(FMath::Abs(Center.X - MinCell.X), FMath::Abs(MaxCell.X - Center.X)),
+		FMath::Max(FMath::Abs(Center.Y - MinCell.Y), FMath::Abs(MaxCell.Y - Center.Y)),
+		FMath::Max(FMath::Abs(Center.Z - MinCell.Z), FMath::Abs(MaxCell.Z - Center.Z)));
+	
+	for (int32 Shell = FirstShell; Shell <= LastShell; Shell++)
+	{
+		const int32 FromZ = FMath::Max(Center.Z - Shell, MinCell.Z);
+		const int32 ToZ = FMath::Min(Center.Z + Shell, MaxCell.Z);
+		const int32 FromY = FMath::Max(Center.Y - Shell, MinCell.Y);
+		const int32 ToY = FMath::Min(Center.Y + Shell, MaxCell.Y);
+		const int32 FromX = FMath::Max(Center.X - Shell, MinCell.X);
+		const int32 ToX = FMath::Min(Center.X + Shell, MaxCell.X);
+		
+		for (int32 Z = FromZ; Z <= ToZ; Z++)
+		{
+			for (int32 Y = FromY; Y <= ToY; Y++)
+			{
+				if (FMath::Abs(Z - Center.Z) == Shell || FMath::Abs(Y - Center.Y) == Shell)
+				{
+					// Row on a shell face - every cell in range
+					for (int32 X = FromX; X <= ToX; X++)
+					{
+						ForEachInCell(FIntVector(X, Y, Z), TestPoint);
+					}
+				}
+				else
+				{
+					// Interior row - only its two ends are new
+					if (Center.X - Shell >= MinCell.X && Center.X - Shell <= MaxCell.X)
+					{
+						ForEachInCell(FIntVector(Center.X - Shell, Y, Z), TestPoint);
+					}
+					if (Center.X + Shell >= MinCell.X && Center.X + Shell <= MaxCell.X)
+					{
+						ForEachInCell(FIntVector(Center.X + Shell, Y, Z), TestPoint);
+					}
+				}
+			}
+		}
+		
+		if (Candidates.Num() >= Count)
+		{
+			Candidates.Sort([](const FCandidate& A, const FCandidate& B) { return A.DistanceSquared < B.DistanceSquared; });
+			Candidates.SetNum(Count, EAllowShrinking::No);
+			
+			const double Covered = double(Shell) * CellSize;
+			if (Candidates.Last().DistanceSquared <= Covered * Covered)
+			{
+				break;
+			}
+		}
+		
+		if (double(Shell) * CellSize > MaxDistance)
+		{
+			break;
+		}
+	}
+	
+	Candidates.Sort([](const FCandidate& A, const FCandidate& B) { return A.DistanceSquared < B.DistanceSquared; });
+	const int32 ResultCount = FMath::Min(Count, Candidates.Num());
+	OutIndices.Reserve(ResultCount);
+	for (int32 i = 0; i < ResultCount; i++)
+	{
+		OutIndices.Add(Candidates[i].PointIndex);
+	}
+}
+
+int32 FNKScanSpatialIndex::QueryRay(const FVector& Origin, const FVector& Direction, float MaxDistance, float HitRadius, float& OutDistance) const
+{
+	OutDistance = 0.0f;
+	const FVector RayDirection = Direction.GetSafeNormal();
+	if (Points.Num() == 0 || RayDirection.IsZero() || MaxDistance <= 0.0f)
+	{
+		return INDEX_NONE;
+	}
+	
+	const double HitRadiusSquared = double(HitRadius) * HitRadius;
+	int32 BestIndex = INDEX_NONE;
+	double BestDistance = MaxDistance;
+	
+	auto TestPoint = [&](int32 PointIndex)
+	{
+		const FVector ToPoint = Points[PointIndex] - Origin;
+		const double Along = FVector::DotProduct(ToPoint, RayDirection);
+		if (Along < 0.0 || Along > BestDistance)
+		{
+			return;
+		}
+		if ((ToPoint - RayDirection * Along).SizeSquared() <= HitRadiusSquared)
+		{
+			BestDistance = Along;
+			BestIndex = PointIndex;
+		}
+	};
+	
+	// Cells visited along the ray are widened by HitRadius, so a point can be found from a neighbouring cell
+	const int32 Inflate = FMath::CeilToInt32(HitRadius * InvCellSize);
+	TSet<FIntVector> VisitedCells;
+	auto VisitAround = [&](const FIntVector& Cell)
+	{
+		for (int32 DZ = -Inflate; DZ <= Inflate; DZ++)
+		{
+			for (int32 DY = -Inflate; DY <= Inflate; DY++)
+			{
+				for (int32 DX = -Inflate; DX <= Inflate; DX++)
+				{
+					const FIntVector Neighbour = Cell + FIntVector(DX, DY, DZ);
+					bool bAlreadyVisited = false;
+					VisitedCells.Add(Neighbour, &bAlreadyVisited);
+					if (!bAlreadyVisited)
+					{
+						ForEachInCell(Neighbour, TestPoint);
+					}
+				}
+			}
+		}
+	};
+	
+	// Clip the ray to the occupied cell range (widened like the visits) so the walk is bounded
+	const FVector BoxMin = FVector(MinCell - FIntVector(Inflate)) * CellSize;
+	const FVector BoxMax = FVector(MaxCell + FIntVector(Inflate + 1)) * CellSize;
+	double EnterDistance = 0.0;
+	double ExitDistance = MaxDistance;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		if (FMath::IsNearlyZero(RayDirection[Axis]))
+		{
+			if (Origin[Axis] < BoxMin[Axis] || Origin[Axis] > BoxMax[Axis])
+			{
+				return INDEX_NONE;
+			}
+			continue;
+		}
+		const double T0 = (BoxMin[Axis] - Origin[Axis]) / RayDirection[Axis];
+		const double T1 = (BoxMax[Axis] - Origin[Axis]) / RayDirection[Axis];
+		EnterDistance = FMath::Max(EnterDistance, FMath::Min(T0, T1));
+		ExitDistance = FMath::Min(ExitDistance, FMath::Max(T0, T1));
+	}
+	if (EnterDistance > ExitDistance)
+	{
+		return INDEX_NONE;
+	}
+	
+	// 3D DDA (Amanatides & Woo) through the grid, starting where the ray enters the occupied range
+	FIntVector Cell = GetCell(Origin + RayDirection * EnterDistance);
+	FIntVector Step;
+	FVector NextBoundary;
+	FVector BoundaryDelta;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		const double D = RayDirection[Axis];
+		Step[Axis] = D > 0.0 ? 1 : (D < 0.0 ? -1 : 0);
+		if (Step[Axis] == 0)
+		{
+			NextBoundary[Axis] = UE_BIG_NUMBER;
+			BoundaryDelta[Axis] = UE_BIG_NUMBER;
+			continue;
+		}
+		const double Boundary = (Cell[Axis] + (Step[Axis] > 0 ? 1 : 0)) * double(CellSize);
+		NextBoundary[Axis] = (Boundary - Origin[Axis]) / D;
+		BoundaryDelta[Axis] = CellSize / FMath::Abs(D);
+	}
+	
+	// A point projecting to distance T is found by the time the walk enters the cell containing the ray at T,
+	// so once the walk passes the best distance nothing closer can remain
+	double CellEntry = EnterDistance;
+	while (CellEntry <= ExitDistance && CellEntry <= BestDistance)
+	{
+		VisitAround(Cell);
+		
+		const int32 Axis = NextBoundary.X < NextBoundary.Y
+			? (NextBoundary.X < NextBoundary.Z ? 0 : 2)
+			: (NextBoundary.Y < NextBoundary.Z ? 1 : 2);
+		CellEntry = NextBoundary[Axis];
+		NextBoundary[Axis] += BoundaryDelta[Axis];
+		Cell[Axis] += Step[Axis];
+	}
+	
+	if (BestIndex != INDEX_NONE)
+	{
+		OutDistance = static_cast<float>(BestDistance);
+	}
+	return BestIndex;
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/Utilities/NKScanVoxelGrid.h"
+#include "Scanner/Utilities/NKScannerStats.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Sort.h"
+
+namespace
+{
+	// 21 bits per axis packs a voxel coordinate into one uint64 sort key
+	constexpr int32 KeyBitsPerAxis = 21;
+	constexpr uint64 KeyAxisMask = (uint64(1) << KeyBitsPerAxis) - 1;
+	
+	struct FVoxelEntry
+	{
+		uint64 Key;
+		int32 PointIndex;
+		
+		bool operator<(const FVoxelEntry& Other) const
+		{
+			// Point index breaks ties so the first point of a cell is well defined
+			return Key != Other.Key ? Key < Other.Key : PointIndex < Other.PointIndex;
+		}
+	};
+}
+
+void NKScanVoxelGrid::Downsample(TConstArrayView<FVector3f> Points, TConstArrayView<int32> RingIndices, float VoxelSize, FNKVoxelDownsampleResult& OutResult)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NKScanner_Downsample);
+	
+	OutResult.Points.Reset();
+	OutResult.Counts.Reset();
+	OutResult.RingIndices.Reset();
+	OutResult.VoxelSize = FMath::Max(VoxelSize, 0.1f);
+	
+	const int32 PointCount = Points.Num();
+	if (PointCount == 0)
+	{
+		return;
+	}
+	
+	// Quantize relative to the cloud's min corner; grow the voxel if the extent does not fit the key
+	FBox Bounds(ForceInit);
+	for (const FVector3f& Point : Points)
+	{
+		Bounds += FVector(Point);
+	}
+	const double MaxExtent = Bounds.GetSize().GetMax();
+	const double MinVoxelSize = MaxExtent / double(KeyAxisMask);
+	if (OutResult.VoxelSize < MinVoxelSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("NKScanVoxelGrid: Voxel size %.2f too small for a %.0f cm cloud - using %.2f"),
+			OutResult.VoxelSize, MaxExtent, MinVoxelSize);
+		OutResult.VoxelSize = static_cast<float>(MinVoxelSize);
+	}
+	
+	const double InvVoxelSize = 1.0 / OutResult.VoxelSize;
+	const FVector Origin = Bounds.Min;
+	
+	TArray<FVoxelEntry> Entries;
+	Entries.SetNumUninitialized(PointCount);
+	ParallelFor(PointCount, [&](int32 PointIndex)
+	{
+		const FVector Local = (FVector(Points[PointIndex]) - Origin) * InvVoxelSize;
+		const uint64 X = FMath::Min<uint64>(static_cast<uint64>(Local.X), KeyAxisMask);
+		const uint64 Y = FMath::Min<uint64>(static_cast<uint64>(Local.Y), KeyAxisMask);
+		const uint64 Z = FMath::Min<uint64>(static_cast<uint64>(Local.Z), KeyAxisMask);
+		Entries[PointIndex] = { (Z << (2 * KeyBitsPerAxis)) | (Y << KeyBitsPerAxis) | X, PointIndex };
+	});
+	
+	Algo::Sort(Entries);
+	
+	// Each run of equal keys is one cell
+	const bool bHasRings = RingIndices.Num() == PointCount;
+	for (int32 RunStart = 0; RunStart < PointCount;)
+	{
+		const uint64 Key = Entries[RunStart].Key;
+		FVector Sum = FVector::ZeroVector;
+		int32 RunEnd = RunStart;
+		for (; RunEnd < PointCount && Entries[RunEnd].Key == Key; RunEnd++)
+		{
+			Sum += FVector(Points[Entries[RunEnd].PointIndex]);
+		}
+		
+		const int32 CellCount = RunEnd - RunStart;
+		OutResult.Points.Add(Sum / CellCount);
+		OutResult.Counts.Add(CellCount);
+		OutResult.RingIndices.Add(bHasRings ? RingIndices[Entries[RunStart].PointIndex] : 0);
+		RunStart = RunEnd;
+	}
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scanner/Utilities/NKScannerStats.h"
+
+DEFINE_STAT(STAT_NKScanner_MappingStep);
+DEFINE_STAT(STAT_NKScanner_RingScan);
+DEFINE_STAT(STAT_NKScanner_Discovery);
+DEFINE_STAT(STAT_NKScanner_JobQueueTick);
+DEFINE_STAT(STAT_NKScanner_Trace);
+DEFINE_STAT(STAT_NKScanner_LayeredTrace);
+DEFINE_STAT(STAT_NKScanner_ConcurrentTrace);
+DEFINE_STAT(STAT_NKScanner_DebugDraw);
+DEFINE_STAT(STAT_NKScanner_NormalEstimation);
+DEFINE_STAT(STAT_NKScanner_Downsample);
+DEFINE_STAT(STAT_NKScanner_HeightGridBuild);
+
+DEFINE_STAT(STAT_NKScanner_TracesPerFrame);
+DEFINE_STAT(STAT_NKScanner_HeightfieldRaysPerFrame);
+DEFINE_STAT(STAT_NKScanner_TraceCacheHitsPerFrame);
+DEFINE_STAT(STAT_NKScanner_HitsPerFrame);
+
+DEFINE_STAT(STAT_NKScanner_TracesIssued);
+DEFINE_STAT(STAT_NKScanner_HitRate);
+
+DEFINE_STAT(STAT_NKScanner_MapperMemory);
+DEFINE_STAT(STAT_NKScanner_StoreMemory);
+DEFINE_STAT(STAT_NKScanner_HeightGridMemory);
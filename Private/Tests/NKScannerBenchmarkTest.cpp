@@ -0,0 +1,191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Scanner/NKScannerBenchmark.h"
+#include "Tests/AutomationCommon.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformTime.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace
+{
+	/** Empty engine map - the benchmark spawns its own targets */
+	const TCHAR* const BenchmarkMapName = TEXT("/Engine/Maps/Entry");
+	
+	/** Upper bound for the whole case matrix (each run has its own RunTimeoutSeconds) */
+	constexpr double BenchmarkTimeoutSeconds = 1800.0;
+	
+	/** Shared between the latent commands of one test run */
+	struct FNKBenchmarkTestState
+	{
+		TWeakObjectPtr<ANKScannerBenchmark> Benchmark;
+		TArray<FString> CaseNames;
+		double StartTime = 0.0;
+		FString ReportPath;
+	};
+}
+
+/**
+ * Spawn the benchmark in the loaded map and start it
+ */
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FNKStartScannerBenchmarkCommand, TSharedRef<FNKBenchmarkTestState>, State, FAutomationTestBase*, Test);
+
+bool FNKStartScannerBenchmarkCommand::Update()
+{
+	UWorld* World = AutomationCommon::GetAnyGameWorld();
+	if (!World)
+	{
+		Test->AddError(FString::Printf(TEXT("No game world after loading %s"), BenchmarkMapName));
+		return true;
+	}
+	
+	// Deferred so BeginPlay does not start it before the report folder is set
+	ANKScannerBenchmark* Benchmark = World->SpawnActorDeferred<ANKScannerBenchmark>(ANKScannerBenchmark::StaticClass(), FTransform::Identity);
+	if (!Benchmark)
+	{
+		Test->AddError(TEXT("Failed to spawn ANKScannerBenchmark"));
+		return true;
+	}
+	Benchmark->bRunOnBeginPlay = false;
+	Benchmark->bQuitWhenFinished = false;
+	Benchmark->ReportDirectory = FPaths::AutomationTransientDir() / TEXT("ScannerBenchmark");
+	Benchmark->FinishSpawning(FTransform::Identity);
+	
+	for (const FNKScannerBenchmarkCase& Case : Benchmark->Cases)
+	{
+		State->CaseNames.Add(Case.Name);
+	}
+	State->Benchmark = Benchmark;
+	State->StartTime = FPlatformTime::Seconds();
+	
+	Benchmark->StartBenchmark();
+	if (!Benchmark->IsRunning())
+	{
+		Test->AddError(TEXT("Benchmark did not start (no cases or targets)"));
+	}
+	return true;
+}
+
+/**
+ * Wait until every run finished (stops the benchmark on timeout)
+ */
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FNKWaitForScannerBenchmarkCommand, TSharedRef<FNKBenchmarkTestState>, State, FAutomationTestBase*, Test);
+
+bool FNKWaitForScannerBenchmarkCommand::Update()
+{
+	ANKScannerBenchmark* Benchmark = State->Benchmark.Get();
+	if (!Benchmark)
+	{
+		Test->AddError(TEXT("Benchmark actor was destroyed before finishing"));
+		return true;
+	}
+	
+	if (Benchmark->IsRunning())
+	{
+		if (FPlatformTime::Seconds() - State->StartTime < BenchmarkTimeoutSeconds)
+		{
+			return false;
+		}
+		
+		Test->AddError(FString::Printf(TEXT("Benchmark still running after %.0f s"), BenchmarkTimeoutSeconds));
+		Benchmark->StopBenchmark();
+	}
+	
+	State->ReportPath = Benchmark->GetLastReportPath();
+	Benchmark->Destroy();
+	return true;
+}
+
+/**
+ * Parse the JSON report and check every case succeeded
+ */
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FNKVerifyScannerBenchmarkReportCommand, TSharedRef<FNKBenchmarkTestState>, State, FAutomationTestBase*, Test);
+
+bool FNKVerifyScannerBenchmarkReportCommand::Update()
+{
+	if (State->ReportPath.IsEmpty())
+	{
+		Test->AddError(TEXT("Benchmark report was not written"));
+		return true;
+	}
+	
+	FString ReportText;
+	if (!FFileHelper::LoadFileToString(ReportText, *State->ReportPath))
+	{
+		Test->AddError(FString::Printf(TEXT("Cannot read report %s"), *State->ReportPath));
+		return true;
+	}
+	
+	TSharedPtr<FJsonObject> Report;
+	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ReportText);
+	if (!FJsonSerializer::Deserialize(Reader, Report) || !Report.IsValid())
+	{
+		Test->AddError(FString::Printf(TEXT("Report %s is not valid JSON"), *State->ReportPath));
+		return true;
+	}
+	
+	Test->TestEqual(TEXT("Report format"), Report->GetStringField(TEXT("format")), FString(TEXT("nkscanner-benchmark")));
+	
+	const TArray<TSharedPtr<FJsonValue>>* Runs = nullptr;
+	if (!Report->TryGetArrayField(TEXT("runs"), Runs) || Runs->Num() == 0)
+	{
+		Test->AddError(TEXT("Report has no runs"));
+		return true;
+	}
+	
+	TSet<FString> ReportedCases;
+	for (const TSharedPtr<FJsonValue>& RunValue : *Runs)
+	{
+		const TSharedPtr<FJsonObject> Run = RunValue->AsObject();
+		if (!Run.IsValid())
+		{
+			Test->AddError(TEXT("Report run is not an object"));
+			continue;
+		}
+		
+		const FString CaseName = Run->GetStringField(TEXT("case"));
+		ReportedCases.Add(CaseName);
+		
+		bool bSucceeded = false;
+		if (!Run->TryGetBoolField(TEXT("succeeded"), bSucceeded) || !bSucceeded)
+		{
+			FString FailureReason;
+			Run->TryGetStringField(TEXT("failureReason"), FailureReason);
+			Test->AddError(FString::Printf(TEXT("%s / %s failed: %s"),
+				*Run->GetStringField(TEXT("target")), *CaseName, *FailureReason));
+		}
+	}
+	
+	for (const FString& CaseName : State->CaseNames)
+	{
+		Test->TestTrue(FString::Printf(TEXT("Case '%s' reported"), *CaseName), ReportedCases.Contains(CaseName));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNKScannerBenchmarkTest, "TPCPP.Scanner.Benchmark",
+	EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FNKScannerBenchmarkTest::RunTest(const FString& Parameters)
+{
+	if (!AutomationOpenMap(BenchmarkMapName))
+	{
+		AddError(FString::Printf(TEXT("Failed to open %s"), BenchmarkMapName));
+		return false;
+	}
+	
+	TSharedRef<FNKBenchmarkTestState> State = MakeShared<FNKBenchmarkTestState>();
+	ADD_LATENT_AUTOMATION_COMMAND(FNKStartScannerBenchmarkCommand(State, this));
+	ADD_LATENT_AUTOMATION_COMMAND(FNKWaitForScannerBenchmarkCommand(State, this));
+	ADD_LATENT_AUTOMATION_COMMAND(FNKVerifyScannerBenchmarkReportCommand(State, this));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Components/LineBatchComponent.h"
+#include "Scanner/Interfaces/INKDebugVisualizerInterface.h"
+#include "NKDebugVisualizerComponent.generated.h"
+
+// Forward declarations
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+class UMaterialInterface;
+
+/**
+ * All scan points of one color and size - rendered by a single instanced mesh
+ */
+USTRUCT()
+struct FNKDebugPointBatch
+{
+	GENERATED_BODY()
+	
+	FColor Color = FColor::White;
+	
+	/** Rendered diameter (cm), 0 = the visualizer's PointSize */
+	float Size = 0.0f;
+	
+	UPROPERTY()
+	UInstancedStaticMeshComponent* Mesh = nullptr;
+	
+	/** Decimation cell of every instance (instance order) */
+	TArray<FIntVector4> InstanceCells;
+	
+	/** Cells holding a point (instanced or pending) - a second point in the same cell is dropped */
+	TSet<FIntVector4> OccupiedCells;
+	
+	/** Points added since the last flush */
+	TArray<FVector> PendingLocations;
+	TArray<FIntVector4> PendingCells;
+	
+	/** Oldest instance - recycled first once the point cap is reached */
+	int32 RecycleCursor = 0;
+};
+
+/**
+ * Batched debug visualizer
+ *
+ * Scan points go into one instanced static mesh per color and lines into a line batcher owned by
+ * this component, both updated once per frame instead of adding persistent debug primitives to the
+ * world's line batcher. Points closer on screen than MinPixelSpacing (measured from the player camera
+ * when they are added) are dropped, the visible count is capped by recycling the oldest instances,
+ * and clearing drops the instance buffers and the own line batch without flushing the world's lines.
+ *
+ * Mapper and laser tracer route their persistent drawing here when one is present on their owner.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class TPCPP_API UNKDebugVisualizerComponent : public UActorComponent, public INKDebugVisualizerInterface
+{
+	GENERATED_BODY()
+
+public:
+	UNKDebugVisualizerComponent();
+	
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	
+	// ===== INKDebugVisualizerInterface Implementation =====
+	
+	virtual void DrawOrbitPath(const FVector& Center, float Radius, float Height) override;
+	virtual void DrawBoundingBox(const FBox& Bounds) override;
+	virtual void DrawScanPoint(const FVector& Location, bool bHit) override;
+	virtual void DrawScanLine(const FVector& Start, const FVector& End) override;
+	virtual void ClearAllDebugVisuals() override;
+	virtual void ClearScanPoints() override;
+	
+	virtual void SetVisualsLifetime(float Lifetime) override { VisualsLifetime = Lifetime; }
+	virtual void SetShowScanPoints(bool bShow) override { bShowScanPoints = bShow; }
+	virtual void SetShowScanLines(bool bShow) override { bShowScanLines = bShow; }
+	virtual void SetShowOrbitPath(bool bShow) override { bShowOrbitPath = bShow; }
+	virtual void SetShowBoundingBox(bool bShow) override { bShowBoundingBox = bShow; }
+	virtual void SetScanPointColor(FColor Color) override { ScanPointColor = Color; }
+	virtual void SetScanLineColor(FColor Color) override { ScanLineColor = Color; }
+	
+	// ===== Batched Drawing =====
+	
+	/**
+	 * Queue a scan point of any color (instanced on the next tick)
+	 * @param Size - Rendered diameter (cm), 0 = PointSize
+	 * @return false if the point was decimated or dropped by the point cap
+	 */
+	bool AddScanPoint(const FVector& Location, FColor Color, float Size = 0.0f);
+	
+	/**
+	 * Queue a line (drawn on the next tick, lives for VisualsLifetime)
+	 */
+	void AddLine(const FVector& Start, const FVector& End, FColor Color, float Thickness);
+	
+	/** Drop every line drawn by this visualizer */
+	UFUNCTION(BlueprintCallable, Category = "Debug Visualizer")
+	void ClearLines();
+	
+	// ===== Statistics =====
+	
+	/** Points currently instanced (points queued this frame follow on the next tick) */
+	UFUNCTION(BlueprintPure, Category = "Debug Visualizer")
+	int32 GetVisiblePointCount() const { return VisiblePointCount; }
+	
+	/** Points dropped because another point already covered their screen cell */
+	UFUNCTION(BlueprintPure, Category = "Debug Visualizer")
+	int32 GetDecimatedPointCount() const { return DecimatedPointCount; }
+	
+	// ===== Configuration =====
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer")
+	bool bShowScanPoints = true;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer")
+	bool bShowScanLines = true;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer")
+	bool bShowOrbitPath = true;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer")
+	bool bShowBoundingBox = true;
+	
+	/** Color of DrawScanPoint hits */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer")
+	FColor ScanPointColor = FColor::Yellow;
+	
+	/** Color of DrawScanPoint misses */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer")
+	FColor MissPointColor = FColor::Red;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer")
+	FColor ScanLineColor = FColor::Green;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer")
+	FColor OrbitPathColor = FColor::Cyan;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer")
+	FColor BoundingBoxColor = FColor::Yellow;
+	
+	/** Line lifetime in seconds (-1 = until cleared); points always stay until cleared */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer")
+	float VisualsLifetime = -1.0f;
+	
+	/** Rendered point diameter (cm) of points added without a size */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer", meta = (ClampMin = "0.1"))
+	float PointSize = 10.0f;
+	
+	/** Points closer than this on screen (pixels, seen from the player camera when added) are merged */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer|Budget", meta = (ClampMin = "0.0"))
+	float MinPixelSpacing = 2.0f;
+	
+	/** Smallest merge distance (cm) - also used when there is no player camera (headless) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer|Budget", meta = (ClampMin = "0.01"))
+	float MinWorldSpacing = 1.0f;
+	
+	/** Instanced points across all colors - past this the oldest point of the same batch (color and size) is moved instead */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer|Budget", meta = (ClampMin = "1"))
+	int32 MaxVisiblePoints = 200000;
+	
+	/** Lines kept before the line batch is cleared and starts over */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer|Budget", meta = (ClampMin = "1"))
+	int32 MaxVisibleLines = 20000;
+	
+	/** Instanced point mesh (unit sphere of 100 cm diameter is scaled to PointSize) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer|Rendering")
+	TSoftObjectPtr<UStaticMesh> PointMesh;
+	
+	/** Material with a "Color" vector parameter (tinted per batch) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug Visualizer|Rendering")
+	TSoftObjectPtr<UMaterialInterface> PointMaterial;
+
+private:
+	/** One batch per color and size, created on first use */
+	UPROPERTY()
+	TArray<FNKDebugPointBatch> PointBatches;
+	
+	UPROPERTY()
+	ULineBatchComponent* LineBatch = nullptr;
+	
+	/** Lines added since the last flush */
+	TArray<FBatchedLine> PendingLines;
+	
+	int32 VisiblePointCount = 0;
+	int32 DecimatedPointCount = 0;
+	int32 LineCount = 0;
+	
+	// Player view used for screen-space decimation (refreshed once per frame)
+	FVector ViewLocation = FVector::ZeroVector;
+	float PixelAngle = 0.0f;
+	bool bHasView = false;
+	uint64 ViewFrame = MAX_uint64;
+	
+	// ===== Internal Methods =====
+	
+	FNKDebugPointBatch* FindOrCreateBatch(FColor Color, float Size);
+	
+	/** Grid cell a point falls into - cell size grows with distance so it spans MinPixelSpacing on screen */
+	FIntVector4 GetDecimationCell(const FVector& Location);
+	
+	void UpdateView();
+	
+	/** Push pending points to the instance buffers (recycling the oldest past the cap) and pending lines to the line batch */
+	void FlushPending();
+	
+	ULineBatchComponent* GetLineBatch();
+};
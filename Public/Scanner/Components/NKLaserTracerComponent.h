@@ -4,9 +4,49 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "WorldCollision.h"
+#include <atomic>
 #include "Scanner/Interfaces/INKLaserTracerInterface.h"
+#include "Scanner/ScanDataStructures.h"
+#include "Scanner/Utilities/NKLandscapeHeightGrid.h"
 #include "NKLaserTracerComponent.generated.h"
 
+// Forward declarations
+class UNKDebugVisualizerComponent;
+
+/**
+ * Trace cache key: quantized ray plus what kind of trace produced the result
+ */
+struct FNKTraceCacheKey
+{
+	int64 OriginX = 0;
+	int64 OriginY = 0;
+	int64 OriginZ = 0;
+	int32 DirectionX = 0;
+	int32 DirectionY = 0;
+	int32 DirectionZ = 0;
+	
+	/** Trace settings, single vs layered trace, and the layer filter actor */
+	uint32 Variant = 0;
+	
+	bool operator==(const FNKTraceCacheKey& Other) const
+	{
+		return OriginX == Other.OriginX && OriginY == Other.OriginY && OriginZ == Other.OriginZ &&
+			DirectionX == Other.DirectionX && DirectionY == Other.DirectionY && DirectionZ == Other.DirectionZ &&
+			Variant == Other.Variant;
+	}
+	
+	friend uint32 GetTypeHash(const FNKTraceCacheKey& Key)
+	{
+		uint32 Hash = HashCombineFast(GetTypeHash(Key.OriginX), GetTypeHash(Key.OriginY));
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.OriginZ));
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.DirectionX));
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.DirectionY));
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.DirectionZ));
+		return HashCombineFast(Hash, Key.Variant);
+	}
+};
+
 /**
  * Laser tracing component
  * Performs laser traces and visualizes results
@@ -18,6 +58,8 @@ class TPCPP_API UNKLaserTracerComponent : public UActorComponent, public INKLase
 
 public:
 	UNKLaserTracerComponent();
+	
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	// ===== INKLaserTracerInterface Implementation =====
@@ -25,6 +67,16 @@ public:
 	virtual bool PerformTrace(FHitResult& OutHit) override;
 	virtual bool PerformTraceAtAngle(float Angle, FHitResult& OutHit) override;
 	
+	/**
+	 * Perform a laser trace from an explicit pose instead of the camera
+	 * Lets scanners compute rays analytically without moving the camera actor
+	 * @param Start - Ray origin
+	 * @param Direction - Ray direction (normalized), traced out to MaxRange
+	 * @param OutHit - Hit result if trace hits something
+	 * @return true if trace hit something
+	 */
+	bool PerformTraceFromPose(const FVector& Start, const FVector& Direction, FHitResult& OutHit);
+	
 	virtual void SetMaxRange(float Range) override { MaxRange = Range; }
 	virtual float GetMaxRange() const override { return MaxRange; }
 	virtual void SetTraceChannel(ECollisionChannel Channel) override { TraceChannel = Channel; }
@@ -43,6 +95,133 @@ public:
 	virtual void SetLaserThickness(float Thickness) override { LaserThickness = Thickness; }
 	virtual void SetShowLaser(bool bShow) override { bShowLaser = bShow; }
 	
+	/**
+	 * Route persistent discovery lines and hit points to a batched visualizer
+	 * nullptr = persistent debug lines, cleared with FlushPersistentDebugLines
+	 */
+	void SetDebugVisualizer(UNKDebugVisualizerComponent* InDebugVisualizer) { DebugVisualizer = InDebugVisualizer; }
+	
+	// ===== Target-Only Tracing =====
+	
+	/**
+	 * Set the actor traced in TargetOnly scope (caches its queryable primitive components)
+	 * In LandscapeHeightfield scope this also samples the landscape's height grid
+	 * Call again if components are added to or removed from the target, or the landscape is edited
+	 */
+	void SetTraceTarget(AActor* Target);
+	
+	AActor* GetTraceTarget() const { return TraceTarget.Get(); }
+	
+	/** Height grid traced in LandscapeHeightfield scope (built by SetTraceTarget for a landscape target) */
+	const FNKLandscapeHeightGrid& GetLandscapeHeightGrid() const { return LandscapeGrid; }
+	
+	/**
+	 * Async scene queries only exist for single world traces
+	 * Target-only and layered traces are always sync
+	 */
+	bool SupportsAsyncTraces() const { return TraceScope == ETraceScope::World && !bCaptureHitLayers; }
+	
+	// ===== Layered Tracing =====
+	
+	/**
+	 * Trace a ray and record the entry surface of every layer it crosses, not just the first
+	 * Back faces are not hit (exits are not recorded), so a closed mesh yields one layer per crossing into it
+	 * Each segment is a multi trace restarted just past its blocking hit, so occluded geometry is captured too
+	 * @param Start - Ray origin
+	 * @param Direction - Ray direction (normalized), traced out to MaxRange
+	 * @param FilterActor - Only hits on this actor are recorded (nullptr = every actor)
+	 * @param OutHits - Recorded hits in ray order (Distance/Time relative to Start), at most MaxHitLayers
+	 * @return true if at least one layer was recorded
+	 */
+	bool PerformLayeredTraceFromPose(const FVector& Start, const FVector& Direction, const AActor* FilterActor, TArray<FHitResult>& OutHits);
+	
+	/**
+	 * Layered trace without logging, drawing or touching last-shot state (safe from worker threads)
+	 * @return Number of layers recorded
+	 */
+	int32 TraceRayLayersConcurrent(const FVector& Start, const FVector& Direction, const FCollisionQueryParams& QueryParams, const AActor* FilterActor, TArray<FHitResult>& OutHits) const;
+	
+	// ===== Async Tracing =====
+	
+	/**
+	 * Submit a ray to the world's async scene query pipeline
+	 * Results become available on the next frame via QueryAsyncTrace
+	 * @param Start - Ray origin
+	 * @param Direction - Ray direction (normalized), traced out to MaxRange
+	 * @return Handle used to collect the result
+	 */
+	FTraceHandle SubmitAsyncTrace(const FVector& Start, const FVector& Direction);
+	
+	/**
+	 * Collect the result of a previously submitted async trace
+	 * Async results only live for one frame, so collect them on the frame after submission
+	 * @param Handle - Handle returned by SubmitAsyncTrace
+	 * @param bOutHit - Whether the ray hit something
+	 * @param OutHit - Hit result if the ray hit something
+	 * @return false if the result is not ready yet (or has expired - see IsAsyncTraceExpired)
+	 */
+	bool QueryAsyncTrace(const FTraceHandle& Handle, bool& bOutHit, FHitResult& OutHit);
+	
+	/**
+	 * Check if an async trace result can no longer be collected (must be resubmitted)
+	 */
+	bool IsAsyncTraceExpired(const FTraceHandle& Handle) const;
+	
+	// ===== Concurrent Tracing =====
+	
+	/**
+	 * Trace a ray without logging, drawing or touching last-shot state
+	 * Safe to call from worker threads (e.g. ParallelFor) while the game thread waits
+	 * @param Start - Ray origin
+	 * @param Direction - Ray direction (normalized), traced out to MaxRange
+	 * @param QueryParams - Params from BuildQueryParams, built once on the game thread
+	 * @param OutHit - Hit result if trace hits something
+	 * @return true if trace hit something (fallback channel included)
+	 */
+	bool TraceRayConcurrent(const FVector& Start, const FVector& Direction, const FCollisionQueryParams& QueryParams, FHitResult& OutHit) const;
+	
+	/** Build the query params shared by all traces from this component */
+	FCollisionQueryParams BuildQueryParams() const;
+	
+	// ===== Batched Tracing =====
+	
+	/**
+	 * Trace a batch of rays with one set of query params, one cache validation and one log line
+	 * The fallback channel is retried for the misses only, after the primary pass. Last-shot state
+	 * follows the final ray; each ray is drawn like a single trace when the laser is shown.
+	 * Game thread only (the rays themselves run on worker threads when bConcurrent).
+	 * @param Origins - One origin per ray, or a single origin shared by every ray
+	 * @param Directions - Ray directions (normalized), traced out to MaxRange
+	 * @param OutResults - Per-ray hit columns (reset to Directions.Num() entries)
+	 * @param bConcurrent - Spread the rays over worker threads with ParallelFor
+	 * @return Number of rays that hit something
+	 */
+	int32 PerformTraces(TConstArrayView<FVector> Origins, TConstArrayView<FVector> Directions, FNKTraceBatchResults& OutResults, bool bConcurrent = true);
+	
+	// ===== Trace Cache =====
+	
+	/**
+	 * Flush the trace cache if the trace target's geometry changed since it was filled (settings are part of each key)
+	 * Also (re)samples the landscape height grid in LandscapeHeightfield scope.
+	 * Game thread only - traces check this once per frame themselves; call it before handing rays to workers
+	 */
+	void ValidateTraceCache();
+	
+	/** Drop every cached trace result */
+	UFUNCTION(BlueprintCallable, Category = "Laser Trace|Cache")
+	void ClearTraceCache();
+	
+	UFUNCTION(BlueprintPure, Category = "Laser Trace|Cache")
+	int32 GetTraceCacheSize() const;
+	
+	/** Traces answered from the cache since the component was created */
+	UFUNCTION(BlueprintPure, Category = "Laser Trace|Cache")
+	int32 GetTraceCacheHits() const { return TraceCacheHits.load(std::memory_order_relaxed); }
+	
+	/** Traces that went to the physics scene while the cache was enabled */
+	UFUNCTION(BlueprintPure, Category = "Laser Trace|Cache")
+	int32 GetTraceCacheMisses() const { return TraceCacheMisses.load(std::memory_order_relaxed); }
+	
 	// ===== Configuration =====
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace")
@@ -54,6 +233,33 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace")
 	bool bUseComplexCollision = true;  // Use complex collision for landscapes
 	
+	/**
+	 * World = trace the scene; TargetOnly = trace only the trace target's components (see SetTraceTarget);
+	 * LandscapeHeightfield = intersect a height grid sampled from a landscape trace target (TargetOnly otherwise)
+	 * Set before SetTraceTarget, which samples the grid
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace")
+	ETraceScope TraceScope = ETraceScope::World;
+	
+	/** Vertex budget of the landscape height grid (~10 bytes each) - its spacing doubles from the landscape's quad size until it fits */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace|Landscape",
+		meta = (EditCondition = "TraceScope == ETraceScope::LandscapeHeightfield", ClampMin = "1024"))
+	int32 MaxLandscapeGridSamples = 4194304;
+	
+	/** Record every surface along each ray (layer index = order along the ray) instead of the first hit only */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace|Layers")
+	bool bCaptureHitLayers = false;
+	
+	/** Maximum number of layers recorded per ray */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace|Layers",
+		meta = (EditCondition = "bCaptureHitLayers", ClampMin = "1", ClampMax = "64"))
+	int32 MaxHitLayers = 8;
+	
+	/** Distance (cm) a layered trace restarts past each blocking surface */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace|Layers",
+		meta = (EditCondition = "bCaptureHitLayers", ClampMin = "0.01"))
+	float LayerRestartOffset = 0.5f;
+	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace")
 	bool bUseFallbackChannel = false;  // Try alternate channel if primary fails
 	
@@ -61,6 +267,25 @@ public:
 		meta = (EditCondition = "bUseFallbackChannel"))
 	TEnumAsByte<ECollisionChannel> FallbackTraceChannel = ECC_Visibility;
 	
+	/**
+	 * Answer repeated rays from a cache instead of the physics scene (repeat scans of static targets)
+	 * Keyed by quantized ray and trace settings; flushed when the trace target moves or changes (NKScanSignature::HashActor)
+	 * or a different target is set. Other actors are not tracked - keep it off when occluders move in World scope.
+	 * Async traces always go to the scene.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace|Cache")
+	bool bUseTraceCache = false;
+	
+	/** Ray origins closer than this (cm) share a cache entry */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace|Cache",
+		meta = (EditCondition = "bUseTraceCache", ClampMin = "0.001"))
+	float TraceCacheOriginTolerance = 0.01f;
+	
+	/** Entries kept before the cache is flushed (a hit result is ~250 bytes) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Trace|Cache",
+		meta = (EditCondition = "bUseTraceCache", ClampMin = "1024"))
+	int32 MaxTraceCacheEntries = 262144;
+	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Laser Visualization")
 	bool bShowLaser = true;
 	
@@ -74,6 +299,58 @@ public:
 	float VisualsLifetime = -1.0f;  // Infinite by default
 
 private:
+	/**
+	 * Trace only the trace target's primitive components (bounds-culled first), keeping the nearest hit
+	 * Read-only, so it is also used from TraceRayConcurrent
+	 */
+	bool TraceTargetComponents(const FVector& Start, const FVector& End, const FCollisionQueryParams& QueryParams, FHitResult& OutHit) const;
+	
+	/**
+	 * Layered trace on one channel (see TraceRayLayersConcurrent)
+	 */
+	int32 TraceLayersOnChannel(const FVector& Start, const FVector& Direction, ECollisionChannel Channel, const FCollisionQueryParams& QueryParams, const AActor* FilterActor, TArray<FHitResult>& OutHits) const;
+	
+	/** Update last shot state from a finished trace */
+	void UpdateLastShotState(bool bHit, const FHitResult& Hit);
+	
+	// ===== Trace Cache Helpers (thread-safe) =====
+	
+	FNKTraceCacheKey MakeTraceCacheKey(const FVector& Start, const FVector& Direction, bool bLayered, const AActor* FilterActor) const;
+	bool FindCachedTrace(const FNKTraceCacheKey& Key, TArray<FHitResult>& OutHits) const;
+	void AddCachedTrace(const FNKTraceCacheKey& Key, TConstArrayView<FHitResult> Hits) const;
+	
+	/** Hash of every setting that changes what a ray hits */
+	uint32 HashTraceSettings() const;
+	
+	/**
+	 * Match the landscape height grid to the trace target and scope (game thread)
+	 * @param bAllowBuild - Sample the landscape if the grid is missing or stale; otherwise a stale grid is only dropped
+	 */
+	void UpdateLandscapeGrid(bool bAllowBuild);
+	
+	/** Rays go to the height grid (LandscapeHeightfield scope with a built grid) instead of the components */
+	FORCEINLINE bool IsTracingHeightGrid() const { return TraceScope == ETraceScope::LandscapeHeightfield && LandscapeGrid.IsValid(); }
+	
+	// Trace cache state (filled from const concurrent traces, hence mutable + lock)
+	mutable TMap<FNKTraceCacheKey, TArray<FHitResult, TInlineAllocator<1>>> TraceCache;
+	mutable FRWLock TraceCacheLock;
+	mutable std::atomic<int32> TraceCacheHits { 0 };
+	mutable std::atomic<int32> TraceCacheMisses { 0 };
+	uint32 TraceCacheTargetSignature = 0;
+	uint64 TraceCacheValidatedFrame = MAX_uint64;
+	
+	UPROPERTY()
+	UNKDebugVisualizerComponent* DebugVisualizer = nullptr;
+	
+	// Target-only trace state
+	TWeakObjectPtr<AActor> TraceTarget;
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> TargetPrimitives;
+	
+	// Landscape heightfield state (grid is only read while rays are in flight)
+	FNKLandscapeHeightGrid LandscapeGrid;
+	uint32 LandscapeGridSignature = 0;
+	int64 ReportedGridBytes = 0;
+	
 	// Last shot state
 	bool bLastShotHit;
 	UPROPERTY()
@@ -4,10 +4,75 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "WorldCollision.h"
+#include "Scanner/ScanDataStructures.h"
+#include "Scanner/Utilities/NKScanSpatialIndex.h"
 #include "NKOrbitMapperComponent.generated.h"
 
 // Forward declarations
 class UNKLaserTracerComponent;
+class UNKScanStoreComponent;
+class UNKDebugVisualizerComponent;
+
+/**
+ * Orbit ray submitted to the async trace pipeline, waiting for its result
+ */
+struct FNKPendingOrbitShot
+{
+	FTraceHandle Handle;
+	int32 ShotIndex = 0;
+	FVector Origin = FVector::ZeroVector;
+	FVector Direction = FVector::ForwardVector;
+	
+	/** Trace was resubmitted after its result expired - no new batch goes out until it is collected */
+	bool bResubmitted = false;
+};
+
+/**
+ * Orbit rays traced as one batch (columns line up with UNKLaserTracerComponent::PerformTraces)
+ */
+struct FNKOrbitRayBatch
+{
+	TArray<FVector> Origins;
+	TArray<FVector> Directions;
+	TArray<float> Angles;
+	TArray<int32> RingIndices;
+	
+	int32 Num() const { return Origins.Num(); }
+	
+	void Reserve(int32 RayCount)
+	{
+		Origins.Reserve(RayCount);
+		Directions.Reserve(RayCount);
+		Angles.Reserve(RayCount);
+		RingIndices.Reserve(RayCount);
+	}
+	
+	void Add(const FVector& Origin, const FVector& Direction, float Angle, int32 RingIndex)
+	{
+		Origins.Add(Origin);
+		Directions.Add(Direction);
+		Angles.Add(Angle);
+		RingIndices.Add(RingIndex);
+	}
+};
+
+/**
+ * Traced sample kept by adaptive mapping until its interval is final
+ */
+struct FNKAdaptiveSample
+{
+	float Angle = 0.0f;
+	
+	/** Ring the sample belongs to (intervals never span rings) */
+	int32 RingIndex = 0;
+	
+	FVector OrbitPosition = FVector::ZeroVector;
+	bool bHitTarget = false;
+	
+	/** Target surfaces along the ray - [0] is the outer surface, more only with layered traces */
+	TArray<FNKScanHit> TargetHits;
+};
 
 /**
  * Delegate fired when mapping completes successfully
@@ -19,11 +84,24 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnMappingCompleteSignature);
  */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnMappingFailedSignature);
 
+/**
+ * Delegate fired when the voxel-downsampled cloud is ready (game thread)
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDownsampleCompleteSignature, int32, CellCount);
+
+/**
+ * Delegate fired when estimated normals are ready (game thread)
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNormalsEstimatedSignature, int32, PointCount);
+
 /**
  * Component that handles async tick-based orbital mapping
  * Similar to TargetFinderComponent but for the mapping phase
  * 
- * Moves camera around orbit incrementally, shooting one laser per tick
+ * Moves camera around orbit incrementally. Shots are scheduled on a fixed
+ * timestep (one per ShotDelay, catching up on every shot that is due) or in
+ * burst mode (as many shots per tick as BurstBudgetMs allows). Shot N is always
+ * fired at StartAngle + N * AngularStepDegrees, so results do not depend on frame rate.
  */
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class TPCPP_API UNKOrbitMapperComponent : public UActorComponent
@@ -37,7 +115,14 @@ public:
 
 	// ===== Configuration =====
 	
-	/** Angular step in degrees (how much to rotate each tick) */
+	/**
+	 * Mapping mode (Orbit = uniform steps, Adaptive = coarse steps refined where the surface changes,
+	 * Spiral = uniform steps while climbing through the target's full height in one pass)
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings")
+	EMappingMode MappingMode = EMappingMode::Orbit;
+	
+	/** Angular step in degrees (how much to rotate each tick; minimum step in Adaptive mode) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings")
 	float AngularStepDegrees = 0.5f;
 	
@@ -45,6 +130,118 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings")
 	float ShotDelay = 0.1f;
 	
+	/**
+	 * Burst mode: ignore ShotDelay and fire as many shots per tick as BurstBudgetMs allows
+	 * Intended for headless/offline scans where wall time matters more than visuals
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings")
+	bool bBurstMode = false;
+	
+	/** Time budget per tick in milliseconds for burst mode (at least one shot is always fired) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings",
+		meta = (EditCondition = "bBurstMode", ClampMin = "0.1", ClampMax = "1000.0"))
+	float BurstBudgetMs = 4.0f;
+	
+	/** Burst mode with virtual poses: orbit rays traced per batch (the budget is checked between batches) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings",
+		meta = (EditCondition = "bBurstMode", ClampMin = "1", ClampMax = "4096"))
+	int32 BurstBatchSize = 32;
+	
+	/**
+	 * Async mode: submit batches of orbit rays to the async scene query pipeline
+	 * and collect them on the next frame (scan cost moves off the game thread)
+	 * Rays are computed from the orbit directly, the camera only follows for visual feedback
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings")
+	bool bUseAsyncTraces = false;
+	
+	/** Number of orbit rays submitted per tick in async mode */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings",
+		meta = (EditCondition = "bUseAsyncTraces", ClampMin = "1", ClampMax = "4096"))
+	int32 AsyncBatchSize = 64;
+	
+	/**
+	 * Virtual-pose mode: compute each ray from the orbit analytically and trace it directly
+	 * The camera actor is not moved per shot (no transform propagation per sample)
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings")
+	bool bVirtualPoseScanning = false;
+	
+	/**
+	 * Seconds between camera moves for visual feedback in virtual-pose and async modes
+	 * 0 = never move the camera during mapping
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings", meta = (ClampMin = "0.0"))
+	float VisualFeedbackInterval = 0.1f;
+	
+	/**
+	 * External scheduling: the component does not tick while mapping - shots are fired only through FireShots
+	 * Used when a scheduler shares one trace budget between several mappers (see UNKScanJobQueueComponent)
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Settings")
+	bool bExternalScheduling = false;
+	
+	/** Adaptive mode: initial coarse step in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Adaptive",
+		meta = (ClampMin = "0.1", ClampMax = "90.0", EditCondition = "MappingMode == EMappingMode::Adaptive", EditConditionHides))
+	float AdaptiveCoarseStepDegrees = 8.0f;
+	
+	/** Adaptive mode: subdivide when neighbouring hit distances differ by more than this (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Adaptive",
+		meta = (ClampMin = "0.0", EditCondition = "MappingMode == EMappingMode::Adaptive", EditConditionHides))
+	float AdaptiveDistanceThreshold = 25.0f;
+	
+	/** Adaptive mode: subdivide when neighbouring hit normals differ by more than this (degrees) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Adaptive",
+		meta = (ClampMin = "0.0", ClampMax = "180.0", EditCondition = "MappingMode == EMappingMode::Adaptive", EditConditionHides))
+	float AdaptiveNormalThresholdDegrees = 10.0f;
+	
+	/** Spiral mode: height climbed per revolution (cm) - also the vertical spacing between revolutions */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Spiral",
+		meta = (ClampMin = "1.0", EditCondition = "MappingMode == EMappingMode::Spiral", EditConditionHides))
+	float SpiralPitch = 100.0f;
+	
+	/**
+	 * Number of angular sectors tracked for incremental rescans (see RescanChangedSectors)
+	 * More sectors = smaller rescans after local changes, slightly more signature work
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Rescan", meta = (ClampMin = "1", ClampMax = "720"))
+	int32 RescanSectorCount = 36;
+	
+	/**
+	 * Cell size of the hit point spatial index (cm, applied when mapping starts)
+	 * Around the query radius works best; much smaller only adds empty cells to walk
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Spatial", meta = (ClampMin = "1.0"))
+	float SpatialIndexCellSize = 50.0f;
+	
+	/**
+	 * Build a voxel-downsampled copy of the hit points on worker threads when mapping completes
+	 * Near faces collect many nearly coincident hits - one averaged point per voxel evens out the cloud
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Downsample")
+	bool bDownsampleOnComplete = false;
+	
+	/** Voxel edge length for downsampling (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Downsample", meta = (ClampMin = "0.1"))
+	float DownsampleVoxelSize = 10.0f;
+	
+	/**
+	 * Estimate a surface normal per hit point (kNN + PCA on worker threads) when mapping completes
+	 * The fitted normals replace the ray-hit normals in the scan store (smoother on noisy complex collision,
+	 * but they are the only normals kept). Only the store and exports read them - recording playback does not.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Normals")
+	bool bEstimateNormalsOnComplete = false;
+	
+	/** Neighbours per normal fit (including the point itself) - more = smoother, slower */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Normals", meta = (ClampMin = "3", ClampMax = "64"))
+	int32 NormalEstimationNeighbours = 12;
+	
+	/** Neighbours further than this (cm) are not used - points without enough close neighbours keep a zero normal */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Normals", meta = (ClampMin = "1.0"))
+	float NormalEstimationRadius = 200.0f;
+	
 	/** Whether to draw debug visualization during mapping */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mapping|Debug")
 	bool bDrawDebugVisuals = true;
@@ -57,7 +254,7 @@ public:
 	 * @param InTargetActor - The actor to orbit around
 	 * @param InOrbitCenter - Center point of orbit (XY from target center, Z from scan height)
 	 * @param InOrbitRadius - Radius of orbit circle
-	 * @param InScanHeight - Z height to maintain during orbit
+	 * @param InScanHeight - Z height to maintain during orbit (Spiral mode climbs through the target bounds instead)
 	 * @param InStartAngle - Starting angle in degrees (usually from discovery first hit)
 	 * @param InLaserTracer - Laser tracer component to use for shooting
 	 */
@@ -71,12 +268,115 @@ public:
 		UNKLaserTracerComponent* InLaserTracer
 	);
 	
+	/**
+	 * Scan several stacked horizontal rings around the target in one job
+	 * Every ring's rays go into one flat ring-major batch traced in parallel through the laser tracer's
+	 * PerformTraces (thread-safe scene queries); hits are merged back in ring order, so the result is
+	 * deterministic. In Adaptive mode every ring is refined like an adaptive orbit instead, all rings
+	 * batched per subdivision level. Completes before returning (OnMappingComplete fires).
+	 * 
+	 * @param InTargetActor - The actor to orbit around
+	 * @param InOrbitCenter - Center point of orbit (XY used, Z replaced per ring)
+	 * @param InOrbitRadius - Radius of every ring
+	 * @param InRingHeights - Z height of each ring (ring index = array index)
+	 * @param InStartAngle - Starting angle in degrees for every ring
+	 * @param InLaserTracer - Laser tracer component providing trace settings
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping")
+	void StartRingScan(
+		AActor* InTargetActor,
+		FVector InOrbitCenter,
+		float InOrbitRadius,
+		const TArray<float>& InRingHeights,
+		float InStartAngle,
+		UNKLaserTracerComponent* InLaserTracer
+	);
+	
+	/**
+	 * Rescan only the angular sectors whose target geometry changed since the last completed scan
+	 * Changed sectors are detected from per-sector signatures of the target's components (transform,
+	 * bounds, mesh, collision) captured when the scan completed. Their old points are dropped and the
+	 * sectors re-shot on every ring of the last scan (refined again after an adaptive scan); fresh points are
+	 * spliced into the output in orbit order and their rays added to the shot count.
+	 * Runs synchronously (rings in parallel). Only the target's own geometry is tracked, not occluders.
+	 * @return Number of sectors rescanned (0 if nothing changed or there is no completed scan)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping")
+	int32 RescanChangedSectors();
+	
+	/**
+	 * Voxel-downsample the current hit points on worker threads
+	 * Works on a snapshot - results land in Downsampled* and OnDownsampleComplete fires on the game thread.
+	 * A newer request (or a new mapping) supersedes a running one.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping|Downsample")
+	void StartDownsample();
+	
+	/** Is a downsample running on the worker threads? */
+	UFUNCTION(BlueprintPure, Category = "Mapping|Downsample")
+	bool IsDownsampling() const { return bDownsampling; }
+	
+	/**
+	 * Estimate normals for the current hit points on worker threads
+	 * Works on a snapshot - results replace the scan store's normals and OnNormalsEstimated fires on the game thread
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping|Normals")
+	void StartNormalEstimation();
+	
+	/** Is normal estimation running on the worker threads? */
+	UFUNCTION(BlueprintPure, Category = "Mapping|Normals")
+	bool IsEstimatingNormals() const { return bEstimatingNormals; }
+	
 	/**
 	 * Stop mapping (can be resumed or cancelled)
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Mapping")
 	void StopMapping();
 	
+	/**
+	 * Pause mapping (keeps all state - ResumeMapping continues with the next shot)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping")
+	void PauseMapping();
+	
+	/**
+	 * Resume a paused mapping
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping")
+	void ResumeMapping();
+	
+	/**
+	 * Fire up to MaxShots shots now (synchronous traces, ignores ShotDelay/burst/async settings)
+	 * Entry point for external schedulers; stops early when mapping completes
+	 * Virtual-pose orbit and spiral shots are traced as one batch
+	 * @return Number of shots fired
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping")
+	int32 FireShots(int32 MaxShots);
+	
+	/**
+	 * Check if mapping is paused
+	 */
+	UFUNCTION(BlueprintPure, Category = "Mapping")
+	bool IsPaused() const { return bIsPaused; }
+	
+	/**
+	 * Set the scan store that holds every target hit (with normals, distances and sources)
+	 * nullptr = the mapper creates its own store when mapping starts
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping")
+	void SetScanStore(UNKScanStoreComponent* InScanStore);
+	
+	UFUNCTION(BlueprintPure, Category = "Mapping")
+	UNKScanStoreComponent* GetScanStore() const { return ScanStore; }
+	
+	/**
+	 * Set the batched visualizer that draws persistent hit points
+	 * nullptr = persistent DrawDebugSphere calls (slow once thousands of points are drawn)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping")
+	void SetDebugVisualizer(UNKDebugVisualizerComponent* InDebugVisualizer) { DebugVisualizer = InDebugVisualizer; }
+	
 	/**
 	 * Check if currently mapping
 	 */
@@ -107,21 +407,106 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Mapping")
 	int32 GetHitCount() const { return HitCount; }
 	
+	/**
+	 * Approximate memory held by the spatial index and downsample output (bytes, allocated capacity) - hits are in the scan store
+	 */
+	UFUNCTION(BlueprintPure, Category = "Mapping")
+	int64 GetAllocatedBytes() const;
+	
+	// Hit point attributes are read from the scan store (the only copy) - these build Blueprint arrays,
+	// C++ callers should prefer the store's attribute views
+	
 	/**
 	 * Get mapping hit points (positions where laser hit target during orbit)
-	 * Used by recording camera for playback
+	 * Blueprint access to what was the MappingHitPoints property - returns a copy of the whole cloud,
+	 * C++ reads GetScanStore()->GetPositions() instead
 	 */
 	UFUNCTION(BlueprintPure, Category = "Mapping")
-	const TArray<FVector>& GetMappingHitPoints() const { return MappingHitPoints; }
+	TArray<FVector> GetMappingHitPoints() const;
+	
+	/**
+	 * Get ring index of every mapping hit point (parallel to GetMappingHitPoints)
+	 * Single orbits are ring 0; stacked ring scans tag each point with its ring, spirals with the revolution
+	 */
+	UFUNCTION(BlueprintPure, Category = "Mapping")
+	TArray<int32> GetMappingHitRingIndices() const;
+	
+	/**
+	 * Get layer index of every mapping hit point (parallel to GetMappingHitPoints)
+	 * 0 = first target surface along the ray; deeper surfaces only with layered traces (see UNKLaserTracerComponent::bCaptureHitLayers)
+	 */
+	UFUNCTION(BlueprintPure, Category = "Mapping")
+	TArray<int32> GetMappingHitLayerIndices() const;
+	
+	/**
+	 * Get orbit angle (degrees) each mapping hit point was shot from (parallel to GetMappingHitPoints)
+	 */
+	UFUNCTION(BlueprintPure, Category = "Mapping")
+	TArray<float> GetMappingHitAngles() const;
+	
+	/**
+	 * Get the surface normal of every mapping hit point (parallel to GetMappingHitPoints)
+	 */
+	UFUNCTION(BlueprintPure, Category = "Mapping")
+	TArray<FVector> GetMappingHitNormals() const;
+	
+	/**
+	 * Get number of rings in the last scan (1 for a single orbit, one per revolution for spirals)
+	 */
+	UFUNCTION(BlueprintPure, Category = "Mapping")
+	int32 GetRingCount() const { return RingCount; }
+	
+	// ===== Spatial Queries (indices into the scan store's points) =====
+	
+	/**
+	 * Hit points within Radius of Center (unordered)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping|Spatial")
+	TArray<int32> FindHitPointsInRadius(const FVector& Center, float Radius) const;
+	
+	/**
+	 * Up to Count hit points closest to Location, nearest first
+	 * @param MaxDistance - Ignore points further than this (0 = unlimited)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping|Spatial")
+	TArray<int32> FindNearestHitPoints(const FVector& Location, int32 Count, float MaxDistance = 0.0f) const;
+	
+	/**
+	 * First hit point along a ray that lies within HitRadius of it
+	 * @param OutDistance - Distance along the ray to the point
+	 * @return true if a point was found within MaxDistance
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping|Spatial")
+	bool RaycastHitPoints(const FVector& Origin, const FVector& Direction, float MaxDistance, float HitRadius, int32& OutPointIndex, float& OutDistance) const;
+	
+	/** Spatial index over the scan store's points (brought up to date with the store on access) */
+	const FNKScanSpatialIndex& GetSpatialIndex() const;
+	
+	/**
+	 * Get the outer-surface (layer 0) hit points of a single ring, in orbit order (path for recording playback)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mapping")
+	TArray<FVector> GetRingPathPoints(int32 RingIndex) const;
 	
 	// ===== Data Access =====
 	
 	/**
-	 * Array of hit point positions from orbital mapping
-	 * These points form the path for recording camera playback
+	 * Voxel-averaged hit points (see StartDownsample) - one per occupied voxel
 	 */
 	UPROPERTY(BlueprintReadOnly, Category = "Mapping|Data")
-	TArray<FVector> MappingHitPoints;
+	TArray<FVector> DownsampledPoints;
+	
+	/**
+	 * Number of hit points merged into each downsampled point (parallel to DownsampledPoints)
+	 */
+	UPROPERTY(BlueprintReadOnly, Category = "Mapping|Data")
+	TArray<int32> DownsampledCounts;
+	
+	/**
+	 * Ring index of each downsampled point - ring of the first hit in its voxel (parallel to DownsampledPoints)
+	 */
+	UPROPERTY(BlueprintReadOnly, Category = "Mapping|Data")
+	TArray<int32> DownsampledRingIndices;
 	
 	// ===== Events =====
 	
@@ -130,14 +515,22 @@ public:
 	
 	UPROPERTY(BlueprintAssignable, Category = "Mapping|Events")
 	FOnMappingFailedSignature OnMappingFailed;
+	
+	UPROPERTY(BlueprintAssignable, Category = "Mapping|Events")
+	FOnDownsampleCompleteSignature OnDownsampleComplete;
+	
+	UPROPERTY(BlueprintAssignable, Category = "Mapping|Events")
+	FOnNormalsEstimatedSignature OnNormalsEstimated;
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
 	// ===== State =====
 	
 	bool bIsMapping = false;
+	bool bIsPaused = false;
 	
 	UPROPERTY()
 	AActor* TargetActor = nullptr;
@@ -145,6 +538,45 @@ private:
 	UPROPERTY()
 	UNKLaserTracerComponent* LaserTracer = nullptr;
 	
+	UPROPERTY()
+	UNKScanStoreComponent* ScanStore = nullptr;
+	
+	UPROPERTY()
+	UNKDebugVisualizerComponent* DebugVisualizer = nullptr;
+	
+	/** Hashed grid over the store's positions - point i of the index is store point i (see SyncSpatialIndex) */
+	mutable FNKScanSpatialIndex SpatialIndex;
+	
+	/** Store revision the index was built against */
+	mutable uint32 IndexedPointRevision = 0;
+	mutable bool bSpatialIndexStale = true;
+	
+	/** Rebuild the index after the store reordered or dropped points, or append the points added since */
+	void SyncSpatialIndex() const;
+	
+	/** Create (and register) a store on the owner if none was set */
+	void EnsureScanStore();
+	
+	/** Bytes this mapper last added to STAT_NKScanner_MapperMemory */
+	int64 ReportedStatBytes = 0;
+	
+	/** Publish hit rate and buffer memory to the NKScanner stats group */
+	void UpdateScanStats();
+	
+	// ===== Downsample State =====
+	
+	bool bDownsampling = false;
+	
+	/** Bumped per request and per mapping start - results from an older request are dropped */
+	int32 DownsampleGeneration = 0;
+	
+	// ===== Normal Estimation State =====
+	
+	bool bEstimatingNormals = false;
+	
+	/** Bumped per request and whenever the hit points change - stale normals are dropped */
+	int32 NormalGeneration = 0;
+	
 	FVector OrbitCenter;
 	float OrbitRadius = 0.0f;
 	float ScanHeight = 0.0f;
@@ -154,6 +586,46 @@ private:
 	int32 ShotCount = 0;
 	int32 HitCount = 0;
 	
+	/** Number of shots needed for a full orbit (fixed at StartMapping) */
+	int32 TotalShots = 0;
+	
+	/** Last scan was adaptive - rescans refine their sectors the same way */
+	bool bAdaptiveScan = false;
+	
+	/** Spiral scan state: shots per revolution and the Z range climbed */
+	bool bSpiralScan = false;
+	int32 ShotsPerRevolution = 0;
+	float SpiralBottomZ = 0.0f;
+	float SpiralTopZ = 0.0f;
+	
+	/** Number of rings in the current/last scan */
+	int32 RingCount = 1;
+	
+	/** Next shot to submit in async mode (ShotCount trails it by the in-flight batch) */
+	int32 NextShotIndex = 0;
+	
+	/** Async rays in flight, in submission (= angle) order */
+	TArray<FNKPendingOrbitShot> PendingShots;
+	
+	/** Adaptive mode: every traced sample, and the open intervals (sample index pairs) as a stack */
+	TArray<FNKAdaptiveSample> AdaptiveSamples;
+	TArray<TPair<int32, int32>> AdaptiveStack;
+	int32 AdaptiveCoarseCount = 0;
+	int32 AdaptiveCoarseIndex = 0;
+	int32 AdaptivePreviousCoarseSample = INDEX_NONE;
+	
+	/** Z height of every ring in the current/last scan (ring index = array index) */
+	TArray<float> ScanRingHeights;
+	
+	/** Per-sector target geometry signatures captured when the last scan completed (empty = none) */
+	TArray<uint32> SectorSignatures;
+	
+	/** Pose of the most recent shot (used for throttled visual feedback) */
+	FVector LastShotOrigin = FVector::ZeroVector;
+	bool bHasPendingVisualFeedback = false;
+	float TimeSinceVisualFeedback = 0.0f;
+	
+	/** Fixed-timestep accumulator (only the remainder after due shots is carried over) */
 	float TimeSinceLastShot = 0.0f;
 	
 	// ===== Helper Methods =====
@@ -163,16 +635,127 @@ private:
 	 */
 	FVector CalculateOrbitPosition(float Angle) const;
 	
+	/**
+	 * Z height of a shot (ScanHeight, or the climbing spiral height)
+	 */
+	float GetShotHeight(int32 ShotIndex) const;
+	
+	/**
+	 * Ring a shot belongs to (spiral revolution, otherwise 0)
+	 */
+	int32 GetShotRingIndex(int32 ShotIndex) const;
+	
 	/**
 	 * Calculate rotation to look at target center
 	 */
 	FRotator CalculateLookAtRotation(const FVector& FromPosition, const FVector& ToPosition) const;
 	
 	/**
-	 * Perform one mapping step (move + shoot)
+	 * Perform one mapping step (schedule and fire every shot due this tick)
 	 */
 	void PerformMappingStep(float DeltaTime);
 	
+	/**
+	 * Fire the next shot for the current mapping mode
+	 */
+	void FireNextShot();
+	
+	/**
+	 * Fire a single orbit shot (move + shoot + record)
+	 * @param ShotIndex - Index of the shot in the orbit, determines its angle
+	 */
+	void FireOrbitShot(int32 ShotIndex);
+	
+	/**
+	 * Fire the next orbit/spiral shots as one traced batch (virtual pose only - the camera is never moved per shot)
+	 * Stops recording early if mapping completes or is stopped from an event handler
+	 * @return Number of shots recorded
+	 */
+	int32 FireOrbitShotBatch(int32 MaxShots);
+	
+	/** Whether shots can be traced in batches (virtual pose, orbit or spiral) */
+	bool CanBatchShots() const { return bVirtualPoseScanning && MappingMode != EMappingMode::Adaptive; }
+	
+	/**
+	 * Trace one orbit angle, either from the camera (moved there) or from the virtual pose
+	 * @param OutHits - First hit only, or every target layer when the tracer captures layers
+	 */
+	bool TraceOrbitAngle(float Angle, float Height, FVector& OutOrbitPosition, TArray<FHitResult>& OutHits);
+	
+	/**
+	 * Adaptive mode step: refine or emit one interval, or shoot the next coarse sample
+	 * @return true if a trace was fired
+	 */
+	bool PerformAdaptiveStep();
+	
+	/**
+	 * Adaptive mode: trace an angle and keep the sample
+	 * @return Index of the new sample
+	 */
+	int32 FireAdaptiveSample(float Angle);
+	
+	/**
+	 * Adaptive mode: whether the interval between two samples must be subdivided
+	 */
+	bool NeedsAdaptiveRefinement(const FNKAdaptiveSample& Left, const FNKAdaptiveSample& Right) const;
+	
+	/**
+	 * Batched adaptive sampling (ring scans and rescans): coarse samples over each flagged sector of every
+	 * ring in ScanRingHeights, bisected with the adaptive criteria one batch per subdivision level
+	 * @param SectorChanged - Per-sector flag (sectors split the orbit evenly from StartAngle)
+	 * @param OutHits - Target hits of every sample inside the flagged sectors, in ring and orbit order
+	 * @return Number of rays traced
+	 */
+	int32 TraceAdaptiveSectors(const TArray<bool>& SectorChanged, TArray<FNKScanHit>& OutHits);
+	
+	/**
+	 * Batched adaptive sampling: trace one batch of orbit angles (each at its ring's height) and append a sample per angle
+	 */
+	void TraceAdaptiveBatch(const TArray<float>& Angles, const TArray<int32>& Rings, TArray<FNKAdaptiveSample>& InOutSamples);
+	
+	/**
+	 * Trace a batch of orbit rays and append the target hits in ray order (every layer if the tracer captures layers)
+	 * Single hits go through the tracer's PerformTraces; layered rays run one per ParallelFor worker
+	 * @param OutRayHitCounts - Optional, target hits appended per ray
+	 * @return Number of target hits appended
+	 */
+	int32 TraceRayBatch(const FNKOrbitRayBatch& Rays, TArray<FNKScanHit>& OutHits, TArray<int32>* OutRayHitCounts = nullptr);
+	
+	/**
+	 * Convert the traced hits of one shot into target hits (layer index counts target surfaces only, in ray order)
+	 */
+	void CollectTargetHits(const TArray<FHitResult>& Hits, float Angle, float ShotHeight, int32 RingIndex, TArray<FNKScanHit>& OutTargetHits) const;
+	
+	/**
+	 * Async mode step: collect last frame's results in order, then submit the next batch
+	 */
+	void PerformAsyncMappingStep();
+	
+	/**
+	 * Record the result of one orbit shot (storage, debug, completion)
+	 */
+	void RecordShotResult(int32 ShotIndex, const FVector& OrbitPosition, TConstArrayView<FNKScanHit> TargetHits);
+	
+	/**
+	 * Store a hit on the target in the mapping output (with debug drawing)
+	 */
+	void StoreTargetHit(const FNKScanHit& Hit, const FVector& OrbitPosition);
+	
+	/**
+	 * Draw a point that stays until cleared (batched visualizer when set, persistent debug sphere otherwise)
+	 */
+	void DrawPersistentPoint(const FVector& Location, float Radius, FColor Color);
+	
+	/**
+	 * Append a hit to the scan store
+	 */
+	void AddMappingPoint(const FNKScanHit& Hit);
+	
+	/**
+	 * Move the camera to the latest shot pose, at most once per VisualFeedbackInterval
+	 */
+	void UpdateVisualFeedback(float DeltaTime);
+	
 	/**
 	 * Complete the mapping process
 	 */
@@ -94,6 +94,20 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recording Playback")
 	AActor* RecordingTargetActor;
 	
+	/**
+	 * Simplify the hit point ring (Douglas-Peucker) before playback
+	 * Flat faces otherwise add hundreds of collinear segments; the mapper keeps the original points
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recording Playback")
+	bool bSimplifyPlaybackPath = true;
+	
+	/**
+	 * Maximum distance (cm) a dropped hit point may lie from the simplified path
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recording Playback",
+		meta = (EditCondition = "bSimplifyPlaybackPath", EditConditionHides, ClampMin = "0.0"))
+	float PlaybackPathToleranceCm = 2.0f;
+	
 	// ===== Camera Settings (Applied During Recording Only) =====
 	
 	/**
@@ -183,12 +197,18 @@ public:
 	 */
 	UFUNCTION(BlueprintPure, Category = "Recording Playback")
 	bool IsPlaying() const { return bIsPlaying && !bIsPaused; }
+	
+	/**
+	 * Path vertices used for playback (simplified if bSimplifyPlaybackPath)
+	 */
+	UFUNCTION(BlueprintPure, Category = "Recording Playback")
+	const TArray<FVector>& GetPlaybackPathPoints() const { return MappingHitPoints; }
 
 private:
 	// ===== Data =====
 	
 	/**
-	 * Hit points from orbital mapping (circular orbit)
+	 * Hit points from orbital mapping (circular orbit) - simplified copy when bSimplifyPlaybackPath
 	 */
 	UPROPERTY()
 	TArray<FVector> MappingHitPoints;
@@ -221,6 +241,12 @@ private:
 	
 	// ===== Helper Methods =====
 	
+	/**
+	 * Douglas-Peucker simplification of a closed ring
+	 * @return Kept vertices, in ring order
+	 */
+	static TArray<FVector> SimplifyClosedPath(const TArray<FVector>& Points, float Tolerance);
+	
 	/**
 	 * Calculate total path length from hit points
 	 */
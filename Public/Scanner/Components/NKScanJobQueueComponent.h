@@ -0,0 +1,275 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Scanner/ScanDataStructures.h"
+#include "NKScanJobQueueComponent.generated.h"
+
+// Forward declarations
+class UNKOrbitMapperComponent;
+class UNKLaserTracerComponent;
+class UNKScanStoreComponent;
+
+/**
+ * Per-job completion callback (bound when the job is enqueued)
+ */
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FNKScanJobFinishedDelegate, int32, JobId, EScanJobState, FinalState);
+
+/**
+ * Delegate fired when a job finished mapping - its scan store holds the result
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnScanJobCompleteSignature, int32, JobId, UNKScanStoreComponent*, ScanStore);
+
+/**
+ * Delegate fired when a job failed (target never hit, target destroyed) or was cancelled
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnScanJobFailedSignature, int32, JobId, EScanJobState, FinalState);
+
+/**
+ * Delegate fired when the queue runs empty
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnScanJobsDrainedSignature);
+
+/**
+ * One target scanned by the job queue
+ * The mapper, tracer and store are created on the queue's owner when the job starts
+ */
+USTRUCT()
+struct FNKScanJob
+{
+	GENERATED_BODY()
+	
+	int32 JobId = INDEX_NONE;
+	EScanJobState State = EScanJobState::Queued;
+	
+	UPROPERTY()
+	TWeakObjectPtr<AActor> Target;
+	
+	UPROPERTY()
+	UNKOrbitMapperComponent* Mapper = nullptr;
+	
+	UPROPERTY()
+	UNKLaserTracerComponent* Tracer = nullptr;
+	
+	UPROPERTY()
+	UNKScanStoreComponent* ScanStore = nullptr;
+	
+	// Orbit derived from the target bounds when the job starts
+	FVector OrbitCenter = FVector::ZeroVector;
+	float OrbitRadius = 0.0f;
+	float ScanHeight = 0.0f;
+	
+	// Discovery sweep (virtual pose - the owner is never moved)
+	float DiscoveryStartAngle = 0.0f;
+	int32 DiscoveryShots = 0;
+	
+	/** Traces charged to this job so far (discovery + mapping) */
+	int32 TracesUsed = 0;
+	
+	FNKScanJobFinishedDelegate OnFinished;
+};
+
+/**
+ * Multi-target scan scheduler
+ *
+ * Accepts a list of targets and runs discovery and mapping for several of them at once from
+ * a single scanner. Every active job owns a virtual-pose mapper, a laser tracer configured for
+ * its target and a scan store; the queue ticks them itself, splitting one per-frame trace budget
+ * round-robin between the active jobs. The owning actor is never moved.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class TPCPP_API UNKScanJobQueueComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UNKScanJobQueueComponent();
+	
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	
+	// ===== Configuration =====
+	
+	/** Traces per frame shared by all active jobs (discovery and mapping shots alike) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs", meta = (ClampMin = "1", ClampMax = "100000"))
+	int32 TracesPerFrame = 256;
+	
+	/** Jobs discovering/mapping at the same time - the rest wait in the queue */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs", meta = (ClampMin = "1", ClampMax = "256"))
+	int32 MaxConcurrentJobs = 8;
+	
+	/** Distance kept between the orbit and the target's bounding sphere (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Orbit", meta = (ClampMin = "0.0"))
+	float OrbitClearance = 500.0f;
+	
+	/** Orbit height as a percentage of the target's bounds (0 = bottom, 100 = top) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Orbit", meta = (ClampMin = "0", ClampMax = "100"))
+	float HeightPercent = 50.0f;
+	
+	/** Angle between discovery shots while looking for the first hit */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Discovery", meta = (ClampMin = "0.1", ClampMax = "90.0"))
+	float DiscoveryStepDegrees = 5.0f;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Mapping")
+	EMappingMode MappingMode = EMappingMode::Orbit;
+	
+	/** Angular step of every job's mapper */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Mapping", meta = (ClampMin = "0.01", ClampMax = "90.0"))
+	float AngularStepDegrees = 1.0f;
+	
+	/** Spiral mode: height climbed per revolution (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Mapping",
+		meta = (ClampMin = "1.0", EditCondition = "MappingMode == EMappingMode::Spiral", EditConditionHides))
+	float SpiralPitch = 100.0f;
+	
+	/** Trace only each job's own target (no occlusion by other targets or the level) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Trace")
+	bool bTraceTargetOnly = false;
+	
+	/** Landscape targets intersect a sampled height grid instead of the physics scene (opt-in: no occluders, like target-only) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Trace")
+	bool bLandscapeHeightfieldTraces = false;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Trace")
+	bool bCaptureHitLayers = false;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Trace",
+		meta = (ClampMin = "1", ClampMax = "64", EditCondition = "bCaptureHitLayers", EditConditionHides))
+	int32 MaxHitLayers = 8;
+	
+	/** Estimate normals (worker threads) for every finished job */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Mapping")
+	bool bEstimateNormals = false;
+	
+	/** Draw lasers and hit points for every job (expensive with many jobs) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Jobs|Debug")
+	bool bDrawDebugVisuals = false;
+	
+	// ===== Public API =====
+	
+	/**
+	 * Queue one target
+	 * @param Target - Actor to discover and map
+	 * @param OnFinished - Called once when the job completes, fails or is cancelled (may be unbound)
+	 * @return Job id (INDEX_NONE if the target is invalid)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Scan Jobs")
+	int32 EnqueueScanJob(AActor* Target, FNKScanJobFinishedDelegate OnFinished);
+	
+	/**
+	 * Queue several targets (in order)
+	 * @return One job id per target (INDEX_NONE for invalid targets)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Scan Jobs")
+	TArray<int32> EnqueueScanJobs(const TArray<AActor*>& Targets);
+	
+	/**
+	 * Cancel a queued or running job (its scan store keeps the points recorded so far)
+	 * @return false if the job is unknown or already finished
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Scan Jobs")
+	bool CancelJob(int32 JobId);
+	
+	/** Cancel every queued and running job */
+	UFUNCTION(BlueprintCallable, Category = "Scan Jobs")
+	void CancelAllJobs();
+	
+	/**
+	 * Forget a finished job and destroy its mapper, tracer and scan store
+	 * @return false if the job is unknown or still queued/running
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Scan Jobs")
+	bool ReleaseJob(int32 JobId);
+	
+	// ===== Job Queries =====
+	
+	UFUNCTION(BlueprintPure, Category = "Scan Jobs")
+	EScanJobState GetJobState(int32 JobId) const;
+	
+	/** Scan store of a job (nullptr until the job has started) */
+	UFUNCTION(BlueprintPure, Category = "Scan Jobs")
+	UNKScanStoreComponent* GetJobScanStore(int32 JobId) const;
+	
+	/** Mapper of a job - hit arrays, spatial queries, downsampling (nullptr until the job has started) */
+	UFUNCTION(BlueprintPure, Category = "Scan Jobs")
+	UNKOrbitMapperComponent* GetJobMapper(int32 JobId) const;
+	
+	/** Mapping progress of a job (0-100, 100 once complete) */
+	UFUNCTION(BlueprintPure, Category = "Scan Jobs")
+	float GetJobProgress(int32 JobId) const;
+	
+	/** Traces spent on a job so far */
+	UFUNCTION(BlueprintPure, Category = "Scan Jobs")
+	int32 GetJobTraceCount(int32 JobId) const;
+	
+	UFUNCTION(BlueprintPure, Category = "Scan Jobs")
+	int32 GetQueuedJobCount() const;
+	
+	UFUNCTION(BlueprintPure, Category = "Scan Jobs")
+	int32 GetActiveJobCount() const;
+	
+	/** Traces spent by all jobs in the last frame */
+	UFUNCTION(BlueprintPure, Category = "Scan Jobs")
+	int32 GetLastFrameTraceCount() const { return LastFrameTraceCount; }
+	
+	// ===== Events =====
+	
+	UPROPERTY(BlueprintAssignable, Category = "Scan Jobs|Events")
+	FOnScanJobCompleteSignature OnJobComplete;
+	
+	UPROPERTY(BlueprintAssignable, Category = "Scan Jobs|Events")
+	FOnScanJobFailedSignature OnJobFailed;
+	
+	UPROPERTY(BlueprintAssignable, Category = "Scan Jobs|Events")
+	FOnScanJobsDrainedSignature OnAllJobsFinished;
+
+private:
+	/** Every job not released yet, in enqueue order (queued jobs start in this order) */
+	UPROPERTY()
+	TArray<FNKScanJob> Jobs;
+	
+	int32 NextJobId = 0;
+	
+	/** Round-robin start position so no job always gets the budget first */
+	int32 ScheduleCursor = 0;
+	
+	int32 LastFrameTraceCount = 0;
+	
+	/** Jobs finished since the last broadcast (events are deferred so handlers can modify the queue) */
+	TArray<int32> FinishedJobIds;
+	
+	// ===== Internal Methods =====
+	
+	FNKScanJob* FindJob(int32 JobId);
+	const FNKScanJob* FindJob(int32 JobId) const;
+	
+	/** Start queued jobs until MaxConcurrentJobs are running */
+	void StartQueuedJobs();
+	
+	/** Create the job's components and derive its orbit from the target bounds */
+	bool StartJob(FNKScanJob& Job);
+	
+	/**
+	 * Spend up to MaxTraces on a job (discovery shots, then mapping shots)
+	 * @return Traces actually used
+	 */
+	int32 StepJob(FNKScanJob& Job, int32 MaxTraces);
+	
+	/**
+	 * Discovery: one virtual-pose shot per step around the orbit until the target is hit
+	 * @return Traces used
+	 */
+	int32 StepDiscovery(FNKScanJob& Job, int32 MaxTraces);
+	
+	/** Move a job to a final state and stop its mapper (events follow in BroadcastFinishedJobs) */
+	void FinishJob(FNKScanJob& Job, EScanJobState FinalState);
+	
+	/** Fire the events of finished jobs, then stop ticking if nothing is left */
+	void BroadcastFinishedJobs();
+	
+	static bool IsJobActive(const FNKScanJob& Job)
+	{
+		return Job.State == EScanJobState::Discovering || Job.State == EScanJobState::Mapping;
+	}
+};
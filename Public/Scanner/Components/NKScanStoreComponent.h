@@ -0,0 +1,218 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Scanner/Interfaces/INKTerrainMapperInterface.h"
+#include "Scanner/ScanDataStructures.h"
+#include "Scanner/Utilities/NKScanFile.h"
+#include "NKScanStoreComponent.generated.h"
+
+// Forward declarations
+class UNKOrbitMapperComponent;
+
+/**
+ * Scan point store (structure of arrays)
+ *
+ * Every attribute lives in its own tightly packed array so passes over one attribute
+ * (positions for a spatial query, normals for shading) stay cache friendly. Per-point cost
+ * is 49 bytes instead of a full FScanDataPoint; actor/component identity is interned into
+ * a small source table. Capacity is reserved up front from the mapper's expected shot count.
+ *
+ * Implements INKTerrainMapperInterface on top of the sibling UNKOrbitMapperComponent,
+ * which feeds it every target hit while mapping.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class TPCPP_API UNKScanStoreComponent : public UActorComponent, public INKTerrainMapperInterface
+{
+	GENERATED_BODY()
+
+public:
+	UNKScanStoreComponent();
+	
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	
+	// ===== Configuration =====
+	
+	/** Target used when mapping is started through the interface */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scan Store")
+	AActor* TargetActor = nullptr;
+	
+	/**
+	 * Bind the store to a specific mapper (owners with several mappers, e.g. scan jobs)
+	 * nullptr = the first UNKOrbitMapperComponent on the owner
+	 */
+	void SetMapper(UNKOrbitMapperComponent* InMapper) { BoundMapper = InMapper; }
+	
+	// ===== INKTerrainMapperInterface Implementation =====
+	
+	virtual void StartMapping(float StartAngle, float OrbitRadius, float ScanHeight) override;
+	virtual void StopMapping() override;
+	virtual void PauseMapping() override;
+	virtual void ResumeMapping() override;
+	
+	virtual bool IsMapping() const override;
+	virtual bool IsPaused() const override;
+	virtual int32 GetRecordedPointCount() const override { return GetPointCount(); }
+	virtual float GetCurrentOrbitAngle() const override;
+	virtual float GetMappingProgress() const override;
+	virtual float GetElapsedTime() const override;
+	
+	/** Materializes FScanDataPoint rows on first access after a change (prefer the SoA accessors) */
+	virtual const TArray<FScanDataPoint>& GetScanData() const override;
+	virtual void ClearScanData() override;
+	
+	/** Streamed token by token through TJsonWriter/TJsonReader - no JSON DOM, one row of numbers per point */
+	virtual bool SaveToJSON(const FString& FilePath) override;
+	virtual bool LoadFromJSON(const FString& FilePath) override;
+	
+	// ===== Binary Persistence =====
+	
+	/**
+	 * Save the scan as a binary container (see NKScanFile.h)
+	 * @param FilePath - Full path to the output .nkscan file
+	 * @return true if save succeeded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Scan Store")
+	bool SaveToBinary(const FString& FilePath);
+	
+	/**
+	 * Open a binary container through memory mapping - point data is used in place, not copied
+	 * The mapping is dropped (and data copied) only when the scan is modified
+	 * @param FilePath - Full path to the .nkscan file
+	 * @return true if the file was mapped and valid
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Scan Store")
+	bool LoadFromBinary(const FString& FilePath);
+	
+	/** Is the point data currently served from a mapped file? */
+	UFUNCTION(BlueprintPure, Category = "Scan Store")
+	bool IsMemoryMapped() const { return MappedFile.IsValid(); }
+	
+	virtual FOnMappingComplete& GetOnMappingCompleteEvent() override { return OnScanComplete; }
+	virtual FOnMappingProgress& GetOnMappingProgressEvent() override { return OnScanProgress; }
+	
+	// ===== Recording (called by the mapper) =====
+	
+	/**
+	 * Clear the store and reserve capacity for a new scan
+	 * @param ExpectedPoints - Expected number of points (e.g. shot count) - reserved up front
+	 */
+	void BeginScan(int32 ExpectedPoints);
+	
+	/** Append one target hit */
+	void AddPoint(const FNKScanHit& Hit);
+	
+	/**
+	 * Remove points in place, keeping order
+	 * @param ShouldKeep - Called with each point index, returns false to drop the point
+	 */
+	void CompactPoints(TFunctionRef<bool(int32)> ShouldKeep);
+	
+	/** Sort points by (ring, angle, layer) - stable */
+	void SortPoints();
+	
+	/**
+	 * Replace every point normal (e.g. with estimated ones)
+	 * @return False (and nothing changed) if the count does not match the point count
+	 */
+	bool SetNormals(TConstArrayView<FVector> NewNormals);
+	
+	/** Broadcast a progress update */
+	void NotifyProgress(float ProgressPercent);
+	
+	/** Mark the scan finished and broadcast completion */
+	void NotifyScanComplete();
+	
+	// ===== Point Access =====
+	
+	UFUNCTION(BlueprintPure, Category = "Scan Store")
+	int32 GetPointCount() const { return MappedFile ? MappedFile->GetPointCount() : Positions.Num(); }
+	
+	/** Single point as an FScanDataPoint (no cache involved) */
+	UFUNCTION(BlueprintPure, Category = "Scan Store")
+	FScanDataPoint GetPoint(int32 PointIndex) const;
+	
+	// Attribute streams - views into the owned arrays or the mapped file (invalidated by any modification)
+	TConstArrayView<FVector3f> GetPositions() const { return MappedFile ? MappedFile->GetPositions() : TConstArrayView<FVector3f>(Positions); }
+	TConstArrayView<FVector3f> GetNormals() const { return MappedFile ? MappedFile->GetNormals() : TConstArrayView<FVector3f>(Normals); }
+	TConstArrayView<float> GetAngles() const { return MappedFile ? MappedFile->GetAngles() : TConstArrayView<float>(Angles); }
+	TConstArrayView<float> GetScanHeights() const { return MappedFile ? MappedFile->GetScanHeights() : TConstArrayView<float>(ScanHeights); }
+	TConstArrayView<float> GetDistances() const { return MappedFile ? MappedFile->GetDistances() : TConstArrayView<float>(Distances); }
+	TConstArrayView<float> GetTimestamps() const { return MappedFile ? MappedFile->GetTimestamps() : TConstArrayView<float>(Timestamps); }
+	TConstArrayView<int32> GetRingIndices() const { return MappedFile ? MappedFile->GetRingIndices() : TConstArrayView<int32>(RingIndices); }
+	TConstArrayView<uint8> GetLayerIndices() const { return MappedFile ? MappedFile->GetLayerIndices() : TConstArrayView<uint8>(LayerIndices); }
+	TConstArrayView<int32> GetSourceIndices() const { return MappedFile ? MappedFile->GetSourceIndices() : TConstArrayView<int32>(SourceIndices); }
+	const TArray<FNKScanSource>& GetSources() const { return Sources; }
+	
+	/**
+	 * Changes whenever existing point indices stop being valid (clear, load, compaction, sorting)
+	 * Appends keep it - data derived per point index (e.g. a spatial index) only needs the new tail
+	 */
+	uint32 GetPointRevision() const { return PointRevision; }
+	
+	/** Approximate memory held by the point arrays and source table (bytes, allocated capacity - mapped files not counted) */
+	UFUNCTION(BlueprintPure, Category = "Scan Store")
+	int64 GetAllocatedBytes() const;
+	
+	// ===== Events =====
+	
+	UPROPERTY(BlueprintAssignable, Category = "Scan Store|Events")
+	FOnMappingComplete OnScanComplete;
+	
+	UPROPERTY(BlueprintAssignable, Category = "Scan Store|Events")
+	FOnMappingProgress OnScanProgress;
+
+private:
+	/** Bound mapper, or the sibling mapper found on the owner */
+	UNKOrbitMapperComponent* GetMapper() const;
+	
+	UPROPERTY()
+	UNKOrbitMapperComponent* BoundMapper = nullptr;
+	
+	/** Index of a component in the source table (added on first use) */
+	int32 InternSource(const UPrimitiveComponent* Component);
+	
+	/** Copy mapped point data into the owned arrays and release the file (before any modification) */
+	void DetachMappedFile();
+	
+	/** Bytes this store last added to STAT_NKScanner_StoreMemory */
+	int64 ReportedStatBytes = 0;
+	
+	/** Move the shared store memory stat to this store's current size */
+	void UpdateMemoryStat();
+	
+	// ===== Point Arrays (parallel) =====
+	
+	TArray<FVector3f> Positions;
+	TArray<FVector3f> Normals;
+	TArray<float> Angles;
+	TArray<float> ScanHeights;
+	TArray<float> Distances;
+	TArray<float> Timestamps;  // Seconds since BeginScan
+	TArray<int32> RingIndices;
+	TArray<uint8> LayerIndices;
+	TArray<int32> SourceIndices;  // INDEX_NONE = unknown source
+	
+	/** Set while point data is served from a mapped .nkscan file (the arrays above are then empty) */
+	TUniquePtr<FNKMappedScanFile> MappedFile;
+	
+	/** See GetPointRevision */
+	uint32 PointRevision = 0;
+	
+	// ===== Source Table =====
+	
+	TArray<FNKScanSource> Sources;
+	TMap<TObjectKey<UPrimitiveComponent>, int32> SourceLookup;
+	
+	// ===== Timing =====
+	
+	double ScanStartTime = -1.0;
+	double ScanEndTime = -1.0;
+	
+	// ===== Materialized View (GetScanData) =====
+	
+	mutable TArray<FScanDataPoint> ScanDataCache;
+	mutable bool bScanDataCacheValid = false;
+};
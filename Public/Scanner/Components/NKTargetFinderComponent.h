@@ -4,16 +4,20 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "WorldCollision.h"
 #include "Scanner/Interfaces/INKTargetFinderInterface.h"
+#include "Scanner/ScanDataStructures.h"
 #include "NKTargetFinderComponent.generated.h"
 
 // Forward declarations
 class INKLaserTracerInterface;
 class INKCameraControllerInterface;
+class UNKLaserTracerComponent;
 
 /**
  * Target discovery component
  * Rotates camera in place and finds first hit on target
+ * (or traces the whole sweep in one batch with the fan-out strategy)
  */
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class TPCPP_API UNKTargetFinderComponent : public UActorComponent, public INKTargetFinderInterface
@@ -53,6 +57,19 @@ public:
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Discovery")
 	float ShotInterval = 0.1f;  // Time between shots in seconds (100ms)
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Discovery")
+	EDiscoveryStrategy DiscoveryStrategy = EDiscoveryStrategy::Sweep;
+	
+	/** Trace budget for analytic acquisition before falling back to the sweep */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Discovery",
+		meta = (ClampMin = "1", ClampMax = "256", EditCondition = "DiscoveryStrategy == EDiscoveryStrategy::Analytic", EditConditionHides))
+	int32 MaxAcquisitionTraces = 15;
+	
+	/** Fan-out: submit the batch to the async scene query pipeline and collect it next frame (World scope only) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Discovery",
+		meta = (EditCondition = "DiscoveryStrategy == EDiscoveryStrategy::FanOut", EditConditionHides))
+	bool bFanOutAsyncTraces = false;
 
 private:
 	// ===== Internal Methods =====
@@ -61,6 +78,44 @@ private:
 	void PositionCameraAtStart();
 	void RotateCameraToAngle(float Angle);
 	
+	/**
+	 * Analytic acquisition: shoot into the yaw interval covered by the target bounds,
+	 * bisecting on misses, all in the current frame
+	 * @return true if the target was found (discovery is then complete)
+	 */
+	bool PerformAnalyticAcquisition();
+	
+	/**
+	 * Compute the yaw interval (degrees) the target bounds cover as seen from a position
+	 * @return false if the position is inside the bounds footprint (whole circle)
+	 */
+	bool CalculateTargetYawInterval(const FVector& FromPosition, float& OutMinYaw, float& OutMaxYaw) const;
+	
+	/**
+	 * Fan-out discovery: trace every sweep angle at once (ParallelFor, or async scene queries)
+	 * @return false if the batch could not be traced (discovery then continues as a sweep)
+	 */
+	bool StartFanOutDiscovery();
+	
+	/**
+	 * Collect the async fan-out batch in sweep order and resolve discovery once the first target hit is known
+	 */
+	void CollectFanOutTraces();
+	
+	/**
+	 * Resolve a fan-out batch: complete with the first target hit or fail
+	 * @param HitIndex - Index of the first ray (in sweep order) that hit the target, INDEX_NONE if none did
+	 */
+	void FinishFanOutDiscovery(int32 HitIndex, const FHitResult& HitResult);
+	
+	/** Ray direction of the sweep shot at an angle (camera rotates in place, yaw only) */
+	static FVector GetSweepDirection(float Angle) { return FRotator(0.0f, Angle, 0.0f).Vector(); }
+	
+	/**
+	 * Record the first hit on the target, broadcast OnTargetFound and stop discovery
+	 */
+	void CompleteWithTargetHit(const FHitResult& HitResult);
+	
 	// ===== State =====
 	
 	bool bIsDiscovering;
@@ -73,6 +128,11 @@ private:
 	// Shot timing
 	float TimeAccumulator;
 	
+	// Async fan-out batch (one handle per sweep angle, empty when no batch is pending)
+	TArray<FTraceHandle> FanOutHandles;
+	FVector FanOutOrigin;
+	int32 FanOutRayCount;
+	
 	// Discovery parameters
 	UPROPERTY()
 	AActor* TargetActor;
@@ -94,4 +154,8 @@ private:
 	
 	INKLaserTracerInterface* LaserTracer;
 	INKCameraControllerInterface* CameraController;
+	
+	/** Concrete tracer for batched traces (fan-out needs the concurrent and async APIs) */
+	UPROPERTY()
+	UNKLaserTracerComponent* BatchTracer;
 };
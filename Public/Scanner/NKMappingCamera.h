@@ -13,6 +13,9 @@ class UNKLaserTracerComponent;
 class UNKCameraControllerComponent;
 class UNKOrbitMapperComponent;
 class UNKRecordingCameraComponent;
+class UNKScanStoreComponent;
+class UNKScanJobQueueComponent;
+class UNKDebugVisualizerComponent;
 class ANKOverheadCamera;
 
 // Scanner state
@@ -59,6 +62,9 @@ struct FDiscoveryConfiguration
 	UPROPERTY()
 	bool bUseComplexCollision = true;
 	
+	UPROPERTY()
+	ETraceScope TraceScope = ETraceScope::World;
+	
 	UPROPERTY()
 	float MaxTraceRange = 100000.0f;
 	
@@ -143,6 +149,46 @@ public:
 		meta = (EditCondition = "bSpawnOverheadCamera", EditConditionHides))
 	float OverheadCameraHeightMeters = 100.0f;
 	
+	// ===== Trace Settings =====
+	
+	/**
+	 * Trace only the target's own components instead of the world (no occlusion by other actors,
+	 * cheaper in cluttered levels). Async mapping traces fall back to sync in this mode.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Trace")
+	bool bTraceTargetOnly = false;
+	
+	/**
+	 * Landscape targets: intersect a height grid sampled from the landscape instead of tracing the
+	 * physics scene. Like target-only tracing, other actors (foliage, buildings) neither occlude nor get hit,
+	 * so it is opt-in and overrides bTraceTargetOnly for landscapes.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Trace")
+	bool bLandscapeHeightfieldTraces = false;
+	
+	/** Record every target surface each mapping ray crosses (thin/nested geometry) instead of the first one */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Trace")
+	bool bCaptureHitLayers = false;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Trace",
+		meta = (ClampMin = "1", ClampMax = "64", EditCondition = "bCaptureHitLayers", EditConditionHides))
+	int32 MaxHitLayers = 8;
+	
+	/** Reuse trace results while the target is unchanged (repeat discovery/mapping runs of static targets) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Trace")
+	bool bUseTraceCache = false;
+	
+	// ===== Discovery Settings =====
+	
+	/** Sweep rotates until the target is hit; Analytic aims at the target bounds and finishes in a few traces; FanOut traces the whole sweep in one batch */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Discovery")
+	EDiscoveryStrategy DiscoveryStrategy = EDiscoveryStrategy::Sweep;
+	
+	/** Fan-out: collect the batch from async scene queries next frame instead of tracing it on worker threads */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Discovery",
+		meta = (EditCondition = "DiscoveryStrategy == EDiscoveryStrategy::FanOut", EditConditionHides))
+	bool bFanOutAsyncTraces = false;
+	
 	// ===== Mapping Settings =====
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping")
@@ -152,6 +198,22 @@ public:
 		meta = (ClampMin = "0.1", ClampMax = "50.0"))
 	float OrbitStepSizeMeters = 10.0f;
 	
+	/** Spiral mode: height climbed per revolution (vertical spacing of the helix) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping",
+		meta = (ClampMin = "0.01", ClampMax = "100.0", EditCondition = "MappingMode == EMappingMode::Spiral", EditConditionHides))
+	float SpiralPitchMeters = 1.0f;
+	
+	/**
+	 * Scan several stacked rings between the target's bottom and top in one job (rings traced in parallel)
+	 * Ignored in Spiral mode - the helix already covers the full height. In Adaptive mode every ring is refined adaptively.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping")
+	bool bStackedRingMapping = false;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping",
+		meta = (ClampMin = "1", ClampMax = "256", EditCondition = "bStackedRingMapping", EditConditionHides))
+	int32 StackedRingCount = 8;
+	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping")
 	EOrbitDirection OrbitDirection = EOrbitDirection::CounterClockwise;
 	
@@ -162,6 +224,32 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping")
 	FLinearColor OrbitLaserColor = FLinearColor::Blue;
 	
+	/** Fire as many orbit shots per tick as MappingBurstBudgetMs allows (headless/offline scans) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping")
+	bool bBurstMapping = false;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping",
+		meta = (ClampMin = "0.1", ClampMax = "1000.0", EditCondition = "bBurstMapping", EditConditionHides))
+	float MappingBurstBudgetMs = 4.0f;
+	
+	/** Submit orbit rays in batches through async scene queries (collected next frame, no game-thread hitching) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping")
+	bool bAsyncMappingTraces = false;
+	
+	/** Compute orbit rays analytically instead of moving the camera for every shot */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping")
+	bool bVirtualPoseMapping = false;
+	
+	/** Seconds between camera moves for visual feedback in virtual-pose/async mapping (0 = camera stays put) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Mapping", meta = (ClampMin = "0.0"))
+	float MappingVisualFeedbackInterval = 0.1f;
+	
+	// ===== Debug =====
+	
+	/** Draw lasers and mapping hit points (disable for benchmarks and long headless scans) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Scanner Settings|Debug")
+	bool bDrawDebugVisuals = true;
+	
 	// ===== High-Level Control =====
 	
 	/**
@@ -182,12 +270,32 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Scanner")
 	void StartMapping();
 	
+	/**
+	 * Rescan only the sectors of the target that changed since mapping completed (Complete state only)
+	 * Splices fresh points into the mapping output instead of rerunning discovery and a full orbit
+	 * @return Number of sectors rescanned
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Scanner")
+	int32 RescanChangedSectors();
+	
 	/**
 	 * Clear discovery laser lines
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Scanner")
 	void ClearDiscoveryLines();
 	
+	/**
+	 * Queue several targets for concurrent discovery + mapping (independent of the single-target state machine)
+	 * Applies this camera's trace and mapping settings to the job queue first
+	 * @return One job id per target (see GetScanJobQueue for state, stores and events)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Scanner|Jobs")
+	TArray<int32> EnqueueScanJobs(const TArray<AActor*>& Targets);
+	
+	/** Multi-target job queue (per-job scan stores and completion events) */
+	UFUNCTION(BlueprintPure, Category = "Scanner|Jobs")
+	UNKScanJobQueueComponent* GetScanJobQueue() const { return ScanJobQueueComponent; }
+	
 	// ===== State Queries =====
 	
 	UFUNCTION(BlueprintPure, Category = "Scanner|State")
@@ -219,6 +327,10 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Scanner|Mapping")
 	int32 GetMappingHitCount() const;
 	
+	/** Full scan record (positions, normals, distances, sources) of the last mapping */
+	UFUNCTION(BlueprintPure, Category = "Scanner|Mapping")
+	UNKScanStoreComponent* GetScanStore() const { return ScanStoreComponent; }
+	
 	// ===== First Hit Data (Available after Discovered state) =====
 	
 	UFUNCTION(BlueprintPure, Category = "Scanner|Discovery")
@@ -288,6 +400,15 @@ private:
 	UPROPERTY()
 	UNKRecordingCameraComponent* RecordingCameraComponent;  // Recording playback
 	
+	UPROPERTY()
+	UNKScanStoreComponent* ScanStoreComponent;  // Scan point storage
+	
+	UPROPERTY()
+	UNKScanJobQueueComponent* ScanJobQueueComponent;  // Multi-target scan jobs
+	
+	UPROPERTY()
+	UNKDebugVisualizerComponent* DebugVisualizerComponent;  // Batched scan points and lines
+	
 	UPROPERTY()
 	ANKOverheadCamera* OverheadCameraActor;  // Spawned overhead camera
 	
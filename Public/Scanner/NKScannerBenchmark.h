@@ -0,0 +1,286 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Scanner/ScanDataStructures.h"
+#include "NKScannerBenchmark.generated.h"
+
+// Forward declarations
+class ANKMappingCamera;
+class UStaticMesh;
+
+/**
+ * One scanner configuration run against every benchmark target
+ */
+USTRUCT(BlueprintType)
+struct FNKScannerBenchmarkCase
+{
+	GENERATED_BODY()
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark")
+	FString Name;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark")
+	EMappingMode MappingMode = EMappingMode::Orbit;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark", meta = (ClampMin = "0.01", ClampMax = "90.0"))
+	float AngularStepDegrees = 1.0f;
+	
+	/** Stacked rings between the target's bottom and top (0 = single ring; ignored in spiral mode) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark", meta = (ClampMin = "0", ClampMax = "256"))
+	int32 StackedRingCount = 0;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark")
+	bool bVirtualPose = true;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark")
+	bool bAsyncTraces = false;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark")
+	bool bTraceTargetOnly = false;
+	
+	/** Landscape targets trace their sampled height grid instead of the physics scene */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark")
+	bool bLandscapeHeightfield = false;
+};
+
+/**
+ * Measurements of one case against one target
+ */
+USTRUCT(BlueprintType)
+struct FNKScannerBenchmarkResult
+{
+	GENERATED_BODY()
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	FString TargetName;
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	FNKScannerBenchmarkCase Case;
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	bool bSucceeded = false;
+	
+	/** Why the run did not complete (empty on success) */
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	FString FailureReason;
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	int32 DiscoveryShots = 0;
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	double DiscoverySeconds = 0.0;
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	int32 MappingShots = 0;
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	int32 MappingHits = 0;
+	
+	/** Wall-clock time from StartMapping until the scanner reported Complete */
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	double MappingSeconds = 0.0;
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	double ShotsPerSecond = 0.0;
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	double MsPerShot = 0.0;
+	
+	/** Hits / shots (0-1) */
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	double HitRate = 0.0;
+	
+	/** Scan store memory after mapping */
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	int64 StoreBytes = 0;
+	
+	/** Highest process physical memory sampled while the run was active */
+	UPROPERTY(BlueprintReadOnly, Category = "Benchmark")
+	int64 PeakUsedPhysicalBytes = 0;
+};
+
+/** Where the benchmark is within the current run */
+enum class ENKBenchmarkPhase : uint8
+{
+	Idle,
+	Discovering,
+	Mapping
+};
+
+/**
+ * Delegate fired when every run finished and the report was written (empty path if writing failed)
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnScannerBenchmarkFinishedSignature, const FString&, ReportPath);
+
+/**
+ * Headless scanner throughput benchmark
+ *
+ * Spawns reference targets (cube, dense static mesh, optional landscape tile), then runs a fresh
+ * ANKMappingCamera through discovery and mapping for every case x target pair, one run at a time.
+ * Shots/sec, ms per shot, hit rate and peak memory are written as a JSON report to
+ * Saved/Benchmarks (or ReportDirectory).
+ *
+ * Headless usage: place the actor in an empty map with bQuitWhenFinished, then run
+ *   UnrealEditor-Cmd <Project>.uproject <Map> -game -nullrhi -unattended -nosplash
+ * or as the automation test TPCPP.Scanner.Benchmark (-ExecCmds="Automation RunTests TPCPP.Scanner.Benchmark").
+ */
+UCLASS()
+class TPCPP_API ANKScannerBenchmark : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ANKScannerBenchmark();
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaTime) override;
+
+public:
+	// ===== Run Control =====
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark")
+	bool bRunOnBeginPlay = true;
+	
+	/** Request engine exit once the report is written (headless runs) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark")
+	bool bQuitWhenFinished = false;
+	
+	/** A run still going after this long is stopped and reported as failed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark", meta = (ClampMin = "1.0"))
+	float RunTimeoutSeconds = 300.0f;
+	
+	/** Report folder (empty = Saved/Benchmarks) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark")
+	FString ReportDirectory;
+	
+	// ===== Targets =====
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Targets")
+	bool bSpawnCubeTarget = true;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Targets",
+		meta = (EditCondition = "bSpawnCubeTarget", EditConditionHides))
+	TSoftObjectPtr<UStaticMesh> CubeMesh;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Targets")
+	bool bSpawnDenseMeshTarget = true;
+	
+	/** High triangle count mesh (complex collision traces dominate) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Targets",
+		meta = (EditCondition = "bSpawnDenseMeshTarget", EditConditionHides))
+	TSoftObjectPtr<UStaticMesh> DenseMesh;
+	
+	/** Uniform scale of the spawned meshes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Targets", meta = (ClampMin = "0.01"))
+	float TargetScale = 5.0f;
+	
+	/** Landscape tile placed in the benchmark map (landscapes cannot be created at runtime) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Targets")
+	AActor* LandscapeTarget = nullptr;
+	
+	/** Any other level actors to benchmark */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Targets")
+	TArray<AActor*> AdditionalTargets;
+	
+	/** Distance between spawned targets so they never occlude each other's orbits */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Targets", meta = (ClampMin = "10.0"))
+	float TargetSpacingMeters = 200.0f;
+	
+	// ===== Scanner Settings =====
+	
+	/** Cases run in order against every target */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Scanner")
+	TArray<FNKScannerBenchmarkCase> Cases;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Scanner")
+	EDiscoveryStrategy DiscoveryStrategy = EDiscoveryStrategy::Analytic;
+	
+	/** Clearance between the orbit and the target's bounding sphere */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Scanner", meta = (ClampMin = "1.0"))
+	float DistanceMeters = 10.0f;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Scanner", meta = (ClampMin = "0", ClampMax = "100"))
+	float HeightPercent = 50.0f;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Scanner", meta = (ClampMin = "0.01", ClampMax = "100.0"))
+	float SpiralPitchMeters = 0.5f;
+	
+	/** Mapping runs in burst mode - shots per frame are bounded by this budget, not by ShotDelay */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Benchmark|Scanner", meta = (ClampMin = "0.1", ClampMax = "1000.0"))
+	float MappingBurstBudgetMs = 16.0f;
+	
+	// ===== Public API =====
+	
+	/** Spawn the targets and start the first run (no-op while running) */
+	UFUNCTION(BlueprintCallable, Category = "Benchmark")
+	void StartBenchmark();
+	
+	/** Stop the current run and write a report of the runs finished so far */
+	UFUNCTION(BlueprintCallable, Category = "Benchmark")
+	void StopBenchmark();
+	
+	UFUNCTION(BlueprintPure, Category = "Benchmark")
+	bool IsRunning() const { return Phase != ENKBenchmarkPhase::Idle; }
+	
+	UFUNCTION(BlueprintPure, Category = "Benchmark")
+	TArray<FNKScannerBenchmarkResult> GetResults() const { return Results; }
+	
+	UFUNCTION(BlueprintPure, Category = "Benchmark")
+	FString GetLastReportPath() const { return LastReportPath; }
+	
+	// ===== Events =====
+	
+	UPROPERTY(BlueprintAssignable, Category = "Benchmark|Events")
+	FOnScannerBenchmarkFinishedSignature OnBenchmarkFinished;
+
+private:
+	ENKBenchmarkPhase Phase = ENKBenchmarkPhase::Idle;
+	
+	/** Every target of the current benchmark (spawned and level-placed) */
+	UPROPERTY()
+	TArray<AActor*> Targets;
+	
+	/** Targets spawned by the benchmark - destroyed when it finishes */
+	UPROPERTY()
+	TArray<AActor*> SpawnedTargets;
+	
+	/** Scanner of the current run (a fresh one per run so no state carries over) */
+	UPROPERTY()
+	ANKMappingCamera* RunCamera = nullptr;
+	
+	TArray<FNKScannerBenchmarkResult> Results;
+	
+	/** Current run = RunIndex / Cases.Num() target, RunIndex % Cases.Num() case */
+	int32 RunIndex = 0;
+	
+	double RunStartTime = 0.0;
+	double PhaseStartTime = 0.0;
+	FNKScannerBenchmarkResult CurrentResult;
+	
+	FString LastReportPath;
+	
+	// ===== Internal Methods =====
+	
+	/** Default case matrix: step sizes and mapping modes */
+	static TArray<FNKScannerBenchmarkCase> MakeDefaultCases();
+	
+	void SpawnTargets();
+	
+	AActor* SpawnMeshTarget(const TSoftObjectPtr<UStaticMesh>& Mesh, const FVector& Location);
+	
+	/** Spawn the scanner for RunIndex and start discovery (finishes the benchmark when no run is left) */
+	void StartNextRun();
+	
+	/** Record the current run and destroy its scanner */
+	void FinishRun(const FString& FailureReason);
+	
+	void FinishBenchmark();
+	
+	/** @return Report path (empty on failure) */
+	FString WriteReport() const;
+};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/HitResult.h"
 #include "ScanDataStructures.generated.h"
 
 /**
@@ -12,7 +13,41 @@ UENUM(BlueprintType)
 enum class EMappingMode : uint8
 {
 	Orbit UMETA(DisplayName = "Orbit"),
-	// Future: Grid, Adaptive, Spiral
+	Adaptive UMETA(DisplayName = "Adaptive"),
+	Spiral UMETA(DisplayName = "Spiral"),
+	// Future: Grid
+};
+
+/**
+ * Discovery strategy enum - how the first hit on the target is searched for
+ */
+UENUM(BlueprintType)
+enum class EDiscoveryStrategy : uint8
+{
+	/** Rotate AngularStepDegrees per ShotInterval until the target is hit */
+	Sweep UMETA(DisplayName = "Sweep (360 Rotation)"),
+	
+	/** Aim straight into the yaw interval subtended by the target bounds and bisect on misses (same frame) */
+	Analytic UMETA(DisplayName = "Analytic (Aim at Bounds)"),
+	
+	/** Fire every sweep ray in one batch and take the first target hit in sweep order (one frame, or two when async) */
+	FanOut UMETA(DisplayName = "Fan-Out (Batched Sweep)")
+};
+
+/**
+ * Trace scope enum - what a laser trace is tested against
+ */
+UENUM(BlueprintType)
+enum class ETraceScope : uint8
+{
+	/** Trace the whole scene on the configured channel (other actors can occlude the target) */
+	World UMETA(DisplayName = "World"),
+	
+	/** Trace only the target's primitive components (no occlusion, no filtering needed) */
+	TargetOnly UMETA(DisplayName = "Target Only"),
+	
+	/** Landscape targets: intersect a cached height grid instead of the physics scene (Target Only for other targets) */
+	LandscapeHeightfield UMETA(DisplayName = "Landscape Heightfield")
 };
 
 /**
@@ -25,6 +60,123 @@ enum class EOrbitDirection : uint8
 	CounterClockwise UMETA(DisplayName = "Counter-Clockwise")
 };
 
+/**
+ * Scan job state enum (see UNKScanJobQueueComponent)
+ */
+UENUM(BlueprintType)
+enum class EScanJobState : uint8
+{
+	Queued UMETA(DisplayName = "Queued"),
+	Discovering UMETA(DisplayName = "Discovering"),
+	Mapping UMETA(DisplayName = "Mapping"),
+	Complete UMETA(DisplayName = "Complete"),
+	Failed UMETA(DisplayName = "Failed"),
+	Cancelled UMETA(DisplayName = "Cancelled")
+};
+
+/**
+ * Target hit handed from the mapper to its outputs (transient - not stored in this form)
+ * Plain struct so ParallelFor workers can produce it; Component is only valid during the scan call
+ */
+struct FNKScanHit
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Normal = FVector::ZeroVector;
+	float Angle = 0.0f;
+	float ScanHeight = 0.0f;
+	float Distance = 0.0f;
+	int32 RingIndex = 0;
+	int32 LayerIndex = 0;
+	const UPrimitiveComponent* Component = nullptr;
+	
+	static FNKScanHit FromHitResult(const FHitResult& Hit, float InAngle, float InScanHeight, int32 InRingIndex, int32 InLayerIndex)
+	{
+		FNKScanHit ScanHit;
+		ScanHit.Location = Hit.Location;
+		ScanHit.Normal = Hit.ImpactNormal;
+		ScanHit.Angle = InAngle;
+		ScanHit.ScanHeight = InScanHeight;
+		ScanHit.Distance = Hit.Distance;
+		ScanHit.RingIndex = InRingIndex;
+		ScanHit.LayerIndex = InLayerIndex;
+		ScanHit.Component = Hit.GetComponent();
+		return ScanHit;
+	}
+};
+
+/**
+ * Results of a batched trace (UNKLaserTracerComponent::PerformTraces) - one entry per ray in every column
+ * Misses keep zeroed columns and ActorIndex INDEX_NONE
+ */
+struct FNKTraceBatchResults
+{
+	TArray<bool> HitFlags;
+	TArray<FVector> Locations;
+	TArray<FVector> Normals;
+	TArray<float> Distances;
+	TArray<const UPrimitiveComponent*> Components;
+	
+	/** Index into Actors per ray (INDEX_NONE on a miss) */
+	TArray<int32> ActorIndices;
+	
+	/** Every actor hit by the batch, once each */
+	TArray<AActor*> Actors;
+	
+	int32 HitCount = 0;
+	
+	int32 Num() const { return HitFlags.Num(); }
+	
+	void Reset(int32 RayCount)
+	{
+		HitFlags.SetNumZeroed(RayCount);
+		Locations.SetNumZeroed(RayCount);
+		Normals.SetNumZeroed(RayCount);
+		Distances.SetNumZeroed(RayCount);
+		Components.SetNumZeroed(RayCount);
+		ActorIndices.Init(INDEX_NONE, RayCount);
+		Actors.Reset();
+		HitCount = 0;
+	}
+	
+	AActor* GetActor(int32 RayIndex) const
+	{
+		return ActorIndices[RayIndex] != INDEX_NONE ? Actors[ActorIndices[RayIndex]] : nullptr;
+	}
+	
+	FNKScanHit ToScanHit(int32 RayIndex, float InAngle, float InScanHeight, int32 InRingIndex, int32 InLayerIndex) const
+	{
+		FNKScanHit ScanHit;
+		ScanHit.Location = Locations[RayIndex];
+		ScanHit.Normal = Normals[RayIndex];
+		ScanHit.Angle = InAngle;
+		ScanHit.ScanHeight = InScanHeight;
+		ScanHit.Distance = Distances[RayIndex];
+		ScanHit.RingIndex = InRingIndex;
+		ScanHit.LayerIndex = InLayerIndex;
+		ScanHit.Component = Components[RayIndex];
+		return ScanHit;
+	}
+	
+	/** Rebuild a hit result for event payloads (location, normal, distance, actor and component only) */
+	FHitResult ToHitResult(int32 RayIndex) const
+	{
+		FHitResult Hit(GetActor(RayIndex), const_cast<UPrimitiveComponent*>(Components[RayIndex]), Locations[RayIndex], Normals[RayIndex]);
+		Hit.Distance = Distances[RayIndex];
+		return Hit;
+	}
+};
+
+/**
+ * Actor/component a scan point was recorded on (interned - points store an index into the table)
+ * Actor is unset for scans loaded from disk, the names survive
+ */
+struct FNKScanSource
+{
+	TWeakObjectPtr<AActor> Actor;
+	FName ActorName = NAME_None;
+	FName ComponentName = NAME_None;
+};
+
 /**
  * Single scan data point
  */
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ALandscapeProxy;
+class UPrimitiveComponent;
+struct FHitResult;
+
+/**
+ * Landscape heights cached in a regular world-space grid, traced without the physics scene
+ *
+ * Vertices are sampled with ALandscapeProxy::GetHeightAtLocation at the landscape's quad spacing
+ * (doubled until the grid fits the sample budget) and aligned to its vertex lattice, so an unrotated
+ * landscape at full resolution is reproduced exactly. Each cell is split into the same two triangles
+ * as the landscape collision; rays walk the cells with a 2D DDA and only test cells whose highest
+ * corner the ray dips below. Like heightfield collision, surfaces are hit from above only.
+ *
+ * Build on the game thread; TraceRay only reads and is safe from worker threads.
+ */
+class TPCPP_API FNKLandscapeHeightGrid
+{
+public:
+	/**
+	 * Sample the landscape's heights over its collision bounds
+	 * @param InLandscape - Landscape (or streaming proxy) to sample
+	 * @param MaxSamples - Vertex budget; the spacing doubles until the grid fits
+	 * @return false if no height could be sampled (grid is left empty)
+	 */
+	bool Build(ALandscapeProxy* InLandscape, int32 MaxSamples);
+	
+	void Reset();
+	
+	bool IsValid() const { return Heights.Num() > 0; }
+	
+	/** Landscape the grid was built from (nullptr if empty or destroyed) */
+	const ALandscapeProxy* GetLandscape() const { return Landscape.Get(); }
+	
+	/** Distance between grid vertices (cm) */
+	double GetSpacing() const { return Spacing; }
+	
+	int32 GetSampleCount() const { return Heights.Num(); }
+	
+	SIZE_T GetAllocatedSize() const;
+	
+	/**
+	 * Intersect a segment with the cached surface
+	 * @param Start - Segment start
+	 * @param End - Segment end
+	 * @param OutHit - Nearest hit (actor, collision component, location, normal, time and distance)
+	 * @return true if the segment enters the surface from above
+	 */
+	bool TraceRay(const FVector& Start, const FVector& End, FHitResult& OutHit) const;
+
+private:
+	/** Marks a vertex without landscape below it (holes, gaps between components) */
+	static constexpr float NoHeight = -MAX_FLT;
+	
+	TWeakObjectPtr<ALandscapeProxy> Landscape;
+	
+	/** World position of vertex (0, 0) */
+	FVector2D Origin = FVector2D::ZeroVector;
+	double Spacing = 0.0;
+	
+	/** Cell counts - vertices are (CellsX + 1) x (CellsY + 1) */
+	int32 CellsX = 0;
+	int32 CellsY = 0;
+	
+	/** Vertex heights, row major (NoHeight where nothing was sampled) */
+	TArray<float> Heights;
+	
+	/** Highest corner of each cell, row major (NoHeight if any corner is missing) */
+	TArray<float> CellMaxHeights;
+	
+	/** Collision component under each cell (index into Components, MAX_uint16 = none) */
+	TArray<uint16> CellComponents;
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> Components;
+	
+	float MinHeight = 0.0f;
+	float MaxHeight = 0.0f;
+	
+	FORCEINLINE float GetHeight(int32 X, int32 Y) const { return Heights[(Y * (CellsX + 1)) + X]; }
+	
+	/**
+	 * Nearest intersection of the segment with the two triangles of one cell within [MinTime, MaxTime]
+	 * @return true if a triangle is entered from above inside the interval
+	 */
+	bool IntersectCell(int32 CellX, int32 CellY, const FVector& Start, const FVector& Delta, double MinTime, double MaxTime, double& OutTime, FVector& OutNormal) const;
+};
@@ -0,0 +1,165 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Scanner/ScanDataStructures.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Binary scan container (.nkscan)
+ *
+ * Layout (little-endian, native struct layout):
+ *   FNKScanFileHeader
+ *   Chunk table   - one FNKScanFileChunk per contiguous ring run
+ *   Source table  - per source: uint32 length + UTF-8 actor name, uint32 length + UTF-8 component name
+ *   SoA streams   - one tightly packed array per point attribute, each StreamAlignment aligned
+ *
+ * Streams are laid out exactly like the scan store's arrays, so a mapped file is used in place.
+ */
+namespace NKScanFile
+{
+	constexpr uint32 Magic = 0x46534B4E;  // 'NKSF'
+	constexpr uint32 Version = 1;
+	constexpr uint64 StreamAlignment = 16;
+	
+	/** Point attribute streams, in file order */
+	enum EStream : uint32
+	{
+		Position,     // FVector3f
+		Normal,       // FVector3f
+		Angle,        // float
+		ScanHeight,   // float
+		Distance,     // float
+		Timestamp,    // float
+		RingIndex,    // int32
+		LayerIndex,   // uint8
+		SourceIndex,  // int32
+		StreamCount
+	};
+	
+	/** Bytes per point of each stream */
+	constexpr uint64 StreamElementSize[StreamCount] = { 12, 12, 4, 4, 4, 4, 4, 1, 4 };
+}
+
+struct FNKScanFileHeader
+{
+	uint32 Magic = NKScanFile::Magic;
+	uint32 Version = NKScanFile::Version;
+	uint32 HeaderSize = sizeof(FNKScanFileHeader);
+	uint32 Flags = 0;
+	
+	uint64 PointCount = 0;
+	uint32 ChunkCount = 0;
+	uint32 SourceCount = 0;
+	
+	uint64 ChunkTableOffset = 0;
+	uint64 SourceTableOffset = 0;
+	uint64 SourceTableSize = 0;
+	uint64 StreamOffsets[NKScanFile::StreamCount] = {};
+	
+	double ScanDuration = 0.0;  // Seconds from first to last shot
+	uint64 FileSize = 0;        // Guards against truncated files
+};
+static_assert(sizeof(FNKScanFileHeader) == 144, "FNKScanFileHeader layout is part of the file format");
+
+/**
+ * Contiguous run of points sharing a ring index (rings are stored in order, so usually one chunk per ring)
+ */
+struct FNKScanFileChunk
+{
+	int32 RingIndex = 0;
+	uint32 PointCount = 0;
+	uint64 FirstPoint = 0;
+};
+static_assert(sizeof(FNKScanFileChunk) == 16, "FNKScanFileChunk layout is part of the file format");
+
+/**
+ * Point data to write - views over the scan store's arrays (all streams PointCount long)
+ */
+struct FNKScanFileData
+{
+	TConstArrayView<FVector3f> Positions;
+	TConstArrayView<FVector3f> Normals;
+	TConstArrayView<float> Angles;
+	TConstArrayView<float> ScanHeights;
+	TConstArrayView<float> Distances;
+	TConstArrayView<float> Timestamps;
+	TConstArrayView<int32> RingIndices;
+	TConstArrayView<uint8> LayerIndices;
+	TConstArrayView<int32> SourceIndices;
+	TConstArrayView<FNKScanSource> Sources;
+	double ScanDuration = 0.0;
+};
+
+namespace NKScanFile
+{
+	/**
+	 * Write a scan container
+	 * @param FilePath - Output file (overwritten)
+	 * @param Data - Point streams, all the same length
+	 * @return true if the whole file was written
+	 */
+	TPCPP_API bool Write(const FString& FilePath, const FNKScanFileData& Data);
+}
+
+/**
+ * Read-only scan container opened through memory mapping
+ * Point streams are views straight into the mapped file (no copy); only the small
+ * source table is parsed. Views stay valid until the file is destroyed.
+ */
+class TPCPP_API FNKMappedScanFile
+{
+public:
+	UE_NONCOPYABLE(FNKMappedScanFile);
+	
+	~FNKMappedScanFile();
+	
+	/**
+	 * Map and validate a scan container
+	 * @return nullptr if the file is missing, truncated, or not a supported version
+	 */
+	static TUniquePtr<FNKMappedScanFile> Open(const FString& FilePath);
+	
+	int32 GetPointCount() const { return PointCount; }
+	double GetScanDuration() const { return Header.ScanDuration; }
+	const FString& GetFilePath() const { return FilePath; }
+	
+	TConstArrayView<FVector3f> GetPositions() const { return GetStream<FVector3f>(NKScanFile::Position); }
+	TConstArrayView<FVector3f> GetNormals() const { return GetStream<FVector3f>(NKScanFile::Normal); }
+	TConstArrayView<float> GetAngles() const { return GetStream<float>(NKScanFile::Angle); }
+	TConstArrayView<float> GetScanHeights() const { return GetStream<float>(NKScanFile::ScanHeight); }
+	TConstArrayView<float> GetDistances() const { return GetStream<float>(NKScanFile::Distance); }
+	TConstArrayView<float> GetTimestamps() const { return GetStream<float>(NKScanFile::Timestamp); }
+	TConstArrayView<int32> GetRingIndices() const { return GetStream<int32>(NKScanFile::RingIndex); }
+	TConstArrayView<uint8> GetLayerIndices() const { return GetStream<uint8>(NKScanFile::LayerIndex); }
+	TConstArrayView<int32> GetSourceIndices() const { return GetStream<int32>(NKScanFile::SourceIndex); }
+	
+	TConstArrayView<FNKScanFileChunk> GetChunks() const { return Chunks; }
+	const TArray<FNKScanSource>& GetSources() const { return Sources; }
+
+private:
+	FNKMappedScanFile() = default;
+	
+	/** Check the header and every table against the mapped size */
+	bool Validate();
+	
+	template<typename T>
+	TConstArrayView<T> GetStream(NKScanFile::EStream Stream) const
+	{
+		return TConstArrayView<T>(reinterpret_cast<const T*>(MappedData + Header.StreamOffsets[Stream]), PointCount);
+	}
+	
+	FString FilePath;
+	IMappedFileHandle* MappedHandle = nullptr;
+	IMappedFileRegion* MappedRegion = nullptr;
+	const uint8* MappedData = nullptr;
+	int64 MappedSize = 0;
+	
+	FNKScanFileHeader Header;
+	int32 PointCount = 0;
+	TConstArrayView<FNKScanFileChunk> Chunks;
+	TArray<FNKScanSource> Sources;
+};
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FNKScanSpatialIndex;
+
+/**
+ * Surface normal estimation for scan point clouds
+ */
+namespace NKScanNormals
+{
+	/**
+	 * Estimate a normal per point from its k nearest neighbours (PCA - smallest principal axis)
+	 * Runs with ParallelFor; safe to call from a worker thread as long as nothing modifies the inputs.
+	 * @param Points - Point positions
+	 * @param Index - Spatial index over exactly these points (point i == Points[i])
+	 * @param Viewpoints - Where each point was seen from - normals are flipped to face it (one per point)
+	 * @param NeighbourCount - Neighbours per fit, including the point itself (min 3)
+	 * @param MaxNeighbourDistance - Neighbours further than this are ignored; bounds every kNN query so the pass stays O(n * k)
+	 * @param OutNormals - One unit normal per point (zero where too few neighbours were found)
+	 */
+	TPCPP_API void EstimateNormals(TConstArrayView<FVector> Points, const FNKScanSpatialIndex& Index,
+		TConstArrayView<FVector> Viewpoints, int32 NeighbourCount, float MaxNeighbourDistance, TArray<FVector>& OutNormals);
+	
+	/**
+	 * Eigen decomposition of a symmetric 3x3 matrix (cyclic Jacobi)
+	 * @param Matrix - Row-major symmetric matrix
+	 * @param OutEigenvalues - Ascending
+	 * @param OutEigenvectors - Unit eigenvector per eigenvalue
+	 */
+	TPCPP_API void SolveSymmetric3x3(const double Matrix[3][3], double OutEigenvalues[3], FVector OutEigenvectors[3]);
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPrimitiveComponent;
+
+/**
+ * Geometry signatures for change detection between scans
+ * A signature only changes when the traced geometry may have changed
+ * (component added/removed, moved, rescaled, re-meshed or collision toggled)
+ */
+namespace NKScanSignature
+{
+	/**
+	 * Hash of one primitive's traceable state (identity, quantized transform and bounds, mesh, collision)
+	 */
+	TPCPP_API uint32 HashComponent(const UPrimitiveComponent* Component);
+
+	/**
+	 * Hash of every queryable primitive on an actor (0 for nullptr)
+	 */
+	TPCPP_API uint32 HashActor(const AActor* Actor);
+
+	/**
+	 * Per-sector signatures of an actor around a vertical axis through Center
+	 * Sector i covers [StartAngle + i * 360/SectorCount, StartAngle + (i+1) * 360/SectorCount).
+	 * A component contributes to every sector its XY bounds subtend - and to the opposite sectors,
+	 * since a ray that misses the near side can reach it through the center.
+	 * @param Actor - Actor whose primitive components are hashed
+	 * @param Center - Orbit center (only XY used)
+	 * @param StartAngle - Angle of the first sector's leading edge (degrees)
+	 * @param SectorCount - Number of sectors around the full circle
+	 * @param OutSignatures - One signature per sector
+	 */
+	TPCPP_API void ComputeSectorSignatures(const AActor* Actor, const FVector& Center, float StartAngle, int32 SectorCount, TArray<uint32>& OutSignatures);
+
+	/**
+	 * Sector an angle falls into (same layout as ComputeSectorSignatures)
+	 */
+	TPCPP_API int32 GetSectorIndex(float Angle, float StartAngle, int32 SectorCount);
+}
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Hashed uniform grid over scan points
+ *
+ * Points are identified by insertion order (the index into the array they were inserted from).
+ * Only occupied cells are stored, so memory follows the point count rather than the bounds.
+ * Insert is O(1); radius, nearest and ray queries touch only the cells around the query.
+ */
+class TPCPP_API FNKScanSpatialIndex
+{
+public:
+	explicit FNKScanSpatialIndex(float InCellSize = 50.0f);
+	
+	/** Remove every point (optionally changing the cell size) */
+	void Reset(float InCellSize = 0.0f);
+	
+	/** Reserve room for a number of points */
+	void Reserve(int32 PointCount);
+	
+	/**
+	 * Add a point
+	 * @return Index of the point (== number of points inserted before it)
+	 */
+	int32 Insert(const FVector& Location);
+	
+	/** Reset and insert every point in order */
+	void Build(TConstArrayView<FVector> Locations);
+	void Build(TConstArrayView<FVector3f> Locations);
+	
+	int32 Num() const { return Points.Num(); }
+	float GetCellSize() const { return CellSize; }
+	
+	/** Heap memory held by the index (bytes, allocated capacity) */
+	SIZE_T GetAllocatedSize() const
+	{
+		return Points.GetAllocatedSize() + NextInCell.GetAllocatedSize() + CellHeads.GetAllocatedSize();
+	}
+	
+	/**
+	 * Every point within Radius of Center (unordered)
+	 */
+	void QueryRadius(const FVector& Center, float Radius, TArray<int32>& OutIndices) const;
+	
+	/**
+	 * Up to Count points closest to Location, nearest first
+	 * @param MaxDistance - Ignore points further than this
+	 */
+	void QueryNearest(const FVector& Location, int32 Count, TArray<int32>& OutIndices, float MaxDistance = UE_MAX_FLT) const;
+	
+	/**
+	 * First point along a ray (smallest distance along Direction) that lies within HitRadius of the ray
+	 * @param Direction - Ray direction (normalized internally)
+	 * @param OutDistance - Distance along the ray to the point's projection
+	 * @return Point index, INDEX_NONE if nothing is hit within MaxDistance
+	 */
+	int32 QueryRay(const FVector& Origin, const FVector& Direction, float MaxDistance, float HitRadius, float& OutDistance) const;
+
+private:
+	FIntVector GetCell(const FVector& Location) const;
+	
+	/** Call Visitor(PointIndex) for every point in a cell */
+	template<typename FunctorType>
+	void ForEachInCell(const FIntVector& Cell, FunctorType&& Visitor) const
+	{
+		if (const int32* Head = CellHeads.Find(Cell))
+		{
+			for (int32 PointIndex = *Head; PointIndex != INDEX_NONE; PointIndex = NextInCell[PointIndex])
+			{
+				Visitor(PointIndex);
+			}
+		}
+	}
+	
+	float CellSize = 50.0f;
+	float InvCellSize = 1.0f / 50.0f;
+	
+	/** Point positions by index */
+	TArray<FVector> Points;
+	
+	/** Intrusive per-cell list - next point in the same cell, INDEX_NONE at the end */
+	TArray<int32> NextInCell;
+	
+	/** Most recently inserted point of every occupied cell */
+	TMap<FIntVector, int32> CellHeads;
+	
+	/** Occupied cell range (bounds shell searches) */
+	FIntVector MinCell = FIntVector::ZeroValue;
+	FIntVector MaxCell = FIntVector::ZeroValue;
+};
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * One averaged point per occupied voxel
+ * Cells are ordered by voxel coordinate (Z, then Y, then X), so the output is deterministic
+ */
+struct FNKVoxelDownsampleResult
+{
+	/** Mean position of the points in each cell */
+	TArray<FVector> Points;
+	
+	/** Number of input points merged into each cell */
+	TArray<int32> Counts;
+	
+	/** Ring index of the first input point in each cell */
+	TArray<int32> RingIndices;
+	
+	/** Voxel size actually used (cm) - larger than requested if the cloud is too big for the key range */
+	float VoxelSize = 0.0f;
+};
+
+/**
+ * Voxel-grid downsampling for scan point clouds
+ */
+namespace NKScanVoxelGrid
+{
+	/**
+	 * Quantize points into a voxel grid and average every occupied cell
+	 * Keys are computed with ParallelFor; safe to call from a worker thread.
+	 * @param Points - Input positions (scan store precision)
+	 * @param RingIndices - Ring of each input point (may be empty)
+	 * @param VoxelSize - Cell edge length (cm)
+	 * @param OutResult - One entry per occupied cell
+	 */
+	TPCPP_API void Downsample(TConstArrayView<FVector3f> Points, TConstArrayView<int32> RingIndices, float VoxelSize, FNKVoxelDownsampleResult& OutResult);
+}
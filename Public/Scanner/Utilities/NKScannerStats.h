@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/**
+ * Scanner stats - `stat NKScanner` in game, or capture with -trace=default,stats for Insights
+ *
+ * Cycle stats cover the game-thread entry points of every component (and the ring-scan workers);
+ * counters are shared by all scanners in the world, memory stats are summed over all owners.
+ */
+DECLARE_STATS_GROUP(TEXT("NKScanner"), STATGROUP_NKScanner, STATCAT_Advanced);
+
+// ===== Timing =====
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mapping Step"), STAT_NKScanner_MappingStep, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ring Scan"), STAT_NKScanner_RingScan, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Discovery"), STAT_NKScanner_Discovery, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Job Queue Tick"), STAT_NKScanner_JobQueueTick, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Perform Trace"), STAT_NKScanner_Trace, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Layered Trace"), STAT_NKScanner_LayeredTrace, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Concurrent Trace"), STAT_NKScanner_ConcurrentTrace, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Debug Draw"), STAT_NKScanner_DebugDraw, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Normal Estimation"), STAT_NKScanner_NormalEstimation, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Voxel Downsample"), STAT_NKScanner_Downsample, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Height Grid Build"), STAT_NKScanner_HeightGridBuild, STATGROUP_NKScanner, TPCPP_API);
+
+// ===== Per-Frame Counters =====
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces/Frame"), STAT_NKScanner_TracesPerFrame, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Heightfield Rays/Frame"), STAT_NKScanner_HeightfieldRaysPerFrame, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Trace Cache Hits/Frame"), STAT_NKScanner_TraceCacheHitsPerFrame, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Target Hits/Frame"), STAT_NKScanner_HitsPerFrame, STATGROUP_NKScanner, TPCPP_API);
+
+// ===== Totals =====
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Traces Issued"), STAT_NKScanner_TracesIssued, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Hit Rate % (last mapper)"), STAT_NKScanner_HitRate, STATGROUP_NKScanner, TPCPP_API);
+
+// ===== Memory =====
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Mapper Buffers"), STAT_NKScanner_MapperMemory, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Scan Store"), STAT_NKScanner_StoreMemory, STATGROUP_NKScanner, TPCPP_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Landscape Height Grids"), STAT_NKScanner_HeightGridMemory, STATGROUP_NKScanner, TPCPP_API);
+
+/**
+ * Move a shared memory stat from an owner's last reported size to its current one
+ * @param StatId - STAT_NKScanner_* memory stat
+ * @param ReportedBytes - Owner's last reported size (updated)
+ * @param CurrentBytes - Owner's current size (0 when the owner goes away)
+ */
+#if STATS
+#define NKSCANNER_UPDATE_MEMORY_STAT(StatId, ReportedBytes, CurrentBytes) \
+	{ \
+		const int64 NKStatDelta = int64(CurrentBytes) - (ReportedBytes); \
+		if (NKStatDelta > 0) { INC_MEMORY_STAT_BY(StatId, NKStatDelta); } \
+		else if (NKStatDelta < 0) { DEC_MEMORY_STAT_BY(StatId, -NKStatDelta); } \
+		(ReportedBytes) = int64(CurrentBytes); \
+	}
+#else
+#define NKSCANNER_UPDATE_MEMORY_STAT(StatId, ReportedBytes, CurrentBytes)
+#endif